@@ -0,0 +1,246 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _GNU_SOURCE  // for MAP_ANONYMOUS, MAP_HUGETLB, MADV_HUGEPAGE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "Arena.h"
+#include "Arena_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+// Rounds a request up to the arena's alignment.
+static size_t RoundUp(size_t size) {
+  if (size == 0) {
+    size = 1;
+  }
+  return (size + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1);
+}
+
+// Memory policies for mbind(2), from <numaif.h>, which we'd rather not
+// depend on (it comes with libnuma).
+#define ARENA_MPOL_INTERLEAVE 3
+#define ARENA_MPOL_LOCAL      4
+
+// Applies the arena's NUMA policy to a fresh mapping, before any of its
+// pages are touched.  Failure (eg, a kernel without NUMA support) just
+// leaves the default placement.
+static void BindPages(Arena *arena, void *addr, size_t size) {
+#ifdef SYS_mbind
+  if (arena->policy & ARENA_POLICY_NUMA_INTERLEAVE) {
+    // Every node we may use; the kernel ignores nodes we may not.  The
+    // node count is one more than the mask's width, as mbind expects.
+    unsigned long nodes = ~0UL;
+    syscall(SYS_mbind, addr, size, ARENA_MPOL_INTERLEAVE, &nodes,
+            sizeof(nodes) * 8 + 1, 0);
+  } else if (arena->policy & ARENA_POLICY_NUMA_LOCAL) {
+    syscall(SYS_mbind, addr, size, ARENA_MPOL_LOCAL, NULL, 0, 0);
+  }
+#endif
+}
+
+// Maps size bytes (a multiple of ARENA_HUGE_PAGE) aligned on a huge page
+// boundary, and asks for transparent huge pages.  Returns MAP_FAILED on
+// error.
+static void* MapHugeAligned(size_t size) {
+  char *raw, *aligned;
+  size_t head, tail;
+
+  // Over-map by a huge page, then trim the ends to get the alignment.
+  raw = (char *) mmap(NULL, size + ARENA_HUGE_PAGE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) {
+    return MAP_FAILED;
+  }
+  aligned = (char *) (((uintptr_t) raw + ARENA_HUGE_PAGE - 1) &
+                      ~((uintptr_t) ARENA_HUGE_PAGE - 1));
+  head = aligned - raw;
+  tail = ARENA_HUGE_PAGE - head;
+  if (head > 0) {
+    munmap(raw, head);
+  }
+  if (tail > 0) {
+    munmap(aligned + size, tail);
+  }
+
+  // This fails harmlessly if transparent huge pages are disabled.
+  madvise(aligned, size, MADV_HUGEPAGE);
+  return aligned;
+}
+
+// Maps a fresh region of *size bytes according to the arena's policy,
+// rounding *size up if the policy calls for it.  Returns MAP_FAILED on
+// error.
+static void* MapPages(Arena *arena, size_t *size) {
+  void *addr = MAP_FAILED;
+
+  if (arena->policy & (ARENA_POLICY_HUGE_PAGES | ARENA_POLICY_HUGETLB)) {
+    *size = (*size + ARENA_HUGE_PAGE - 1) & ~((size_t) ARENA_HUGE_PAGE - 1);
+  }
+  if (arena->policy & ARENA_POLICY_HUGETLB) {
+    addr = mmap(NULL, *size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  }
+  if (addr == MAP_FAILED &&
+      (arena->policy & (ARENA_POLICY_HUGE_PAGES | ARENA_POLICY_HUGETLB))) {
+    addr = MapHugeAligned(*size);
+  }
+  if (addr == MAP_FAILED) {
+    addr = mmap(NULL, *size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  if (addr != MAP_FAILED) {
+    BindPages(arena, addr, *size);
+  }
+  return addr;
+}
+
+// Maps a new chunk of (at least) the given total size and links it into
+// the arena.
+static ArenaChunk* MapChunk(Arena *arena, size_t size) {
+  ArenaChunk *chunk = (ArenaChunk *) MapPages(arena, &size);
+
+  if (chunk == MAP_FAILED) {
+    return NULL;
+  }
+
+  chunk->size = size;
+  chunk->prev = NULL;
+  chunk->next = arena->chunks;
+  if (arena->chunks != NULL) {
+    arena->chunks->prev = chunk;
+  }
+  arena->chunks = chunk;
+  arena->reserved += size;
+  return chunk;
+}
+
+// Unlinks a chunk from the arena and unmaps it.
+static void UnmapChunk(Arena *arena, ArenaChunk *chunk) {
+  if (chunk->prev != NULL) {
+    chunk->prev->next = chunk->next;
+  } else {
+    arena->chunks = chunk->next;
+  }
+  if (chunk->next != NULL) {
+    chunk->next->prev = chunk->prev;
+  }
+  arena->reserved -= chunk->size;
+  munmap(chunk, chunk->size);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Arena implementation.
+
+Arena* Arena_Allocate(void) {
+  return Arena_AllocateWithPolicy(0);
+}
+
+Arena* Arena_AllocateWithPolicy(int policy) {
+  Arena *arena;
+
+  if ((policy & ARENA_POLICY_NUMA_INTERLEAVE) &&
+      (policy & ARENA_POLICY_NUMA_LOCAL)) {
+    return NULL;
+  }
+
+  arena = (Arena *) calloc(1, sizeof(Arena));
+  if (arena == NULL) {
+    return NULL;
+  }
+  arena->policy = policy;
+  arena->next_chunk = ARENA_MIN_CHUNK;
+  if (policy & (ARENA_POLICY_HUGE_PAGES | ARENA_POLICY_HUGETLB)) {
+    arena->next_chunk = ARENA_HUGE_PAGE;
+  }
+  return arena;
+}
+
+void Arena_Free(Arena *arena) {
+  while (arena->chunks != NULL) {
+    ArenaChunk *chunk = arena->chunks;
+    arena->chunks = chunk->next;
+    munmap(chunk, chunk->size);
+  }
+  free(arena);
+}
+
+void* Arena_Alloc(Arena *arena, size_t size) {
+  void *ptr;
+
+  size = RoundUp(size);
+
+  // Reuse a released block of the same size, if we have one.
+  if (size <= ARENA_MAX_SMALL) {
+    ArenaFree **list = &arena->free_lists[size / ARENA_ALIGN - 1];
+    if (*list != NULL) {
+      ptr = *list;
+      *list = (*list)->next;
+      return ptr;
+    }
+  }
+
+  // Big allocations get a mapping of their own.
+  if (size > ARENA_LARGE) {
+    ArenaChunk *chunk = MapChunk(arena, sizeof(ArenaChunk) + size);
+    return chunk == NULL ? NULL : (void *) (chunk + 1);
+  }
+
+  // Everything else is bumped out of the current chunk.
+  if (arena->cursor == NULL || (size_t) (arena->limit - arena->cursor) < size) {
+    size_t chunk_size = arena->next_chunk;
+    ArenaChunk *chunk;
+
+    while (chunk_size < sizeof(ArenaChunk) + size) {
+      chunk_size *= 2;
+    }
+    chunk = MapChunk(arena, chunk_size);
+    if (chunk == NULL) {
+      return NULL;
+    }
+    arena->cursor = (char *) (chunk + 1);
+    arena->limit = (char *) chunk + chunk->size;
+    if (arena->next_chunk < ARENA_MAX_CHUNK) {
+      arena->next_chunk *= 2;
+    }
+  }
+
+  ptr = arena->cursor;
+  arena->cursor += size;
+  return ptr;
+}
+
+void Arena_Release(Arena *arena, void *ptr, size_t size) {
+  size = RoundUp(size);
+
+  if (size <= ARENA_MAX_SMALL) {
+    ArenaFree *block = (ArenaFree *) ptr;
+    ArenaFree **list = &arena->free_lists[size / ARENA_ALIGN - 1];
+
+    block->next = *list;
+    *list = block;
+  } else if (size > ARENA_LARGE) {
+    UnmapChunk(arena, (ArenaChunk *) ptr - 1);
+  }
+  // Medium-sized blocks stay where they are until Arena_Free.
+}
+
+uint64_t Arena_NumBytesReserved(Arena *arena) {
+  return arena->reserved;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_ARENA_H_
+#define HW0_ARENA_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stddef.h>     // for size_t
+#include <stdint.h>     // for uint64_t, etc.
+
+///////////////////////////////////////////////////////////////////////////////
+// An Arena is a region allocator: it carves small allocations out of large
+// chunks of memory obtained directly from the operating system, and frees
+// all of them at once when the arena itself is freed.
+//
+// Freeing an arena costs one munmap per chunk, no matter how many
+// allocations were made from it, which makes tearing down a large data
+// structure nearly free.  Individual allocations can be handed back with
+// Arena_Release: small ones are recycled for later allocations of the same
+// size, and very large ones (which get a mapping of their own) are
+// unmapped.  Anything else stays put until Arena_Free.
+//
+// An Arena is not thread-safe.
+typedef struct arena Arena;
+
+// Allocate and return a new, empty Arena.
+//
+// Returns NULL on error, non-NULL on success.
+Arena* Arena_Allocate(void);
+
+// Policies for the memory an arena maps; combine them with bitwise or.
+// Each is best effort: if the system can't provide what's asked for, the
+// arena quietly falls back to ordinary pages and placement.
+//
+// ARENA_POLICY_HUGE_PAGES: back the arena with transparent huge pages.
+//   Mappings are rounded up to, and aligned on, 2MB boundaries and
+//   madvise'd MADV_HUGEPAGE, so the kernel can back them with 2MB pages;
+//   a large table then needs far fewer TLB entries.  This costs up to 2MB
+//   of address space per mapping.
+//
+// ARENA_POLICY_HUGETLB: like ARENA_POLICY_HUGE_PAGES, but first try the
+//   administrator's pool of explicit huge pages (MAP_HUGETLB), which are
+//   guaranteed rather than opportunistic.  When the pool runs dry we fall
+//   back to transparent huge pages.
+//
+// ARENA_POLICY_NUMA_INTERLEAVE: spread the arena's pages round-robin
+//   across all NUMA nodes, so a structure shared by threads on every
+//   socket gets the bandwidth of all of them.
+//
+// ARENA_POLICY_NUMA_LOCAL: place each page on the node of the CPU that
+//   first touches it, regardless of the process's memory policy.  Can't
+//   be combined with ARENA_POLICY_NUMA_INTERLEAVE.
+#define ARENA_POLICY_HUGE_PAGES       0x1
+#define ARENA_POLICY_HUGETLB          0x2
+#define ARENA_POLICY_NUMA_INTERLEAVE  0x4
+#define ARENA_POLICY_NUMA_LOCAL       0x8
+
+// Allocate and return a new, empty Arena whose memory follows the given
+// ARENA_POLICY_* options.  Arena_Allocate() is the same as
+// Arena_AllocateWithPolicy(0).
+//
+// Returns NULL on error (including an invalid combination of policies),
+// non-NULL on success.
+Arena* Arena_AllocateWithPolicy(int policy);
+
+// Free an Arena, and with it every allocation ever made from it.
+//
+// Arguments:
+// - arena: the Arena to free.  It is unsafe to use arena, or any memory
+//   allocated from it, after this function returns.
+void Arena_Free(Arena *arena);
+
+// Allocates size bytes from the arena.  The memory is 8-byte aligned and
+// is not zeroed.
+//
+// Arguments:
+// - arena: the Arena to allocate from.
+// - size: the number of bytes needed.
+//
+// Returns NULL on error (out of memory), non-NULL on success.
+void* Arena_Alloc(Arena *arena, size_t size);
+
+// Hands an allocation back to the arena for reuse.
+//
+// Arguments:
+// - arena: the Arena that ptr was allocated from.
+// - ptr: the allocation to release.  It is unsafe to use after this call.
+// - size: the size that was passed to Arena_Alloc for ptr.
+void Arena_Release(Arena *arena, void *ptr, size_t size);
+
+// Returns the number of bytes the arena has obtained from the operating
+// system.
+uint64_t Arena_NumBytesReserved(Arena *arena);
+
+#endif  // HW0_ARENA_H_
@@ -0,0 +1,73 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_ARENA_PRIV_H_
+#define HW0_ARENA_PRIV_H_
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>  // for uint64_t, etc.
+
+#include "./Arena.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our Arena implementation.
+//
+// These would typically be located in Arena.c; however, we have broken
+// them out into a "private .h" so that our unittests can access them.
+//
+// Customers should not include this file or assume anything based on
+// its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// Allocations are rounded up to a multiple of ARENA_ALIGN.  Released
+// allocations of up to ARENA_MAX_SMALL bytes are kept on a free list per
+// size class; anything bigger than ARENA_LARGE gets a mapping of its own,
+// which Arena_Release unmaps straight away.
+#define ARENA_ALIGN        8
+#define ARENA_MAX_SMALL    256
+#define ARENA_NUM_CLASSES  (ARENA_MAX_SMALL / ARENA_ALIGN)
+#define ARENA_LARGE        (256 * 1024)
+
+// Chunks start at ARENA_MIN_CHUNK bytes and double, up to ARENA_MAX_CHUNK.
+#define ARENA_MIN_CHUNK    (64 * 1024)
+#define ARENA_MAX_CHUNK    (256 * 1024 * 1024)
+
+// Under a huge page policy, every mapping is a multiple of this size and
+// starts on a multiple of it, and chunks start out this big.
+#define ARENA_HUGE_PAGE    (2 * 1024 * 1024)
+
+// Every mapping the arena owns starts with this header.  Mappings are kept
+// on a doubly-linked list so that a large allocation's mapping can be
+// unlinked when it is released.
+typedef struct arena_chunk {
+  struct arena_chunk *next;  // next mapping, or NULL
+  struct arena_chunk *prev;  // previous mapping, or NULL
+  size_t              size;  // size of the whole mapping, header included
+  size_t              pad;   // keeps the header a multiple of 16 bytes
+} ArenaChunk;
+
+// A released small allocation, threaded onto its size class's free list.
+typedef struct arena_free {
+  struct arena_free *next;
+} ArenaFree;
+
+// The arena itself.
+typedef struct arena {
+  ArenaChunk *chunks;                          // every mapping we own
+  char       *cursor;                          // next free byte in chunk
+  char       *limit;                           // end of the current chunk
+  size_t      next_chunk;                      // size of the next chunk
+  uint64_t    reserved;                        // bytes mapped in total
+  int         policy;                          // ARENA_POLICY_* flags
+  ArenaFree  *free_lists[ARENA_NUM_CLASSES];   // released small blocks
+} Arena;
+
+#endif  // HW0_ARENA_PRIV_H_
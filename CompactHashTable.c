@@ -0,0 +1,234 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CompactHashTable.h"
+#include "CompactHashTable_priv.h"
+#include "HashTable_priv.h"  // for HTSipHash13, HTRandomSeed
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+//
+#define CHT_MIN_CAPACITY 8
+
+// Maps a key to its bucket, using SipHash under the table's own seed.
+static uint32_t CHTBucket(CompactHashTable *table, HTKey_t key) {
+  return (uint32_t) (HTSipHash13(table->seed, key) &
+                     (table->num_buckets - 1));
+}
+
+// Returns a pointer to the link (a bucket head or a next[] slot) that
+// refers to key's entry, or to the CHT_NIL that ends its chain if the key
+// isn't present.  Returning the link lets callers unlink without a second
+// walk.
+static uint32_t* FindLink(CompactHashTable *table, HTKey_t key) {
+  uint32_t *link = &table->buckets[CHTBucket(table, key)];
+
+  while (*link != CHT_NIL && table->entries[*link].key != key) {
+    link = &table->next[*link];
+  }
+  return link;
+}
+
+// Replaces the bucket array with one of the given size and relinks every
+// entry.  Entries don't move, so this is a single pass over next[].
+static bool Rehash(CompactHashTable *table, uint32_t num_buckets) {
+  uint32_t *buckets = (uint32_t *) malloc(num_buckets * sizeof(uint32_t));
+  uint32_t i;
+
+  if (buckets == NULL) {
+    return false;
+  }
+  for (i = 0; i < num_buckets; i++) {
+    buckets[i] = CHT_NIL;
+  }
+
+  free(table->buckets);
+  table->buckets = buckets;
+  table->num_buckets = num_buckets;
+  for (i = 0; i < table->num_elements; i++) {
+    uint32_t b = CHTBucket(table, table->entries[i].key);
+    table->next[i] = buckets[b];
+    buckets[b] = i;
+  }
+  return true;
+}
+
+// Makes room for one more entry, growing the arrays and the bucket array
+// as needed.  Returns false if that isn't possible.
+static bool MakeRoom(CompactHashTable *table) {
+  if (table->num_elements == table->capacity) {
+    uint64_t newcap = (uint64_t) table->capacity * 2;
+    HTKeyValue_t *entries;
+    uint32_t *next;
+
+    // Leave CHT_NIL free to mean "no entry".
+    if (newcap > CHT_NIL) {
+      newcap = CHT_NIL;
+    }
+    if (newcap == table->capacity) {
+      return false;
+    }
+
+    entries = (HTKeyValue_t *) realloc(table->entries,
+                                       newcap * sizeof(HTKeyValue_t));
+    if (entries == NULL) {
+      return false;
+    }
+    table->entries = entries;
+    next = (uint32_t *) realloc(table->next, newcap * sizeof(uint32_t));
+    if (next == NULL) {
+      return false;
+    }
+    table->next = next;
+    table->capacity = (uint32_t) newcap;
+  }
+
+  // Keep the load factor at or below 1.  If we can't grow the bucket array
+  // we carry on with longer chains.
+  if (table->num_elements >= table->num_buckets &&
+      table->num_buckets <= UINT32_MAX / 2) {
+    Rehash(table, table->num_buckets * 2);
+  }
+  return true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CompactHashTable implementation.
+
+CompactHashTable* CompactHashTable_Allocate(int capacity) {
+  CompactHashTable *table;
+  uint32_t num_buckets = CHT_MIN_CAPACITY;
+
+  if (capacity < CHT_MIN_CAPACITY) {
+    capacity = CHT_MIN_CAPACITY;
+  }
+  while (num_buckets < (uint32_t) capacity) {
+    num_buckets *= 2;
+  }
+
+  table = (CompactHashTable *) malloc(sizeof(CompactHashTable));
+  if (table == NULL) {
+    return NULL;
+  }
+  table->num_elements = 0;
+  table->capacity = (uint32_t) capacity;
+  table->num_buckets = 0;
+  table->buckets = NULL;
+  HTRandomSeed(table->seed);
+  table->entries = (HTKeyValue_t *) malloc(capacity * sizeof(HTKeyValue_t));
+  table->next = (uint32_t *) malloc(capacity * sizeof(uint32_t));
+  if (table->entries == NULL || table->next == NULL ||
+      !Rehash(table, num_buckets)) {
+    free(table->entries);
+    free(table->next);
+    free(table);
+    return NULL;
+  }
+  return table;
+}
+
+void CompactHashTable_Free(CompactHashTable *table,
+                           ValueFreeFnPtr value_free_function) {
+  uint32_t i;
+
+  if (value_free_function != NULL) {
+    for (i = 0; i < table->num_elements; i++) {
+      value_free_function(table->entries[i].value);
+    }
+  }
+  free(table->entries);
+  free(table->next);
+  free(table->buckets);
+  free(table);
+}
+
+int CompactHashTable_NumElements(CompactHashTable *table) {
+  return (int) table->num_elements;
+}
+
+bool CompactHashTable_Insert(CompactHashTable *table,
+                             HTKeyValue_t newkeyvalue,
+                             HTKeyValue_t *oldkeyvalue) {
+  uint32_t *link = FindLink(table, newkeyvalue.key);
+  uint32_t idx, b;
+
+  if (*link != CHT_NIL) {
+    *oldkeyvalue = table->entries[*link];
+    table->entries[*link].value = newkeyvalue.value;
+    return true;
+  }
+
+  // Growing may rehash, which invalidates link; new entries go at the head
+  // of their chain, so we only need the bucket.
+  if (!MakeRoom(table)) {
+    return false;
+  }
+  idx = table->num_elements++;
+  b = CHTBucket(table, newkeyvalue.key);
+  table->entries[idx] = newkeyvalue;
+  table->next[idx] = table->buckets[b];
+  table->buckets[b] = idx;
+  return false;
+}
+
+bool CompactHashTable_Find(CompactHashTable *table,
+                           HTKey_t key,
+                           HTKeyValue_t *keyvalue) {
+  uint32_t idx = *FindLink(table, key);
+
+  if (idx == CHT_NIL) {
+    return false;
+  }
+  *keyvalue = table->entries[idx];
+  return true;
+}
+
+bool CompactHashTable_Remove(CompactHashTable *table,
+                             HTKey_t key,
+                             HTKeyValue_t *keyvalue) {
+  uint32_t *link = FindLink(table, key);
+  uint32_t idx = *link, last;
+
+  if (idx == CHT_NIL) {
+    return false;
+  }
+  *keyvalue = table->entries[idx];
+  *link = table->next[idx];
+
+  // Keep the array dense by moving the last entry into the hole, and
+  // pointing whatever linked to the last entry at its new position.
+  last = --table->num_elements;
+  if (idx != last) {
+    link = &table->buckets[CHTBucket(table, table->entries[last].key)];
+    while (*link != last) {
+      link = &table->next[*link];
+    }
+    *link = idx;
+    table->entries[idx] = table->entries[last];
+    table->next[idx] = table->next[last];
+  }
+  return true;
+}
+
+HTKeyValue_t* CompactHashTable_Entries(CompactHashTable *table) {
+  return table->entries;
+}
+
+size_t CompactHashTable_MemoryUsage(CompactHashTable *table) {
+  return sizeof(CompactHashTable) +
+         (size_t) table->capacity * (sizeof(HTKeyValue_t) + sizeof(uint32_t)) +
+         (size_t) table->num_buckets * sizeof(uint32_t);
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_COMPACTHASHTABLE_H_
+#define HW0_COMPACTHASHTABLE_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stddef.h>     // for size_t
+#include <stdint.h>     // for uint64_t, etc.
+
+#include "./HashTable.h"  // for HTKey_t, HTValue_t, HTKeyValue_t
+
+///////////////////////////////////////////////////////////////////////////////
+// A CompactHashTable is a chained hash table with the same interface as
+// HashTable, laid out to use as little memory per entry as possible.
+//
+// Instead of a malloc'd LinkedList per bucket and a malloc'd node and
+// HTKeyValue_t per entry, every (key,value) lives in one contiguous array,
+// and chains are linked by 32-bit indices into that array.  Each bucket is
+// just the 32-bit index of its chain's first entry.  There are no
+// per-entry allocations at all, so an entry costs its 16 bytes of data
+// plus about 8 bytes of links and buckets, against roughly 100 bytes for
+// a HashTable entry.
+//
+// Entries are kept densely packed: removing an entry moves the last entry
+// into its place.  As a result the table holds at most 2^32 - 1 entries.
+//
+// As with HashTable, "struct cht" is defined in CompactHashTable_priv.h.
+typedef struct cht CompactHashTable;
+
+// Allocate and return a new CompactHashTable.
+//
+// Arguments:
+// - capacity: the number of entries to make room for up front; the
+//   table grows past this as needed.  May be zero.
+//
+// Returns NULL on error, non-NULL on success.
+CompactHashTable* CompactHashTable_Allocate(int capacity);
+
+// Free a CompactHashTable and its entries.
+//
+// Arguments:
+// - table: the table to free.  It is unsafe to use table after this
+//   function returns.
+// - value_free_function: invoked once for each value in the table, or
+//   NULL if the values don't need freeing.
+void CompactHashTable_Free(CompactHashTable *table,
+                           ValueFreeFnPtr value_free_function);
+
+// Returns the number of entries in the table.
+int CompactHashTable_NumElements(CompactHashTable *table);
+
+// Inserts a (key,value) pair into the table, replacing (and returning via
+// oldkeyvalue) any existing entry with the same key.  Arguments and return
+// values are as for HashTable_Insert, except that false is also returned
+// if the table couldn't grow (out of memory), in which case newkeyvalue
+// was not inserted.
+bool CompactHashTable_Insert(CompactHashTable *table,
+                             HTKeyValue_t newkeyvalue,
+                             HTKeyValue_t *oldkeyvalue);
+
+// Looks up a key; arguments and return values are as for HashTable_Find.
+bool CompactHashTable_Find(CompactHashTable *table,
+                           HTKey_t key,
+                           HTKeyValue_t *keyvalue);
+
+// Removes a key; arguments and return values are as for HashTable_Remove.
+bool CompactHashTable_Remove(CompactHashTable *table,
+                             HTKey_t key,
+                             HTKeyValue_t *keyvalue);
+
+// Returns the table's entries as a contiguous array of
+// CompactHashTable_NumElements(table) (key,value) pairs, in no particular
+// order.  This is the fastest way to visit every entry.  The array belongs
+// to the table and is only valid until the table is next modified.
+HTKeyValue_t* CompactHashTable_Entries(CompactHashTable *table);
+
+// Returns the number of bytes of memory the table is using, including
+// spare room in its arrays.
+size_t CompactHashTable_MemoryUsage(CompactHashTable *table);
+
+#endif  // HW0_COMPACTHASHTABLE_H_
@@ -0,0 +1,54 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_COMPACTHASHTABLE_PRIV_H_
+#define HW0_COMPACTHASHTABLE_PRIV_H_
+
+#include <stdint.h>  // for uint32_t, etc.
+
+#include "./CompactHashTable.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our CompactHashTable
+// implementation.
+//
+// These would typically be located in CompactHashTable.c; however, we have
+// broken them out into a "private .h" so that our unittests can access them.
+//
+// Customers should not include this file or assume anything based on
+// its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// Marks the end of a chain (or an empty bucket).
+#define CHT_NIL UINT32_MAX
+
+// The table.
+//
+// Entry i's (key,value) is entries[i] and the index of the next entry in
+// its chain is next[i].  Keeping the links in their own array means the
+// (key,value) array has no padding, and can be handed straight to the
+// customer by CompactHashTable_Entries.  entries[0..num_elements) are
+// in use; the arrays have room for capacity entries.
+//
+// buckets[b] is the index of the first entry in bucket b's chain, or
+// CHT_NIL.  num_buckets is a power of two, and is doubled whenever the
+// load factor would exceed 1.
+typedef struct cht {
+  uint32_t       num_elements;  // # entries in use
+  uint32_t       capacity;      // # entries the arrays have room for
+  uint32_t       num_buckets;   // # buckets (a power of two)
+  HTKeyValue_t  *entries;       // the (key,value) array
+  uint32_t      *next;          // chain links, parallel to entries
+  uint32_t      *buckets;       // chain heads
+  uint64_t       seed[2];       // SipHash key for choosing buckets
+} CompactHashTable;
+
+#endif  // HW0_COMPACTHASHTABLE_PRIV_H_
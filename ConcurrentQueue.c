@@ -0,0 +1,144 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "ConcurrentQueue.h"
+#include "ConcurrentQueue_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// ConcurrentQueue implementation.
+
+ConcurrentQueue* ConcurrentQueue_Allocate(int capacity) {
+  ConcurrentQueue *queue;
+  uint64_t num_slots = 2, i;
+
+  if (capacity > (1 << 30)) {
+    return NULL;
+  }
+  while (num_slots < (uint64_t) capacity) {
+    num_slots *= 2;
+  }
+
+  queue = (ConcurrentQueue *) aligned_alloc(_Alignof(ConcurrentQueue),
+                                            sizeof(ConcurrentQueue));
+  if (queue == NULL) {
+    return NULL;
+  }
+  queue->slots = (CQSlot *) malloc(num_slots * sizeof(CQSlot));
+  if (queue->slots == NULL) {
+    free(queue);
+    return NULL;
+  }
+  for (i = 0; i < num_slots; i++) {
+    atomic_init(&queue->slots[i].seq, i);
+    queue->slots[i].payload = NULL;
+  }
+  queue->mask = num_slots - 1;
+  atomic_init(&queue->tail, 0);
+  atomic_init(&queue->head, 0);
+  return queue;
+}
+
+void ConcurrentQueue_Free(ConcurrentQueue *queue,
+                          LLPayloadFreeFnPtr payload_free_function) {
+  LLPayload_t payload;
+
+  while (ConcurrentQueue_Pop(queue, &payload)) {
+    if (payload_free_function != NULL) {
+      payload_free_function(payload);
+    }
+  }
+  free(queue->slots);
+  free(queue);
+}
+
+int ConcurrentQueue_Capacity(ConcurrentQueue *queue) {
+  return (int) (queue->mask + 1);
+}
+
+int ConcurrentQueue_NumElements(ConcurrentQueue *queue) {
+  uint64_t head, tail;
+
+  // Read head first: it never passes tail, so a tail read afterwards is at
+  // least as new, and the difference can't go negative.  It can still
+  // exceed the capacity if both moved in between.
+  head = atomic_load_explicit(&queue->head, memory_order_acquire);
+  tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+  if (tail - head > queue->mask + 1) {
+    return (int) (queue->mask + 1);
+  }
+  return (int) (tail - head);
+}
+
+bool ConcurrentQueue_Append(ConcurrentQueue *queue, LLPayload_t payload) {
+  uint64_t pos, seq;
+  CQSlot *slot;
+
+  pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  for (;;) {
+    slot = &queue->slots[pos & queue->mask];
+    seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (seq == pos) {
+      // The slot is free for us; try to claim the position.  On failure,
+      // the compare-and-swap reloads pos for the next try.
+      if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos,
+                                                pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        break;
+      }
+    } else if ((int64_t) (seq - pos) < 0) {
+      // The slot still holds the payload from a lap ago: we're full.
+      return false;
+    } else {
+      // Another appender took this position; catch up.
+      pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    }
+  }
+
+  slot->payload = payload;
+  atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+  return true;
+}
+
+bool ConcurrentQueue_Pop(ConcurrentQueue *queue, LLPayload_t *payload_ptr) {
+  uint64_t pos, seq;
+  CQSlot *slot;
+
+  pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+  for (;;) {
+    slot = &queue->slots[pos & queue->mask];
+    seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (seq == pos + 1) {
+      if (atomic_compare_exchange_weak_explicit(&queue->head, &pos,
+                                                pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        break;
+      }
+    } else if ((int64_t) (seq - (pos + 1)) < 0) {
+      // Nothing has been appended at this position yet: we're empty.
+      return false;
+    } else {
+      // Another popper took this position; catch up.
+      pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    }
+  }
+
+  *payload_ptr = slot->payload;
+  atomic_store_explicit(&slot->seq, pos + queue->mask + 1,
+                        memory_order_release);
+  return true;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_CONCURRENTQUEUE_H_
+#define HW0_CONCURRENTQUEUE_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+
+#include "./LinkedList.h"  // for LLPayload_t, LLPayloadFreeFnPtr
+
+///////////////////////////////////////////////////////////////////////////////
+// A ConcurrentQueue is a first-in, first-out queue of payloads that any
+// number of threads may append to and pop from at the same time, without
+// a lock.  It replaces a LinkedList used as a work queue under a mutex:
+// ConcurrentQueue_Append and ConcurrentQueue_Pop behave like
+// LinkedList_Append and LinkedList_Pop on such a list.
+//
+// The queue is a fixed-size ring of slots, each with a sequence number
+// that says whose turn it is to use the slot: an appender claims a
+// position with one compare-and-swap on the tail counter, fills in the
+// payload and then publishes it by bumping the slot's sequence number,
+// and a popper does the same on the head counter.  Threads contend only
+// on the counter for their own end of the queue.  (One consequence: if
+// an appender is descheduled between claiming its slot and filling it,
+// poppers see the queue as empty at that slot until it resumes.)
+//
+// Unlike LinkedList_Append, appending allocates nothing, so there are no
+// nodes to recycle (and no ABA or use-after-free hazards in recycling
+// them); in exchange, the queue is bounded, and appending to a full queue
+// fails rather than growing it.
+//
+// As with LinkedList, "struct cq" is defined in ConcurrentQueue_priv.h.
+typedef struct cq ConcurrentQueue;
+
+// Allocate and return a new ConcurrentQueue.
+//
+// Arguments:
+// - capacity: the most payloads the queue can hold at once.  It is
+//   rounded up to a power of two (and to at least 2), and may be at most
+//   2^30.
+//
+// Returns NULL on error, non-NULL on success.
+ConcurrentQueue* ConcurrentQueue_Allocate(int capacity);
+
+// Free a ConcurrentQueue.  No other thread may be using the queue.
+//
+// Arguments:
+// - queue: the queue to free.  It is unsafe to use queue after this
+//   function returns.
+// - payload_free_function: invoked once for each payload still in the
+//   queue, or NULL if the payloads don't need freeing.
+void ConcurrentQueue_Free(ConcurrentQueue *queue,
+                          LLPayloadFreeFnPtr payload_free_function);
+
+// Returns the number of payloads the queue can hold.
+int ConcurrentQueue_Capacity(ConcurrentQueue *queue);
+
+// Returns the number of payloads in the queue.  If other threads are
+// using the queue, this is only a snapshot, and may be out of date by the
+// time it returns.
+int ConcurrentQueue_NumElements(ConcurrentQueue *queue);
+
+// Adds a payload to the tail of the queue.  Safe to call from any number
+// of threads at once.
+//
+// Arguments:
+// - queue: the queue to append to.
+// - payload: the payload to append; it's up to the caller to interpret and
+//   manage the memory of the payload.
+//
+// Returns:
+// - false if the queue is full, in which case payload was not appended.
+// - true on success.
+bool ConcurrentQueue_Append(ConcurrentQueue *queue, LLPayload_t payload);
+
+// Removes the payload at the head of the queue.  Safe to call from any
+// number of threads at once.
+//
+// Arguments:
+// - queue: the queue to pop from.
+// - payload_ptr: a return parameter; on success, the popped payload is
+//   returned through this parameter.
+//
+// Returns:
+// - false if the queue is empty.
+// - true on success.
+bool ConcurrentQueue_Pop(ConcurrentQueue *queue, LLPayload_t *payload_ptr);
+
+#endif  // HW0_CONCURRENTQUEUE_H_
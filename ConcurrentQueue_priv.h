@@ -0,0 +1,58 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_CONCURRENTQUEUE_PRIV_H_
+#define HW0_CONCURRENTQUEUE_PRIV_H_
+
+#include <stdint.h>     // for uint64_t, etc.
+#include <stdatomic.h>  // for _Atomic, etc.
+
+#include "./ConcurrentQueue.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our ConcurrentQueue
+// implementation.
+//
+// These would typically be located in ConcurrentQueue.c; however, we have
+// broken them out into a "private .h" so that our unittests can access them.
+//
+// Customers should not include this file or assume anything based on
+// its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// One slot of the ring.  Positions count up forever; position p uses slot
+// p & mask.  The slot's sequence number is:
+//
+// - p, when the slot is empty and waiting for the append at position p;
+// - p + 1, when that append has stored its payload, which is waiting for
+//   the pop at position p;
+// - p + capacity, once that pop has taken the payload, so the slot is
+//   waiting for the append at position p + capacity.
+//
+// A thread that has claimed a position owns its slot's payload until it
+// moves the sequence number on; the release store that does so, paired
+// with the acquire load that sees it, hands the payload to the next owner.
+typedef struct {
+  _Atomic uint64_t seq;      // see above
+  LLPayload_t      payload;
+} CQSlot;
+
+// The queue.  The two counters are on cache lines of their own, so that
+// appenders and poppers don't slow each other down by bouncing a shared
+// line between their cores.
+typedef struct cq {
+  _Alignas(64) _Atomic uint64_t tail;  // next position to append at
+  _Alignas(64) _Atomic uint64_t head;  // next position to pop from
+  _Alignas(64) CQSlot *slots;          // the ring
+  uint64_t             mask;           // # slots - 1
+} ConcurrentQueue;
+
+#endif  // HW0_CONCURRENTQUEUE_PRIV_H_
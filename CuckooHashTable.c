@@ -0,0 +1,453 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "CuckooHashTable.h"
+#include "CuckooHashTable_priv.h"
+#include "HashTable_priv.h"  // for HTSipHash13, HTRandomSeed
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+#define CUCKOO_BFS_NODES 256  // most buckets a displacement search visits
+#define CUCKOO_MAX_PATH 5     // longest chain of moves we'll make
+
+// A bucket visited by the displacement search.  The entry in slot
+// parent_slot of the parent's bucket could move into this bucket.
+typedef struct {
+  uint64_t bucket;
+  int      parent;       // index of the parent in the search queue, or -1
+  int      parent_slot;
+  int      depth;        // # of moves from a root to here
+} CuckooPathNode;
+
+// Computes key's two candidate buckets.  They come from different halves
+// of the same keyed 64-bit hash, and are always distinct.  Without the
+// seed, a customer could pick many keys with the same pair of buckets,
+// and no amount of growing would make room for them.
+static inline void KeyBuckets(CuckooHashTable *table, HTKey_t key,
+                              uint64_t *b1, uint64_t *b2) {
+  uint64_t hash = HTSipHash13(table->seed, key);
+  uint64_t mask = table->num_buckets - 1;
+
+  *b1 = hash & mask;
+  *b2 = ((hash >> 32) | (hash << 32)) & mask;
+  if (*b2 == *b1) {
+    *b2 = *b1 ^ 1;
+  }
+}
+
+// Returns the candidate bucket for key other than bucket.
+static inline uint64_t AltBucket(CuckooHashTable *table, HTKey_t key,
+                                 uint64_t bucket) {
+  uint64_t b1, b2;
+
+  KeyBuckets(table, key, &b1, &b2);
+  return (bucket == b1) ? b2 : b1;
+}
+
+// Returns the slot in bucket holding key, or -1.
+static inline int FindInBucket(CuckooBucket *bucket, HTKey_t key) {
+  int i;
+
+  for (i = 0; i < CUCKOO_WAYS; i++) {
+    if (bucket->slots[i].key == key) return i;
+  }
+  return -1;
+}
+
+// Returns true if bucket is on the search path ending at queue[i].
+static bool OnPath(CuckooPathNode *queue, int i, uint64_t bucket) {
+  for (; i >= 0; i = queue[i].parent) {
+    if (queue[i].bucket == bucket) return true;
+  }
+  return false;
+}
+
+// Moves the entries along the path found by MakeRoom: the entry in slot
+// `slot` of queue[i]'s bucket moves to the empty slot `dst`, its parent's
+// entry moves into the slot it vacated, and so on up to a root bucket.
+// Returns the root bucket's slot, which is now empty.
+static HTKeyValue_t* ShiftPath(CuckooHashTable *table, CuckooPathNode *queue,
+                               int i, int slot, HTKeyValue_t *dst) {
+  for (;;) {
+    HTKeyValue_t *src = &table->buckets[queue[i].bucket].slots[slot];
+
+    *dst = *src;
+    dst = src;
+    if (queue[i].parent < 0) break;
+    slot = queue[i].parent_slot;
+    i = queue[i].parent;
+  }
+  dst->key = CUCKOO_EMPTY_KEY;
+  dst->value = NULL;
+  return dst;
+}
+
+// Frees a slot in b1 or b2, both of which are full, by searching
+// breadth-first for the shortest chain of entries that can each move to
+// their other bucket.  Returns the freed slot, or NULL if there's no such
+// chain within CUCKOO_MAX_PATH moves.
+static HTKeyValue_t* MakeRoom(CuckooHashTable *table,
+                              uint64_t b1, uint64_t b2) {
+  CuckooPathNode queue[CUCKOO_BFS_NODES];
+  int head = 0, tail = 0;
+
+  queue[tail++] = (CuckooPathNode) { b1, -1, -1, 0 };
+  queue[tail++] = (CuckooPathNode) { b2, -1, -1, 0 };
+
+  while (head < tail) {
+    int i = head++, slot;
+    CuckooBucket *bucket = &table->buckets[queue[i].bucket];
+
+    for (slot = 0; slot < CUCKOO_WAYS; slot++) {
+      uint64_t alt = AltBucket(table, bucket->slots[slot].key,
+                               queue[i].bucket);
+      int empty = FindInBucket(&table->buckets[alt], CUCKOO_EMPTY_KEY);
+
+      if (empty >= 0) {
+        return ShiftPath(table, queue, i, slot,
+                         &table->buckets[alt].slots[empty]);
+      }
+      // Buckets already on this path are skipped, so that a path never
+      // moves the same entry twice.
+      if (tail < CUCKOO_BFS_NODES && queue[i].depth + 1 < CUCKOO_MAX_PATH &&
+          !OnPath(queue, i, alt)) {
+        queue[tail++] = (CuckooPathNode) { alt, i, slot, queue[i].depth + 1 };
+      }
+    }
+  }
+  return NULL;
+}
+
+// Finds a home for a key that isn't in the table (and isn't 0), and
+// returns its slot with the key filled in and a NULL value.  Returns NULL
+// if the key doesn't fit, in which case the table needs to grow.
+static HTKeyValue_t* PlaceKey(CuckooHashTable *table, HTKey_t key) {
+  HTKeyValue_t *slot = NULL;
+  uint64_t b1, b2;
+  int i;
+
+  KeyBuckets(table, key, &b1, &b2);
+  if ((i = FindInBucket(&table->buckets[b1], CUCKOO_EMPTY_KEY)) >= 0) {
+    slot = &table->buckets[b1].slots[i];
+  } else if ((i = FindInBucket(&table->buckets[b2],
+                               CUCKOO_EMPTY_KEY)) >= 0) {
+    slot = &table->buckets[b2].slots[i];
+  } else {
+    slot = MakeRoom(table, b1, b2);
+  }
+
+  if (slot == NULL) {
+    if (table->num_stashed == CUCKOO_STASH_SIZE) {
+      return NULL;
+    }
+    slot = &table->stash[table->num_stashed++];
+  }
+  slot->key = key;
+  slot->value = NULL;
+  return slot;
+}
+
+// Moves every entry into a new array of num_buckets buckets, under a new
+// seed, doubling again if they don't all fit.  Returns false if we run out
+// of memory, in which case the table is unchanged.
+static bool Rehash(CuckooHashTable *table, uint64_t num_buckets) {
+  CuckooHashTable old = *table;
+
+  for (;; num_buckets *= 2) {
+    CuckooBucket *buckets;
+    bool ok = true;
+    uint64_t b;
+    int i;
+
+    buckets = (CuckooBucket *) aligned_alloc(64, num_buckets *
+                                                 sizeof(CuckooBucket));
+    if (buckets == NULL) {
+      *table = old;
+      return false;
+    }
+    memset(buckets, 0, num_buckets * sizeof(CuckooBucket));
+    table->buckets = buckets;
+    table->num_buckets = num_buckets;
+    table->num_stashed = 0;
+    HTRandomSeed(table->seed);
+
+    for (b = 0; ok && b < old.num_buckets; b++) {
+      for (i = 0; ok && i < CUCKOO_WAYS; i++) {
+        HTKeyValue_t *kv = &old.buckets[b].slots[i], *slot;
+
+        if (kv->key == CUCKOO_EMPTY_KEY) continue;
+        slot = PlaceKey(table, kv->key);
+        if (slot != NULL) {
+          slot->value = kv->value;
+        }
+        ok = (slot != NULL);
+      }
+    }
+    for (i = 0; ok && i < old.num_stashed; i++) {
+      HTKeyValue_t *slot = PlaceKey(table, old.stash[i].key);
+
+      if (slot != NULL) {
+        slot->value = old.stash[i].value;
+      }
+      ok = (slot != NULL);
+    }
+
+    if (ok) {
+      free(old.buckets);
+      return true;
+    }
+    free(buckets);
+  }
+}
+
+// Adds a key that isn't in the table, growing the table if need be, and
+// returns its slot (with a NULL value), or NULL if we're out of memory.
+static HTKeyValue_t* AddKey(CuckooHashTable *table, HTKey_t key) {
+  HTKeyValue_t *slot;
+
+  if (key == CUCKOO_EMPTY_KEY) {
+    table->has_zero = true;
+    table->zero_kv.key = key;
+    table->zero_kv.value = NULL;
+    table->num_elements += 1;
+    return &table->zero_kv;
+  }
+
+  // Past the maximum load, displacement paths get long and the stash
+  // fills up, so we grow early.  If that fails, we still try to fit the
+  // key in.
+  if ((uint64_t) (table->num_elements + 1) * 100 >
+      table->num_buckets * CUCKOO_WAYS * CUCKOO_MAX_LOAD) {
+    Rehash(table, table->num_buckets * 2);
+  }
+  while ((slot = PlaceKey(table, key)) == NULL) {
+    if (!Rehash(table, table->num_buckets * 2)) {
+      return NULL;
+    }
+  }
+  table->num_elements += 1;
+  return slot;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CuckooHashTable implementation.
+
+CuckooHashTable* CuckooHashTable_Allocate(int capacity) {
+  CuckooHashTable *table;
+  uint64_t num_buckets = 2;
+
+  while (num_buckets * CUCKOO_WAYS * CUCKOO_MAX_LOAD <
+         (uint64_t) capacity * 100) {
+    num_buckets *= 2;
+  }
+
+  table = (CuckooHashTable *) calloc(1, sizeof(CuckooHashTable));
+  if (table == NULL) {
+    return NULL;
+  }
+  table->buckets = (CuckooBucket *) aligned_alloc(64, num_buckets *
+                                                      sizeof(CuckooBucket));
+  if (table->buckets == NULL) {
+    free(table);
+    return NULL;
+  }
+  memset(table->buckets, 0, num_buckets * sizeof(CuckooBucket));
+  table->num_buckets = num_buckets;
+  HTRandomSeed(table->seed);
+  return table;
+}
+
+void CuckooHashTable_Free(CuckooHashTable *table,
+                          ValueFreeFnPtr value_free_function) {
+  if (value_free_function != NULL) {
+    uint64_t position = 0;
+    HTKeyValue_t kv;
+
+    while (CuckooHashTable_Next(table, &position, &kv)) {
+      value_free_function(kv.value);
+    }
+  }
+  free(table->buckets);
+  free(table);
+}
+
+int CuckooHashTable_NumElements(CuckooHashTable *table) {
+  return table->num_elements;
+}
+
+int CuckooHashTable_Capacity(CuckooHashTable *table) {
+  return (int) (table->num_buckets * CUCKOO_WAYS * CUCKOO_MAX_LOAD / 100);
+}
+
+int CuckooHashTable_NumStashed(CuckooHashTable *table) {
+  return table->num_stashed;
+}
+
+HTKeyValue_t* CuckooHashTable_Lookup(CuckooHashTable *table, HTKey_t key) {
+  uint64_t b1, b2;
+  int i;
+
+  if (key == CUCKOO_EMPTY_KEY) {
+    return table->has_zero ? &table->zero_kv : NULL;
+  }
+
+  KeyBuckets(table, key, &b1, &b2);
+  if ((i = FindInBucket(&table->buckets[b1], key)) >= 0) {
+    return &table->buckets[b1].slots[i];
+  }
+  if ((i = FindInBucket(&table->buckets[b2], key)) >= 0) {
+    return &table->buckets[b2].slots[i];
+  }
+  for (i = 0; i < table->num_stashed; i++) {
+    if (table->stash[i].key == key) return &table->stash[i];
+  }
+  return NULL;
+}
+
+bool CuckooHashTable_Insert(CuckooHashTable *table,
+                            HTKeyValue_t newkeyvalue,
+                            HTKeyValue_t *oldkeyvalue) {
+  HTKeyValue_t *slot = CuckooHashTable_Lookup(table, newkeyvalue.key);
+
+  if (slot != NULL) {
+    *oldkeyvalue = *slot;
+    slot->value = newkeyvalue.value;
+    return true;
+  }
+  slot = AddKey(table, newkeyvalue.key);
+  if (slot != NULL) {
+    slot->value = newkeyvalue.value;
+  }
+  return false;
+}
+
+bool CuckooHashTable_Find(CuckooHashTable *table,
+                          HTKey_t key,
+                          HTKeyValue_t *keyvalue) {
+  HTKeyValue_t *slot = CuckooHashTable_Lookup(table, key);
+
+  if (slot == NULL) {
+    return false;
+  }
+  *keyvalue = *slot;
+  return true;
+}
+
+HTValue_t* CuckooHashTable_FindOrInsert(CuckooHashTable *table,
+                                        HTKey_t key,
+                                        bool *inserted) {
+  HTKeyValue_t *slot = CuckooHashTable_Lookup(table, key);
+
+  *inserted = (slot == NULL);
+  if (slot == NULL) {
+    slot = AddKey(table, key);
+    if (slot == NULL) {
+      return NULL;
+    }
+  }
+  return &slot->value;
+}
+
+bool CuckooHashTable_Remove(CuckooHashTable *table,
+                            HTKey_t key,
+                            HTKeyValue_t *keyvalue) {
+  uint64_t b1, b2, bucket;
+  int i, j;
+
+  if (key == CUCKOO_EMPTY_KEY) {
+    if (!table->has_zero) return false;
+    *keyvalue = table->zero_kv;
+    table->has_zero = false;
+    table->num_elements -= 1;
+    return true;
+  }
+
+  KeyBuckets(table, key, &b1, &b2);
+  bucket = b1;
+  i = FindInBucket(&table->buckets[b1], key);
+  if (i < 0) {
+    bucket = b2;
+    i = FindInBucket(&table->buckets[b2], key);
+  }
+
+  if (i < 0) {
+    for (j = 0; j < table->num_stashed; j++) {
+      if (table->stash[j].key == key) break;
+    }
+    if (j == table->num_stashed) return false;
+
+    *keyvalue = table->stash[j];
+    table->stash[j] = table->stash[--table->num_stashed];
+    table->num_elements -= 1;
+    return true;
+  }
+
+  *keyvalue = table->buckets[bucket].slots[i];
+  table->buckets[bucket].slots[i].key = CUCKOO_EMPTY_KEY;
+  table->buckets[bucket].slots[i].value = NULL;
+  table->num_elements -= 1;
+
+  // If a stashed entry could live in the slot we just freed, move it
+  // there, so the stash drains as the table empties.
+  for (j = 0; j < table->num_stashed; j++) {
+    KeyBuckets(table, table->stash[j].key, &b1, &b2);
+    if (b1 == bucket || b2 == bucket) {
+      table->buckets[bucket].slots[i] = table->stash[j];
+      table->stash[j] = table->stash[--table->num_stashed];
+      break;
+    }
+  }
+  return true;
+}
+
+HTKeyValue_t* CuckooHashTable_EntryAt(CuckooHashTable *table,
+                                      uint64_t *position) {
+  uint64_t num_slots = table->num_buckets * CUCKOO_WAYS, p = *position;
+
+  for (; p < num_slots; p++) {
+    HTKeyValue_t *slot = &table->buckets[p / CUCKOO_WAYS].slots[p %
+                                                                CUCKOO_WAYS];
+    if (slot->key != CUCKOO_EMPTY_KEY) {
+      *position = p;
+      return slot;
+    }
+  }
+  if (p < num_slots + table->num_stashed) {
+    *position = p;
+    return &table->stash[p - num_slots];
+  }
+  if (p <= num_slots + CUCKOO_STASH_SIZE && table->has_zero) {
+    *position = num_slots + CUCKOO_STASH_SIZE;
+    return &table->zero_kv;
+  }
+  *position = num_slots + CUCKOO_STASH_SIZE + 1;
+  return NULL;
+}
+
+bool CuckooHashTable_Next(CuckooHashTable *table,
+                          uint64_t *position,
+                          HTKeyValue_t *keyvalue) {
+  HTKeyValue_t *kv = CuckooHashTable_EntryAt(table, position);
+
+  if (kv == NULL) {
+    return false;
+  }
+  *keyvalue = *kv;
+  *position += 1;
+  return true;
+}
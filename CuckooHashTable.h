@@ -0,0 +1,107 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_CUCKOOHASHTABLE_H_
+#define HW0_CUCKOOHASHTABLE_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stdint.h>     // for uint64_t, etc.
+
+#include "./HashTable.h"  // for HTKey_t, HTValue_t, HTKeyValue_t
+
+///////////////////////////////////////////////////////////////////////////////
+// A CuckooHashTable is a bucketized cuckoo hash table with the same
+// interface as HashTable, whose lookups take worst-case O(1) time.
+//
+// Each key has two candidate buckets, chosen by two hash functions, and
+// each bucket holds four (key,value) pairs in exactly one 64-byte cache
+// line.  A key is always in one of its two buckets (or in a small stash;
+// see below), so a lookup reads at most two cache lines, no matter how
+// full the table is or how the keys collide.
+//
+// When both of a new key's buckets are full, we search breadth-first for
+// the shortest chain of entries that can each be moved to their other
+// bucket to free up a slot, and shift them along it.  On the rare
+// occasion that no short chain exists, the key goes into a stash of a
+// few entries that lookups check after the two buckets; the stash is
+// empty except at very high load.  The table doubles when the stash fills
+// up or the load factor would exceed 95%.
+//
+// As with HashTable, "struct cuckoo" is defined in CuckooHashTable_priv.h.
+typedef struct cuckoo CuckooHashTable;
+
+// Allocate and return a new CuckooHashTable.
+//
+// Arguments:
+// - capacity: the number of entries to make room for up front; the
+//   table grows past this as needed.  May be zero.
+//
+// Returns NULL on error, non-NULL on success.
+CuckooHashTable* CuckooHashTable_Allocate(int capacity);
+
+// Free a CuckooHashTable and its entries.
+//
+// Arguments:
+// - table: the table to free.  It is unsafe to use table after this
+//   function returns.
+// - value_free_function: invoked once for each value in the table, or
+//   NULL if the values don't need freeing.
+void CuckooHashTable_Free(CuckooHashTable *table,
+                          ValueFreeFnPtr value_free_function);
+
+// Returns the number of entries in the table.
+int CuckooHashTable_NumElements(CuckooHashTable *table);
+
+// Returns the number of entries the table can hold before it next grows.
+int CuckooHashTable_Capacity(CuckooHashTable *table);
+
+// Returns the number of entries currently in the stash.
+int CuckooHashTable_NumStashed(CuckooHashTable *table);
+
+// Inserts a (key,value) pair into the table, replacing (and returning via
+// oldkeyvalue) any existing entry with the same key.  Arguments and return
+// values are as for HashTable_Insert, except that false is also returned
+// if the table couldn't grow (out of memory), in which case newkeyvalue
+// was not inserted.
+bool CuckooHashTable_Insert(CuckooHashTable *table,
+                            HTKeyValue_t newkeyvalue,
+                            HTKeyValue_t *oldkeyvalue);
+
+// Looks up a key; arguments and return values are as for HashTable_Find.
+bool CuckooHashTable_Find(CuckooHashTable *table,
+                          HTKey_t key,
+                          HTKeyValue_t *keyvalue);
+
+// Looks up a key, adding it (with a NULL value) if it isn't present, and
+// returns a pointer to its value slot; see HashTable_FindOrInsert.  Since
+// inserts move entries between buckets, the pointer is only valid until
+// the table is next modified.
+HTValue_t* CuckooHashTable_FindOrInsert(CuckooHashTable *table,
+                                        HTKey_t key,
+                                        bool *inserted);
+
+// Removes a key; arguments and return values are as for HashTable_Remove.
+bool CuckooHashTable_Remove(CuckooHashTable *table,
+                            HTKey_t key,
+                            HTKeyValue_t *keyvalue);
+
+// Visits the table's entries, in no particular order, without allocating.
+// Set *position to zero before the first call; each call returns the next
+// (key,value) and advances *position.  The table must not be modified
+// while it is being visited.
+//
+// Returns:
+// - true if a (key,value) was returned, or false if there are no more.
+bool CuckooHashTable_Next(CuckooHashTable *table,
+                          uint64_t *position,
+                          HTKeyValue_t *keyvalue);
+
+#endif  // HW0_CUCKOOHASHTABLE_H_
@@ -0,0 +1,68 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_CUCKOOHASHTABLE_PRIV_H_
+#define HW0_CUCKOOHASHTABLE_PRIV_H_
+
+#include <stdint.h>  // for uint64_t, etc.
+
+#include "./CuckooHashTable.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our CuckooHashTable
+// implementation.
+//
+// These would typically be located in CuckooHashTable.c; however, we have
+// broken them out into a "private .h" so that our unittests can access them.
+//
+// Customers should not include this file or assume anything based on
+// its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+#define CUCKOO_WAYS 4        // (key,value) slots per bucket
+#define CUCKOO_STASH_SIZE 8  // entries the stash can hold
+#define CUCKOO_MAX_LOAD 95   // percent full before we grow
+
+// Key 0 marks an empty slot.  A real key of 0 is kept off to the side, in
+// zero_kv, so that it doesn't need a slot (or an occupancy bit) at all.
+#define CUCKOO_EMPTY_KEY 0
+
+// One bucket: exactly one cache line.
+typedef struct {
+  _Alignas(64) HTKeyValue_t slots[CUCKOO_WAYS];
+} CuckooBucket;
+
+// The table.
+//
+// Entries are in buckets[0..num_buckets), then the stash, then zero_kv;
+// a CuckooHashTable_Next position counts through them in that order, one
+// per slot.
+typedef struct cuckoo {
+  CuckooBucket  *buckets;        // the buckets (64-byte aligned)
+  uint64_t       num_buckets;    // # buckets (a power of two)
+  int            num_elements;   // # entries, including stash and zero_kv
+  int            num_stashed;    // # entries in stash
+  HTKeyValue_t   stash[CUCKOO_STASH_SIZE];
+  bool           has_zero;       // is key 0 present?
+  HTKeyValue_t   zero_kv;        // key 0's entry, if present
+  uint64_t       seed[2];        // SipHash key for choosing buckets
+} CuckooHashTable;
+
+// Returns a pointer to key's entry, or NULL if it isn't present.  The
+// pointer is valid until the table is next modified.
+HTKeyValue_t* CuckooHashTable_Lookup(CuckooHashTable *table, HTKey_t key);
+
+// Returns a pointer to the first entry at or after *position, updating
+// *position to match, or NULL if there are none.
+HTKeyValue_t* CuckooHashTable_EntryAt(CuckooHashTable *table,
+                                      uint64_t *position);
+
+#endif  // HW0_CUCKOOHASHTABLE_PRIV_H_
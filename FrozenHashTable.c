@@ -0,0 +1,410 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // for fstat, mmap, etc.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "FrozenHashTable.h"
+#include "FrozenHashTable_priv.h"
+#include "HashTable_priv.h"  // for HTSipHash13, HTMix64, HTRandomSeed
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+// Returns the group of a key with the given hash.
+static inline uint32_t HashToGroup(uint64_t hash, uint32_t num_groups) {
+  return (uint32_t) (((hash >> 32) * num_groups) >> 32);
+}
+
+// Returns the slot of a key with the given hash, in a group whose pilot
+// mixes to pilot_mix.  The multiply spreads every bit of the pilot over
+// the top of x (xoring alone would leave keys that share their top bits
+// sharing them under every pilot), and the final multiply and shift maps
+// x onto the slots more cheaply than a modulo would.
+static inline uint32_t HashToSlot(uint64_t hash, uint64_t pilot_mix,
+                                  uint32_t num_elements) {
+  uint64_t x = ((hash ^ pilot_mix) * 0x9e3779b97f4a7c15ULL) >> 32;
+  return (uint32_t) ((x * num_elements) >> 32);
+}
+
+// Tries to find a pilot for every group, given the keys' hashes.  On
+// success, fills in pilots and sets slot_of[i] to key i's slot.
+//
+// Returns false if some group couldn't be placed, or on out of memory.
+static bool PlaceGroups(const uint64_t *hashes, uint32_t n,
+                        uint32_t num_groups, uint32_t *pilots,
+                        uint32_t *slot_of) {
+  uint32_t *group_start, *members, *order, *by_size, *try_slots;
+  uint64_t *taken, max_tries;
+  uint32_t i, g, max_size = 0;
+  bool ok = false;
+
+  group_start = (uint32_t *) calloc(num_groups + 1, sizeof(uint32_t));
+  members = (uint32_t *) malloc((n + 1) * sizeof(uint32_t));
+  order = (uint32_t *) malloc(num_groups * sizeof(uint32_t));
+  taken = (uint64_t *) calloc(n / 64 + 1, sizeof(uint64_t));
+  by_size = NULL;
+  try_slots = NULL;
+  if (group_start == NULL || members == NULL || order == NULL ||
+      taken == NULL) {
+    goto done;
+  }
+
+  // Bucket the keys by group: group g's keys are
+  // members[group_start[g]..group_start[g + 1]).
+  for (i = 0; i < n; i++) {
+    group_start[HashToGroup(hashes[i], num_groups) + 1]++;
+  }
+  for (g = 0; g < num_groups; g++) {
+    if (group_start[g + 1] > max_size) {
+      max_size = group_start[g + 1];
+    }
+    group_start[g + 1] += group_start[g];
+  }
+  for (i = 0; i < n; i++) {
+    g = HashToGroup(hashes[i], num_groups);
+    members[--group_start[g + 1]] = i;
+  }
+  // (The decrements above left group_start[g + 1] at group g's start;
+  // shift it back into place.)
+  memmove(group_start, group_start + 1, num_groups * sizeof(uint32_t));
+  group_start[num_groups] = n;
+
+  // Order the groups largest first, with a counting sort on their size.
+  by_size = (uint32_t *) calloc(max_size + 2, sizeof(uint32_t));
+  try_slots = (uint32_t *) malloc((max_size + 1) * sizeof(uint32_t));
+  if (by_size == NULL || try_slots == NULL) {
+    goto done;
+  }
+  for (g = 0; g < num_groups; g++) {
+    by_size[max_size - (group_start[g + 1] - group_start[g]) + 1]++;
+  }
+  for (i = 0; i < max_size + 1; i++) {
+    by_size[i + 1] += by_size[i];
+  }
+  for (g = 0; g < num_groups; g++) {
+    order[by_size[max_size - (group_start[g + 1] - group_start[g])]++] = g;
+  }
+
+  // The last singleton has one free slot left, and finds it after about
+  // n tries; we allow many times that before giving up on this seed.
+  max_tries = (uint64_t) FROZEN_PILOT_TRIES * n + FROZEN_PILOT_TRIES;
+  if (max_tries > UINT32_MAX) {
+    max_tries = UINT32_MAX;
+  }
+
+  for (i = 0; i < num_groups; i++) {
+    uint32_t start, size, j, k;
+    uint64_t pilot;
+
+    g = order[i];
+    start = group_start[g];
+    size = group_start[g + 1] - start;
+    if (size == 0) {
+      // Groups are in size order, so the rest are empty too.
+      pilots[g] = 0;
+      continue;
+    }
+
+    for (pilot = 0; pilot < max_tries; pilot++) {
+      uint64_t mix = HTMix64(pilot);
+
+      for (j = 0; j < size; j++) {
+        uint32_t s = HashToSlot(hashes[members[start + j]], mix, n);
+        if (taken[s / 64] & (1ULL << (s % 64))) {
+          break;
+        }
+        for (k = 0; k < j && try_slots[k] != s; k++) {
+        }
+        if (k < j) {
+          break;
+        }
+        try_slots[j] = s;
+      }
+      if (j == size) {
+        break;
+      }
+    }
+    if (pilot == max_tries) {
+      goto done;
+    }
+
+    pilots[g] = (uint32_t) pilot;
+    for (j = 0; j < size; j++) {
+      taken[try_slots[j] / 64] |= 1ULL << (try_slots[j] % 64);
+      slot_of[members[start + j]] = try_slots[j];
+    }
+  }
+  ok = true;
+
+ done:
+  free(group_start);
+  free(members);
+  free(order);
+  free(taken);
+  free(by_size);
+  free(try_slots);
+  return ok;
+}
+
+// Writes all len bytes at buf to fd.  Returns false on error.
+static bool WriteAll(int fd, const unsigned char *buf, size_t len) {
+  while (len > 0) {
+    ssize_t n = write(fd, buf, len);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    buf += n;
+    len -= n;
+  }
+  return true;
+}
+
+// Points table's fields at the header, pilots and slots in its block.
+static void AttachBlock(FrozenHashTable *table) {
+  const FrozenHeader *header = (const FrozenHeader *) table->block;
+  size_t slots_offset;
+
+  table->num_groups = header->num_groups;
+  table->num_elements = (uint32_t) header->num_elements;
+  table->seed[0] = header->seed[0];
+  table->seed[1] = header->seed[1];
+  FrozenHashTable_BlockSize(table->num_groups, table->num_elements,
+                            &slots_offset);
+  table->pilots =
+    (const uint32_t *) ((const char *) table->block + sizeof(FrozenHeader));
+  table->slots =
+    (const HTKeyValue_t *) ((const char *) table->block + slots_offset);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FrozenHashTable implementation.
+
+size_t FrozenHashTable_BlockSize(uint32_t num_groups,
+                                 uint32_t num_elements,
+                                 size_t *slots_offset) {
+  size_t offset = sizeof(FrozenHeader) + num_groups * sizeof(uint32_t);
+
+  // Keep the slots 16-byte aligned, so none straddles a cache line.
+  offset = (offset + 15) & ~(size_t) 15;
+  *slots_offset = offset;
+  return offset + (size_t) num_elements * sizeof(HTKeyValue_t);
+}
+
+FrozenHashTable* HashTable_Freeze(HashTable *table) {
+  FrozenHashTable *frozen;
+  FrozenHeader *header;
+  HTKeyValue_t *kvs = NULL, *slots;
+  uint64_t *hashes = NULL;
+  uint32_t *slot_of = NULL, *pilots, num_groups;
+  size_t slots_offset;
+  int n, i, attempt;
+  bool placed = false;
+
+  n = HashTable_SortedSnapshot(table, &kvs, 1);
+  if (n < 0) {
+    return NULL;
+  }
+  for (i = 1; i < n; i++) {
+    if (kvs[i].key == kvs[i - 1].key) {
+      free(kvs);
+      return NULL;
+    }
+  }
+
+  frozen = (FrozenHashTable *) malloc(sizeof(FrozenHashTable));
+  if (frozen == NULL) {
+    free(kvs);
+    return NULL;
+  }
+  num_groups = (uint32_t) n / FROZEN_GROUP_KEYS + 1;
+  frozen->num_bytes = FrozenHashTable_BlockSize(num_groups, (uint32_t) n,
+                                                &slots_offset);
+  frozen->block = malloc(frozen->num_bytes);
+  frozen->mapped = false;
+  hashes = (uint64_t *) malloc((n + 1) * sizeof(uint64_t));
+  slot_of = (uint32_t *) malloc((n + 1) * sizeof(uint32_t));
+  if (frozen->block == NULL || hashes == NULL || slot_of == NULL) {
+    goto fail;
+  }
+
+  header = (FrozenHeader *) frozen->block;
+  pilots = (uint32_t *) ((char *) frozen->block + sizeof(FrozenHeader));
+  slots = (HTKeyValue_t *) ((char *) frozen->block + slots_offset);
+  memset(header, 0, slots_offset);
+
+  for (attempt = 0; attempt < FROZEN_MAX_ATTEMPTS && !placed; attempt++) {
+    HTRandomSeed(header->seed);
+    for (i = 0; i < n; i++) {
+      hashes[i] = HTSipHash13(header->seed, kvs[i].key);
+    }
+    placed = PlaceGroups(hashes, (uint32_t) n, num_groups, pilots, slot_of);
+  }
+  if (!placed) {
+    goto fail;
+  }
+
+  for (i = 0; i < n; i++) {
+    slots[slot_of[i]] = kvs[i];
+  }
+  header->magic = FROZEN_MAGIC;
+  header->version = FROZEN_VERSION;
+  header->num_groups = num_groups;
+  header->num_elements = (uint64_t) n;
+  AttachBlock(frozen);
+
+  free(kvs);
+  free(hashes);
+  free(slot_of);
+  return frozen;
+
+ fail:
+  free(frozen->block);
+  free(frozen);
+  free(kvs);
+  free(hashes);
+  free(slot_of);
+  return NULL;
+}
+
+void FrozenHashTable_Free(FrozenHashTable *table,
+                          ValueFreeFnPtr value_free_function) {
+  uint32_t i;
+
+  if (value_free_function != NULL) {
+    for (i = 0; i < table->num_elements; i++) {
+      value_free_function(table->slots[i].value);
+    }
+  }
+  if (table->mapped) {
+    munmap(table->block, table->num_bytes);
+  } else {
+    free(table->block);
+  }
+  free(table);
+}
+
+int FrozenHashTable_NumElements(FrozenHashTable *table) {
+  return (int) table->num_elements;
+}
+
+size_t FrozenHashTable_NumBytes(FrozenHashTable *table) {
+  return table->num_bytes;
+}
+
+bool FrozenHashTable_Find(FrozenHashTable *table,
+                          HTKey_t key,
+                          HTKeyValue_t *keyvalue) {
+  const HTKeyValue_t *slot;
+  uint64_t hash;
+  uint32_t pilot;
+
+  if (table->num_elements == 0) {
+    return false;
+  }
+  hash = HTSipHash13(table->seed, key);
+  pilot = table->pilots[HashToGroup(hash, table->num_groups)];
+  slot = &table->slots[HashToSlot(hash, HTMix64(pilot),
+                                  table->num_elements)];
+
+  // Keys that aren't in the table land on some other key's slot.
+  if (slot->key != key) {
+    return false;
+  }
+  *keyvalue = *slot;
+  return true;
+}
+
+bool FrozenHashTable_Next(FrozenHashTable *table,
+                          uint64_t *position,
+                          HTKeyValue_t *keyvalue) {
+  if (*position >= table->num_elements) {
+    return false;
+  }
+  *keyvalue = table->slots[(*position)++];
+  return true;
+}
+
+bool FrozenHashTable_Write(FrozenHashTable *table, const char *path) {
+  int fd, saved_errno;
+  bool ok;
+
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  ok = WriteAll(fd, (const unsigned char *) table->block, table->num_bytes);
+  saved_errno = errno;
+  if (close(fd) != 0 && ok) {
+    return false;
+  }
+  errno = saved_errno;
+  return ok;
+}
+
+FrozenHashTable* FrozenHashTable_Map(const char *path) {
+  FrozenHashTable *table;
+  const FrozenHeader *header;
+  struct stat st;
+  size_t slots_offset;
+  void *block;
+  int fd;
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(FrozenHeader)) {
+    close(fd);
+    return NULL;
+  }
+  block = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (block == MAP_FAILED) {
+    return NULL;
+  }
+
+  // Check the header before trusting any of it.  Since every slot index a
+  // lookup computes is below num_elements, a file that passes these
+  // checks can give wrong answers if it's been tampered with, but can't
+  // make us read outside the mapping.
+  header = (const FrozenHeader *) block;
+  if (header->magic != FROZEN_MAGIC || header->version != FROZEN_VERSION ||
+      header->num_groups == 0 || header->num_elements > INT32_MAX ||
+      FrozenHashTable_BlockSize(header->num_groups,
+                                (uint32_t) header->num_elements,
+                                &slots_offset) != (size_t) st.st_size) {
+    munmap(block, st.st_size);
+    return NULL;
+  }
+
+  table = (FrozenHashTable *) malloc(sizeof(FrozenHashTable));
+  if (table == NULL) {
+    munmap(block, st.st_size);
+    return NULL;
+  }
+  table->block = block;
+  table->num_bytes = st.st_size;
+  table->mapped = true;
+  AttachBlock(table);
+  return table;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_FROZENHASHTABLE_H_
+#define HW0_FROZENHASHTABLE_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stddef.h>     // for size_t
+#include <stdint.h>     // for uint64_t, etc.
+
+#include "./HashTable.h"  // for HashTable, HTKey_t, HTKeyValue_t
+
+///////////////////////////////////////////////////////////////////////////////
+// A FrozenHashTable is an immutable copy of a HashTable, for tables that
+// are built once and then only read.
+//
+// The keys are indexed by a minimal perfect hash function: every key maps
+// to its own slot in a flat array of exactly NumElements (key,value)
+// pairs, with no empty slots and no chains.  The function is stored as one
+// small "pilot" number per group of about three keys (see
+// FrozenHashTable_priv.h), so a lookup costs one hash, one read from the
+// pilot array and one read from the slot array, and the whole structure
+// takes about 17.5 bytes per key: the 16-byte (key,value) itself, plus
+// its share of the pilots.
+//
+// The table is laid out in a single block that can be written to a file
+// and later mapped back in with FrozenHashTable_Map, without any parsing
+// or rebuilding.
+//
+// As with HashTable, "struct frozen" is defined in FrozenHashTable_priv.h.
+typedef struct frozen FrozenHashTable;
+
+// Builds a FrozenHashTable holding a copy of table's (key,value)s.  Entries
+// whose TTL has passed are left out.  table is not modified, and may be
+// freed or changed afterwards, but the values are shared with it, so free
+// at most one of the two with a value_free_function.
+//
+// Arguments:
+// - table: the table to freeze.  Every key must appear at most once, so an
+//   HT_FLAG_MULTIMAP table can only be frozen if it has no duplicates.
+//
+// Returns NULL on error (out of memory, or a duplicate key), non-NULL on
+// success.
+FrozenHashTable* HashTable_Freeze(HashTable *table);
+
+// Frees a FrozenHashTable, unmapping it if it came from FrozenHashTable_Map.
+//
+// Arguments:
+// - table: the table to free.  It is unsafe to use table after this
+//   function returns.
+// - value_free_function: invoked once for each value in the table, or
+//   NULL if the values don't need freeing.  Must be NULL for a mapped
+//   table, whose values weren't allocated by this process.
+void FrozenHashTable_Free(FrozenHashTable *table,
+                          ValueFreeFnPtr value_free_function);
+
+// Returns the number of entries in the table.
+int FrozenHashTable_NumElements(FrozenHashTable *table);
+
+// Returns the size of the table's block (and of its file), in bytes.
+size_t FrozenHashTable_NumBytes(FrozenHashTable *table);
+
+// Looks up a key; arguments and return values are as for HashTable_Find.
+bool FrozenHashTable_Find(FrozenHashTable *table,
+                          HTKey_t key,
+                          HTKeyValue_t *keyvalue);
+
+// Visits the table's entries, in no particular order.  Set *position to
+// zero before the first call; each call returns the next (key,value) and
+// advances *position.
+//
+// Returns:
+// - true if a (key,value) was returned, or false if there are no more.
+bool FrozenHashTable_Next(FrozenHashTable *table,
+                          uint64_t *position,
+                          HTKeyValue_t *keyvalue);
+
+// Writes the table to a file, replacing anything already there.
+//
+// Values are written as their raw 64-bit contents, so only tables whose
+// values are plain integers (or offsets, or anything else that doesn't
+// point into this process's memory) are meaningful when mapped back in.
+// The file is in host byte order, for reading on the machine that wrote it.
+//
+// Arguments:
+// - table: the table to write.
+// - path: the file to write it to.
+//
+// Returns false on error (with errno set), true on success.
+bool FrozenHashTable_Write(FrozenHashTable *table, const char *path);
+
+// Maps a file written by FrozenHashTable_Write read-only into memory and
+// returns it as a FrozenHashTable.  Nothing is copied or rebuilt, so this
+// takes constant time, and pages are read in as lookups touch them.
+//
+// Arguments:
+// - path: the file to map.
+//
+// Returns NULL on error (the file can't be mapped, or isn't a frozen
+// table written by this version), non-NULL on success.
+FrozenHashTable* FrozenHashTable_Map(const char *path);
+
+#endif  // HW0_FROZENHASHTABLE_H_
@@ -0,0 +1,87 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_FROZENHASHTABLE_PRIV_H_
+#define HW0_FROZENHASHTABLE_PRIV_H_
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>  // for uint64_t, etc.
+
+#include "./FrozenHashTable.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our FrozenHashTable
+// implementation.
+//
+// These would typically be located in FrozenHashTable.c; however, we have
+// broken them out into a "private .h" so that our unittests can access them.
+//
+// Customers should not include this file or assume anything based on
+// its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// The perfect hash.
+//
+// A key's SipHash (keyed by the table's seed) picks one of num_groups
+// groups from its top 32 bits.  Each group g has a pilot p[g], chosen when
+// the table is built, and the key's slot is
+//
+//   ((top 32 bits of ((hash ^ HTMix64(p[g])) * C)) * num_elements) >> 32
+//
+// for an odd constant C.
+//
+// The builder places groups largest first, trying pilots 0, 1, 2, ...
+// until every key of the group lands on a distinct free slot.  Large
+// groups go in while the array is nearly empty and are placed quickly;
+// the singletons at the end only need one free slot each.  If some group
+// can't be placed (which is vanishingly unlikely), we pick a new seed and
+// start over.
+#define FROZEN_GROUP_KEYS 3       // average keys per group
+#define FROZEN_MAX_ATTEMPTS 8     // seeds to try before giving up
+#define FROZEN_PILOT_TRIES 64     // ... times num_elements, per group
+
+// Block layout.  All integers are in host byte order.
+//
+//   FrozenHeader | uint32_t pilots[num_groups] | padding to 16 bytes |
+//   HTKeyValue_t slots[num_elements]
+//
+// The block is the same in memory and on disk.
+#define FROZEN_MAGIC 0x4e455a4f52465448ULL  // "HTFROZEN"
+#define FROZEN_VERSION 1
+
+typedef struct {
+  uint64_t magic;         // FROZEN_MAGIC
+  uint32_t version;       // FROZEN_VERSION
+  uint32_t num_groups;    // # pilots
+  uint64_t num_elements;  // # slots
+  uint64_t seed[2];       // SipHash key
+} FrozenHeader;
+
+// The table.  The fields after block are copied out of its header, so
+// that a lookup only reads the pilot and the slot.
+typedef struct frozen {
+  void               *block;         // the header, pilots and slots
+  size_t              num_bytes;     // size of block
+  bool                mapped;        // did block come from mmap?
+  const uint32_t     *pilots;        // the pilots, in block
+  const HTKeyValue_t *slots;         // the slots, in block
+  uint32_t            num_groups;    // # pilots
+  uint32_t            num_elements;  // # slots
+  uint64_t            seed[2];       // SipHash key
+} FrozenHashTable;
+
+// Returns the size of a block with the given number of groups and slots,
+// and sets *slots_offset to the offset of its slot array.
+size_t FrozenHashTable_BlockSize(uint32_t num_groups,
+                                 uint32_t num_elements,
+                                 size_t *slots_offset);
+
+#endif  // HW0_FROZENHASHTABLE_PRIV_H_
@@ -0,0 +1,82 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_HASHSET_H_
+#define HW0_HASHSET_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stdint.h>     // for uint64_t, etc.
+
+#include "./HashTable.h"  // for HTKey_t, HT_FLAG_*
+
+///////////////////////////////////////////////////////////////////////////////
+// A HashSet is a set of 64-bit keys.  It is a HashTable underneath (same
+// buckets, seeded hashing, tag words and treeified chains), except that
+// each element is just its key: the key is stored directly in the chain
+// node, so there's no per-element entry record, no value, and nothing to
+// free per element.
+//
+// As with HashTable, "struct hs" is defined in HashTable_priv.h.  It is a
+// distinct type from HashTable, so passing a set to a HashTable_* function
+// (or a table to a HashSet_* function) is a compile error.
+typedef struct hs HashSet;
+
+// Allocate and return a new HashSet.
+//
+// Arguments:
+// - num_buckets: the number of buckets the set should initially contain;
+//   MUST be greater than zero.
+// - flags: zero or more HT_FLAG_* values.  HT_FLAG_ARENA and the memory
+//   policy flags (HT_FLAG_HUGE_PAGES, etc) are allowed; HT_FLAG_MULTIMAP
+//   and HT_FLAG_CUCKOO are not.
+//
+// Returns NULL on error, non-NULL on success.
+HashSet* HashSet_Allocate(int num_buckets, int flags);
+
+// Free a HashSet.  It is unsafe to use set after this function returns.
+void HashSet_Free(HashSet *set);
+
+// Returns the number of keys in the set.
+int HashSet_NumElements(HashSet *set);
+
+// Adds a key to the set.
+//
+// Returns:
+// - true if the key was added, or false if it was already present (or
+//   couldn't be added for lack of memory).
+bool HashSet_Add(HashSet *set, HTKey_t key);
+
+// Returns true if the key is in the set.
+bool HashSet_Contains(HashSet *set, HTKey_t key);
+
+// Removes a key from the set.
+//
+// Returns:
+// - true if the key was removed, or false if it wasn't present.
+bool HashSet_Remove(HashSet *set, HTKey_t key);
+
+// Looks up a batch of keys, recording in found[i] whether keys[i] is in
+// the set.  Hashing the whole batch up front and prefetching each key's
+// bucket before looking at it lets the cache misses of different keys
+// overlap, so filtering a stream this way is considerably faster than
+// calling HashSet_Contains on each key.
+//
+// Arguments:
+// - set: the set to look in.
+// - keys: the num_keys keys to look up.
+// - found: an array of num_keys results.
+//
+// Returns:
+// - the number of keys that were found.
+int HashSet_ContainsBatch(HashSet *set, const HTKey_t *keys, int num_keys,
+                          bool *found);
+
+#endif  // HW0_HASHSET_H_
@@ -9,12 +9,23 @@
  * author.
  */
 
+#define _POSIX_C_SOURCE 200809L  // for clock_gettime
+#define _DEFAULT_SOURCE          // for getrandom
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/random.h>
 
 #include "HashTable.h"
 #include "HashTable_priv.h"
+#include "LinkedList_priv.h"  // we walk chain nodes directly
+#include "LatencyStats_priv.h"
+#include "CuckooHashTable_priv.h"  // for HT_FLAG_CUCKOO tables
+#include "HashSet.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 // Internal helper functions.
@@ -25,20 +36,102 @@
 // factor has become too high.
 static void MaybeResize(HashTable *ht);
 
-static bool BucketHasKey(LLIterator *iter, 
-                  HTKey_t key,
-                  HTKeyValue_t **keyvalue);
+// Frees all of a table's bucket trees, and the array that holds them.
+static void FreeBucketTrees(HashTable *table);
+
+// Builds a search tree over a bucket's overflow chain (see
+// HashTable_priv.h).
+static void TreeifyBucket(HashTable *table, int bucket);
+
+// Returns the current time in milliseconds, on the clock used for TTLs.
+static uint64_t HTNowMs(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+// Returns the key held by a chain payload: a HashSet stores the key itself
+// as the payload, and a HashTable a pointer to an HTEntry.
+static inline HTKey_t PayloadKey(HashTable *table, LLPayload_t payload) {
+  if (table->flags & HT_FLAG_SET) {
+    return (HTKey_t) (uintptr_t) payload;
+  }
+  return ((HTEntry *) payload)->kv.key;
+}
+
+// Returns the entry a chain payload stands for.  A HashSet's payloads are
+// keys, which stand for entries with a NULL value and no TTL.
+static inline HTEntry PayloadEntry(HashTable *table, LLPayload_t payload) {
+  HTEntry entry;
+
+  if (table->flags & HT_FLAG_SET) {
+    entry.kv.key = (HTKey_t) (uintptr_t) payload;
+    entry.kv.value = NULL;
+    entry.expiry = 0;
+    return entry;
+  }
+  return *(HTEntry *) payload;
+}
+
+// Returns true if the entry has a TTL and it has passed.
+static bool HTEntryExpired(const HTEntry *entry) {
+  return entry->expiry != 0 && entry->expiry <= HTNowMs();
+}
+
+// Returns true if the bucket holds no entries.
+static inline bool BucketEmpty(HashTable *table, int bucket) {
+  return table->bucket_tags[bucket] == 0;
+}
+
+// Returns the number of entries in the bucket: its first entry, if it has
+// one, and its overflow chain.
+static int BucketSize(HashTable *table, int bucket) {
+  LinkedList *overflow = table->buckets[bucket].overflow;
+
+  if (BucketEmpty(table, bucket)) {
+    return 0;
+  }
+  return 1 + (overflow != NULL ? LinkedList_NumElements(overflow) : 0);
+}
 
 // Implemented for you
 int HashKeyToBucketNum(HashTable *ht, HTKey_t key) {
-  return key % ht->num_buckets;
+  return HTKeyHash(ht, key) % ht->num_buckets;
+}
+
+void HTRandomSeed(uint64_t seed[2]) {
+  static uint64_t counter = 0;
+  struct timespec ts;
+
+  if (getrandom(seed, 2 * sizeof(uint64_t), GRND_NONBLOCK) ==
+      2 * sizeof(uint64_t)) {
+    return;
+  }
+
+  // No entropy to be had (eg, very early in boot).  A seed mixed from the
+  // clock and our address space is guessable in principle, but still
+  // keeps a remote client from planning collisions in advance.
+  clock_gettime(CLOCK_REALTIME, &ts);
+  counter += 1;
+  seed[0] = HTMix64((uint64_t) ts.tv_nsec ^ ((uint64_t) ts.tv_sec << 32) ^
+                    (uint64_t) (uintptr_t) seed);
+  seed[1] = HTMix64(seed[0] ^ (uint64_t) (uintptr_t) &counter ^ counter);
 }
 
 // Deallocation functions that do nothing.  Useful if we want to deallocate
 // the structure (eg, the linked list) without deallocating its elements or
 // if we know that the structure is empty.
 static void LLNoOpFree(LLPayload_t freeme) { }
-static void HTNoOpFree(HTValue_t freeme) { }
+
+// Returns a number that changes whenever the table grows: its bucket
+// count, or a cuckoo table's capacity.
+static int TableSize(HashTable *table) {
+  if (table->cuckoo != NULL) {
+    return CuckooHashTable_Capacity(table->cuckoo);
+  }
+  return table->num_buckets;
+}
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -65,10 +158,36 @@ HTKey_t FNVHash64(unsigned char *buffer, int len) {
   return hval;
 }
 
-// Implemented for you
-HashTable* HashTable_Allocate(int num_buckets) {
+// Allocates memory for the table's internal structures: from its arena if
+// it has one, otherwise from malloc.
+static void* HTAlloc(HashTable *table, size_t size) {
+  if (table->arena != NULL) {
+    return Arena_Alloc(table->arena, size);
+  }
+  return malloc(size);
+}
+
+// Frees memory that HTAlloc returned.
+static void HTRelease(HashTable *table, void *ptr, size_t size) {
+  if (table->arena != NULL) {
+    Arena_Release(table->arena, ptr, size);
+  } else {
+    free(ptr);
+  }
+}
+
+// Returns the size of the allocation that holds num_buckets buckets.
+static size_t BucketMemSize(int num_buckets) {
+  return num_buckets * sizeof(HTBucket) + sizeof(HTBucket) - sizeof(void *);
+}
+
+// Allocates a table record and its buckets.  The resize code uses this to
+// build a table that shares the old table's arena and hash seed; seed is
+// NULL to pick a new one.  Returns NULL if we run out of memory.
+static HashTable* AllocateTable(int num_buckets, int flags, Arena *arena,
+                                const uint64_t *seed) {
+  uintptr_t align = sizeof(HTBucket);  // a power of two
   HashTable *ht;
-  int i;
 
   // Allocate the hash table record.
   ht = (HashTable *) malloc(sizeof(HashTable));
@@ -79,367 +198,2095 @@ HashTable* HashTable_Allocate(int num_buckets) {
   // Initialize the record.
   ht->num_buckets = num_buckets;
   ht->num_elements = 0;
-  ht->buckets = (LinkedList **) malloc(num_buckets * sizeof(LinkedList *));
-  for (i = 0; i < num_buckets; i++) {
-    ht->buckets[i] = LinkedList_Allocate();
+  ht->flags = flags;
+  ht->arena = arena;
+
+  // Neither malloc nor the arena promises more than 8-byte alignment, so
+  // we over-allocate by enough to align the buckets to their own size.
+  ht->bucket_mem = HTAlloc(ht, BucketMemSize(num_buckets));
+  ht->bucket_tags = (uint64_t *) HTAlloc(ht, num_buckets * sizeof(uint64_t));
+  if (ht->bucket_mem == NULL || ht->bucket_tags == NULL) {
+    if (ht->bucket_mem != NULL) {
+      HTRelease(ht, ht->bucket_mem, BucketMemSize(num_buckets));
+    }
+    if (ht->bucket_tags != NULL) {
+      HTRelease(ht, ht->bucket_tags, num_buckets * sizeof(uint64_t));
+    }
+    free(ht);
+    return NULL;
+  }
+  ht->buckets = (HTBucket *) (((uintptr_t) ht->bucket_mem + align - 1) &
+                              ~(align - 1));
+  memset(ht->buckets, 0, num_buckets * sizeof(HTBucket));
+
+  // Every bucket starts out empty, so every tag word starts out zero.
+  memset(ht->bucket_tags, 0, num_buckets * sizeof(uint64_t));
+
+  // The trees, and the timer wheel, are only allocated once needed.
+  ht->bucket_trees = NULL;
+  ht->timers = NULL;
+  ht->cuckoo = NULL;
+
+  if (seed != NULL) {
+    ht->seed[0] = seed[0];
+    ht->seed[1] = seed[1];
+  } else {
+    HTRandomSeed(ht->seed);
   }
 
   return ht;
 }
 
-// Implemented for you
-void HashTable_Free(HashTable *table,
-                    ValueFreeFnPtr value_free_function) {
+// Frees the entries in a table's overflow chains, leaving the chains empty,
+// and first hands every entry's value (including the buckets' first
+// entries') to value_free_function, unless it's NULL.  A HashSet has no
+// entries, so there's nothing to do for one.
+static void FreeEntries(HashTable *table, ValueFreeFnPtr value_free_function) {
   int i;
 
-  // Free each bucket's chain.
+  if (table->flags & HT_FLAG_SET) {
+    return;
+  }
   for (i = 0; i < table->num_buckets; i++) {
-    LinkedList *bucket = table->buckets[i];
-    HTKeyValue_t *kv;
+    LinkedList *overflow = table->buckets[i].overflow;
+    HTEntry *entry;
+
+    if (BucketEmpty(table, i)) {
+      continue;
+    }
+    if (value_free_function != NULL) {
+      value_free_function(table->buckets[i].first.kv.value);
+    }
 
     // Pop elements off the chain list one at a time.  We can't do a single
     // call to LinkedList_Free since we need to use the passed-in
     // value_free_function -- which takes a HTValue_t, not an LLPayload_t -- to
     // free the caller's memory.
-    while (LinkedList_NumElements(bucket) > 0) {
-      LinkedList_Pop(bucket, (LLPayload_t *)&kv);
-      value_free_function(kv->value);
-      free(kv);
+    while (overflow != NULL &&
+           LinkedList_Pop(overflow, (LLPayload_t *) &entry)) {
+      if (value_free_function != NULL) {
+        value_free_function(entry->kv.value);
+      }
+      HTRelease(table, entry, sizeof(HTEntry));
     }
-    // The chain is empty, so we can pass in the
-    // null free function to LinkedList_Free.
-    LinkedList_Free(bucket, LLNoOpFree);
   }
+}
 
-  // Free the bucket array within the table, then free the table record itself.
-  free(table->buckets);
-  free(table);
+// Frees a table's buckets: their overflow lists (whose payloads mustn't
+// need freeing), their trees, and the bucket and tag arrays.
+static void FreeBuckets(HashTable *table) {
+  int i;
+
+  for (i = 0; i < table->num_buckets; i++) {
+    if (table->buckets[i].overflow != NULL) {
+      LinkedList_Free(table->buckets[i].overflow, LLNoOpFree);
+    }
+  }
+  FreeBucketTrees(table);
+  HTRelease(table, table->bucket_mem, BucketMemSize(table->num_buckets));
+  HTRelease(table, table->bucket_tags, table->num_buckets * sizeof(uint64_t));
 }
 
 // Implemented for you
-int HashTable_NumElements(HashTable *table) {
-  return table->num_elements;
+HashTable* HashTable_Allocate(int num_buckets) {
+  return HashTable_AllocateWithFlags(num_buckets, 0);
 }
 
+HashTable* HashTable_AllocateWithFlags(int num_buckets, int flags) {
+  Arena *arena = NULL;
+  HashTable *ht;
+  int policy = 0;
+
+  // The memory policy flags are carried out by the arena.
+  if (flags & HT_FLAG_HUGE_PAGES) policy |= ARENA_POLICY_HUGE_PAGES;
+  if (flags & HT_FLAG_HUGETLB) policy |= ARENA_POLICY_HUGETLB;
+  if (flags & HT_FLAG_NUMA_INTERLEAVE) policy |= ARENA_POLICY_NUMA_INTERLEAVE;
+  if (flags & HT_FLAG_NUMA_LOCAL) policy |= ARENA_POLICY_NUMA_LOCAL;
+  if (policy != 0) {
+    flags |= HT_FLAG_ARENA;
+  }
+
+  // A cuckoo table keeps its entries in the CuckooHashTable, and needs
+  // just one (always empty) chain.
+  if (flags & HT_FLAG_CUCKOO) {
+    if (flags & (HT_FLAG_ARENA | HT_FLAG_MULTIMAP)) {
+      return NULL;
+    }
+    ht = AllocateTable(1, flags, NULL, NULL);
+    if (ht == NULL) {
+      return NULL;
+    }
+    ht->cuckoo = CuckooHashTable_Allocate(num_buckets);
+    if (ht->cuckoo == NULL) {
+      HashTable_Free(ht, NULL);
+      return NULL;
+    }
+    return ht;
+  }
 
+  if (flags & HT_FLAG_ARENA) {
+    arena = Arena_AllocateWithPolicy(policy);
+    if (arena == NULL) {
+      return NULL;
+    }
+  }
 
-//helper method, see if the bucket has the key
-static bool BucketHasKey(LLIterator *iter, 
-                  HTKey_t key,
-                  HTKeyValue_t **keyvalue){
-  while(true){
-    if(!LLIterator_IsValid(iter)) break;
+  ht = AllocateTable(num_buckets, flags, arena, NULL);
+  if (ht == NULL && arena != NULL) {
+    Arena_Free(arena);
+  }
+  return ht;
+}
 
-    LLIterator_Get(iter, (void **) keyvalue);
+// Implemented for you
+void HashTable_Free(HashTable *table,
+                    ValueFreeFnPtr value_free_function) {
+  int i;
 
-    //if found
-    if((*keyvalue) -> key == key) return true;
-    
-    //move to the next one
-    LLIterator_Next(iter);
+  if (table->timers != NULL) {
+    TimerWheel_Free(table->timers);
+  }
+  if (table->cuckoo != NULL) {
+    CuckooHashTable_Free(table->cuckoo, value_free_function);
   }
 
-  return false;
+  // An arena-backed table is torn down in one go: all we have to do first
+  // is hand the customer back their values, if they want them.
+  if (table->arena != NULL) {
+    if (value_free_function != NULL) {
+      for (i = 0; i < table->num_buckets; i++) {
+        LinkedList *overflow = table->buckets[i].overflow;
+        LinkedListNode *node;
+
+        if (BucketEmpty(table, i)) {
+          continue;
+        }
+        value_free_function(table->buckets[i].first.kv.value);
+        for (node = overflow != NULL ? overflow->head : NULL; node != NULL;
+             node = node->next) {
+          value_free_function(((HTEntry *) node->payload)->kv.value);
+        }
+      }
+    }
+    Arena_Free(table->arena);
+    free(table);
+    return;
+  }
 
+  // Free the entries, then the (now empty) chains along with the bucket
+  // array within the table, then the table record itself.
+  FreeEntries(table, value_free_function);
+  FreeBuckets(table);
+  free(table);
 }
 
-bool HashTable_Insert(HashTable *table,
-                      HTKeyValue_t newkeyvalue,
-                      HTKeyValue_t *oldkeyvalue) {
-  int bucket;
-  
-  MaybeResize(table);
+Arena* HashTable_GetArena(HashTable *table) {
+  return table->arena;
+}
+
+// Implemented for you
+int HashTable_NumElements(HashTable *table) {
+  if (table->cuckoo != NULL) {
+    return CuckooHashTable_NumElements(table->cuckoo);
+  }
+  return table->num_elements;
+}
 
-  // Calculate which bucket and chain we're inserting into.
-  bucket = HashKeyToBucketNum(table, newkeyvalue.key);
-  LinkedList *chain = table->buckets[bucket];
+int HashTable_LongestChain(HashTable *table) {
+  int i, longest = 0;
 
-  // STEP 1: finish the implementation of InsertHashTable.
-  // This is a fairly complex task, so you might decide you want
-  // to define/implement a helper function that helps you find
-  // and optionally remove a key within a chain, rather than putting
-  // all that logic inside here.  You might also find that your helper
-  // can be reused in steps 2 and 3.
-  HTKeyValue_t *newpl = (HTKeyValue_t *) malloc(sizeof(HTKeyValue_t));
+  for (i = 0; i < table->num_buckets; i++) {
+    if (BucketSize(table, i) > longest) {
+      longest = BucketSize(table, i);
+    }
+  }
+  return longest;
+}
 
-  //if(newpl == NULL) return false;
 
-  newpl -> key = newkeyvalue.key;
-  newpl -> value = newkeyvalue.value;
 
-  if (LinkedList_NumElements(chain) == 0) {
-    // push newkeyvalue to the bucket, return 0 if push failed
-    LinkedList_Push(chain, newpl);
+// Rebuilds a nonempty bucket's tag word from the keys that remain in it.
+// Bits can't be cleared individually (two keys may share a fingerprint),
+// so after a removal we recompute the word; buckets are small, so this is
+// cheap.
+static void RecomputeBucketTags(HashTable *table, int bucket) {
+  HTBucket *record = &table->buckets[bucket];
+  uint64_t tags = HTHashTagBit(HTKeyHash(table, record->first.kv.key));
+  LinkedListNode *node;
 
-    table->num_elements += 1;
-    // push succeeded
-    return false;
+  for (node = record->overflow != NULL ? record->overflow->head : NULL;
+       node != NULL; node = node->next) {
+    tags |= HTHashTagBit(HTKeyHash(table, PayloadKey(table, node->payload)));
   }
+  table->bucket_tags[bucket] = tags;
+}
 
-  LLIterator *lliter = LLIterator_Allocate(chain);
-
-  HTKeyValue_t *oldpl;
+///////////////////////////////////////////////////////////////////////////////
+// Bucket trees.
+//
+// A treeified bucket's tree is an AVL tree of HTTreeNodes, one per distinct
+// key in its overflow chain, each pointing at the first chain node with its
+// key.  The chain itself is unchanged, so iterators and multimap runs work
+// as before; the tree just lets us find a key's run without walking to it.
+// The bucket's first entry isn't in the tree: lookups check it before
+// they search the tree.
+
+static inline int TreeHeight(HTTreeNode *tnode) {
+  return tnode != NULL ? tnode->height : 0;
+}
 
-  //check if bucket 
-if (BucketHasKey(lliter, newkeyvalue.key, &oldpl)) {
-    //add to the linkedlist
-    LinkedList_Push(chain, newpl);
+// Recomputes tnode's height from its children's.
+static inline void TreeFixHeight(HTTreeNode *tnode) {
+  int lh = TreeHeight(tnode->left), rh = TreeHeight(tnode->right);
 
-    // copy the old key
-    oldkeyvalue->key = oldpl->key;
-    oldkeyvalue->value = oldpl->value;
+  tnode->height = 1 + (lh > rh ? lh : rh);
+}
 
-    // free the ollpayload since we malloc when we inserted it
-    free(oldpl);
+static HTTreeNode* TreeRotateRight(HTTreeNode *tnode) {
+  HTTreeNode *left = tnode->left;
 
-    // detele oldkeyvalue from the bucket
-    LLIterator_Remove(lliter, &LLNoOpFree);
+  tnode->left = left->right;
+  left->right = tnode;
+  TreeFixHeight(tnode);
+  TreeFixHeight(left);
+  return left;
+}
 
-    LLIterator_Free(lliter);
-   
+static HTTreeNode* TreeRotateLeft(HTTreeNode *tnode) {
+  HTTreeNode *right = tnode->right;
 
-    // append succeed
-    return true;
-  }
-  
-  LLIterator_Free(lliter);
-  // push newkeyvalue to the bucket
-  LinkedList_Push(chain, newpl);
+  tnode->right = right->left;
+  right->left = tnode;
+  TreeFixHeight(tnode);
+  TreeFixHeight(right);
+  return right;
+}
 
-  // push succeed
-  table->num_elements += 1;
+// Restores the AVL property at tnode, whose subtrees are balanced and
+// differ in height by at most two, and returns the subtree's new root.
+static HTTreeNode* TreeBalance(HTTreeNode *tnode) {
+  int balance;
 
-  return false;  // you may need to change this return value
+  TreeFixHeight(tnode);
+  balance = TreeHeight(tnode->left) - TreeHeight(tnode->right);
+  if (balance > 1) {
+    if (TreeHeight(tnode->left->left) < TreeHeight(tnode->left->right)) {
+      tnode->left = TreeRotateLeft(tnode->left);
+    }
+    return TreeRotateRight(tnode);
+  }
+  if (balance < -1) {
+    if (TreeHeight(tnode->right->right) < TreeHeight(tnode->right->left)) {
+      tnode->right = TreeRotateRight(tnode->right);
+    }
+    return TreeRotateLeft(tnode);
+  }
+  return tnode;
 }
 
+static HTTreeNode* TreeFind(HTTreeNode *root, HTKey_t key) {
+  while (root != NULL && root->key != key) {
+    root = (key < root->key) ? root->left : root->right;
+  }
+  return root;
+}
 
+// Adds tnode, whose key isn't in the tree yet, and returns the new root.
+static HTTreeNode* TreeInsert(HTTreeNode *root, HTTreeNode *tnode) {
+  if (root == NULL) {
+    return tnode;
+  }
+  if (tnode->key < root->key) {
+    root->left = TreeInsert(root->left, tnode);
+  } else {
+    root->right = TreeInsert(root->right, tnode);
+  }
+  return TreeBalance(root);
+}
 
+// Unlinks the smallest node in the tree, returning it via *min, and
+// returns the new root.
+static HTTreeNode* TreeRemoveMin(HTTreeNode *root, HTTreeNode **min) {
+  if (root->left == NULL) {
+    *min = root;
+    return root->right;
+  }
+  root->left = TreeRemoveMin(root->left, min);
+  return TreeBalance(root);
+}
 
+// Unlinks the node with the given key (which must be present), returning
+// it via *removed, and returns the new root.
+static HTTreeNode* TreeRemove(HTTreeNode *root, HTKey_t key,
+                              HTTreeNode **removed) {
+  HTTreeNode *min, *right;
 
-bool HashTable_Find(HashTable *table,
-                    HTKey_t key,
-                    HTKeyValue_t *keyvalue) {
-  // STEP 2: implement HashTable_Find.
+  if (key < root->key) {
+    root->left = TreeRemove(root->left, key, removed);
+    return TreeBalance(root);
+  }
+  if (key > root->key) {
+    root->right = TreeRemove(root->right, key, removed);
+    return TreeBalance(root);
+  }
 
-  HTKey_t bucket;
-  HTKeyValue_t *payload;
+  *removed = root;
+  if (root->left == NULL) return root->right;
+  if (root->right == NULL) return root->left;
 
-  bucket = HashKeyToBucketNum(table, key);
-  LinkedList *chain = table -> buckets[bucket];
+  // Replace the node with its successor.
+  right = TreeRemoveMin(root->right, &min);
+  min->left = root->left;
+  min->right = right;
+  return TreeBalance(min);
+}
 
-  //if this list contains zero elements
-  if(LinkedList_NumElements(chain) == 0) return false;
+static void TreeFree(HashTable *table, HTTreeNode *root) {
+  if (root != NULL) {
+    TreeFree(table, root->left);
+    TreeFree(table, root->right);
+    HTRelease(table, root, sizeof(HTTreeNode));
+  }
+}
 
-  //if this list contains elements
-  LLIterator *lliter = LLIterator_Allocate(chain);
+// Returns the bucket's tree, or NULL if the bucket isn't treeified.
+static inline HTTreeNode* BucketTree(HashTable *table, int bucket) {
+  return table->bucket_trees != NULL ? table->bucket_trees[bucket] : NULL;
+}
 
-  //if this bucket has this key, then store the payload into return parameter, keyvalue
-  if(BucketHasKey(lliter, key, &payload)){
-    keyvalue -> key = payload ->key;
-    keyvalue -> value = payload -> value;
+static void FreeBucketTrees(HashTable *table) {
+  int i;
 
-    LLIterator_Free(lliter);
-    return true;
+  if (table->bucket_trees == NULL) {
+    return;
   }
-
-  LLIterator_Free(lliter);
-  return false;  // you may need to change this return value
+  for (i = 0; i < table->num_buckets; i++) {
+    TreeFree(table, table->bucket_trees[i]);
+  }
+  HTRelease(table, table->bucket_trees,
+            table->num_buckets * sizeof(HTTreeNode *));
+  table->bucket_trees = NULL;
 }
 
-bool HashTable_Remove(HashTable *table,
-                      HTKey_t key,
-                      HTKeyValue_t *keyvalue) {
-  // STEP 3: implement HashTable_Remove.
+// Drops a bucket's tree, going back to walking its chain.
+static void UntreeifyBucket(HashTable *table, int bucket) {
+  TreeFree(table, table->bucket_trees[bucket]);
+  table->bucket_trees[bucket] = NULL;
+  RecomputeBucketTags(table, bucket);
+}
 
-  HTKey_t bucket;
-  HTKeyValue_t *payload;
+static void TreeifyBucket(HashTable *table, int bucket) {
+  HTTreeNode *root = NULL;
+  LinkedListNode *node;
 
-  bucket = HashKeyToBucketNum(table, key);
-  LinkedList *chain = table -> buckets[bucket];
+  if (table->bucket_trees == NULL) {
+    size_t size = table->num_buckets * sizeof(HTTreeNode *);
 
-  //if this list contains zero elements
-  if(LinkedList_NumElements(chain) == 0) return false;
+    table->bucket_trees = (HTTreeNode **) HTAlloc(table, size);
+    if (table->bucket_trees == NULL) {
+      return;
+    }
+    memset(table->bucket_trees, 0, size);
+  }
 
-  //if this list contains elements
-  LLIterator *lliter = LLIterator_Allocate(chain);
+  // Walking from the head, the first node we meet with a key is the head
+  // of that key's run.  If we run out of memory, the bucket just stays a
+  // plain chain.
+  for (node = table->buckets[bucket].overflow->head; node != NULL;
+       node = node->next) {
+    HTKey_t key = PayloadKey(table, node->payload);
+    HTTreeNode *tnode;
 
-  //if this bucket has this key, then store the payload into return parameter, keyvalue
-  if(BucketHasKey(lliter, key, &payload)){
-    keyvalue -> key = payload -> key;
-    keyvalue -> value = payload -> value;
+    if (TreeFind(root, key) != NULL) continue;
 
-    free(payload);
+    tnode = (HTTreeNode *) HTAlloc(table, sizeof(HTTreeNode));
+    if (tnode == NULL) {
+      TreeFree(table, root);
+      return;
+    }
+    tnode->key = key;
+    tnode->chain_node = node;
+    tnode->left = tnode->right = NULL;
+    tnode->height = 1;
+    root = TreeInsert(root, tnode);
+  }
+  table->bucket_trees[bucket] = root;
+  table->bucket_tags[bucket] = ~0ULL;
+}
 
-    LLIterator_Remove(lliter, &LLNoOpFree);
-    LLIterator_Free(lliter);
+// Updates the bucket's tree (if any) for an overflow chain node that was
+// just linked in, at the head of its key's run; a bucket that's grown too
+// big gets a tree.
+static void TreeAddNode(HashTable *table, int bucket, LinkedListNode *node) {
+  HTTreeNode *root = BucketTree(table, bucket), *tnode;
+  HTKey_t key = PayloadKey(table, node->payload);
 
-    table->num_elements -= 1;
+  if (root == NULL) {
+    if (BucketSize(table, bucket) > HT_TREEIFY_THRESHOLD) {
+      TreeifyBucket(table, bucket);
+    }
+    return;
+  }
 
-    return true;
+  tnode = TreeFind(root, key);
+  if (tnode != NULL) {
+    tnode->chain_node = node;  // a multimap's new run head
+    return;
   }
 
-  LLIterator_Free(lliter);
-  return false;  // you may need to change this return value
+  // If we can't index the node, lookups couldn't find it through the
+  // tree, so we stop using the tree.
+  tnode = (HTTreeNode *) HTAlloc(table, sizeof(HTTreeNode));
+  if (tnode == NULL) {
+    UntreeifyBucket(table, bucket);
+    return;
+  }
+  tnode->key = key;
+  tnode->chain_node = node;
+  tnode->left = tnode->right = NULL;
+  tnode->height = 1;
+  table->bucket_trees[bucket] = TreeInsert(root, tnode);
 }
 
+// Updates the bucket's tree (if any) for an overflow chain node that's
+// about to be unlinked.
+static void TreeRemoveNode(HashTable *table, int bucket,
+                           LinkedListNode *node) {
+  HTTreeNode *root = BucketTree(table, bucket), *tnode;
+  HTKey_t key = PayloadKey(table, node->payload);
 
-///////////////////////////////////////////////////////////////////////////////
-// HTIterator implementation.
-
-// Implemented for you
-HTIterator* HTIterator_Allocate(HashTable *table) {
-  HTIterator *iter;
-  int         i;
+  if (root == NULL) {
+    return;
+  }
+  tnode = TreeFind(root, key);
+  if (tnode->chain_node != node) {
+    return;  // not the head of its run
+  }
+  if (node->next != NULL && PayloadKey(table, node->next->payload) == key) {
+    tnode->chain_node = node->next;
+    return;
+  }
+  table->bucket_trees[bucket] = TreeRemove(root, key, &tnode);
+  HTRelease(table, tnode, sizeof(HTTreeNode));
+}
 
-  iter = (HTIterator *) malloc(sizeof(HTIterator));
 
-  // If the hash table is empty, the iterator is immediately invalid,
-  // since it can't point to anything.
-  if (table->num_elements == 0) {
-    iter->ht = table;
-    iter->bucket_it = NULL;
-    iter->bucket_idx = INVALID_IDX;
-    return iter;
+///////////////////////////////////////////////////////////////////////////////
+// HashTable chain operations.
+
+// Returns the first node in the bucket's overflow chain whose entry has
+// the given key, or NULL.  We walk the nodes directly rather than through
+// an LLIterator so that a lookup never allocates; a treeified bucket is
+// searched through its tree instead.
+static LinkedListNode* FindOverflowNode(HashTable *table, int bucket,
+                                        HTKey_t key) {
+  HTTreeNode *root = BucketTree(table, bucket);
+  LinkedList *overflow = table->buckets[bucket].overflow;
+  LinkedListNode *node;
+
+  if (root != NULL) {
+    HTTreeNode *tnode = TreeFind(root, key);
+    return tnode != NULL ? tnode->chain_node : NULL;
+  }
+  if (overflow == NULL) {
+    return NULL;
   }
 
-  // Initialize the iterator.  There is at least one element in the
-  // table, so find the first element and point the iterator at it.
-  iter->ht = table;
-  for (i = 0; i < table->num_buckets; i++) {
-    if (LinkedList_NumElements(table->buckets[i]) > 0) {
-      iter->bucket_idx = i;
-      break;
+  for (node = overflow->head; node != NULL; node = node->next) {
+    if (PayloadKey(table, node->payload) == key) {
+      return node;
     }
   }
-  iter->bucket_it = LLIterator_Allocate(table->buckets[iter->bucket_idx]);
-  return iter;
+  return NULL;
 }
 
-// Implemented for you
-void HTIterator_Free(HTIterator *iter) {
-  if (iter->bucket_it != NULL) {
-    LLIterator_Free(iter->bucket_it);
-    iter->bucket_it = NULL;
+// Returns the first entry in a nonempty bucket with the given key, or
+// NULL.  Most hits are on the bucket's first entry, and so read nothing
+// past its tag word and record.  Not for HashSets, whose overflow payloads
+// aren't entries.
+static HTEntry* FindEntry(HashTable *table, int bucket, HTKey_t key) {
+  HTBucket *record = &table->buckets[bucket];
+  LinkedListNode *node;
+
+  if (record->first.kv.key == key) {
+    return &record->first;
   }
-  free(iter);
+  node = FindOverflowNode(table, bucket, key);
+  return node != NULL ? (HTEntry *) node->payload : NULL;
 }
 
-bool HTIterator_IsValid(HTIterator *iter) {
-  // STEP 4: implement HTIterator_IsValid.
-  if( iter -> ht -> num_elements == 0 ) return false;
-  if (iter -> bucket_idx >= iter->ht->num_buckets) return false;
-  if( (!LLIterator_IsValid(iter -> bucket_it) ))
-  return false;
+// Links a payload into the bucket's overflow chain, just ahead of the node
+// before, or at the tail if before is NULL, and returns its chain node.
+// The chain's list is allocated on first use.
+//
+// Returns NULL if we run out of memory.
+static LinkedListNode* LinkOverflow(HashTable *table, int bucket,
+                                    LLPayload_t payload,
+                                    LinkedListNode *before) {
+  HTBucket *record = &table->buckets[bucket];
+  LLIterator lliter;
+
+  if (record->overflow == NULL) {
+    record->overflow = (table->arena != NULL) ?
+        LinkedList_AllocateInArena(table->arena) : LinkedList_Allocate();
+    if (record->overflow == NULL) {
+      return NULL;
+    }
+  }
 
-  return true;  // you may need to change this return value
+  if (before == NULL) {
+    if (!LinkedList_Append(record->overflow, payload)) {
+      return NULL;
+    }
+    return record->overflow->tail;
+  }
+  lliter.list = record->overflow;
+  lliter.node = before;
+  if (!LLIterator_Insert(&lliter, payload)) {
+    return NULL;
+  }
+  return before->prev;
 }
 
-bool HTIterator_Next(HTIterator *iter) {
-  // STEP 5: implement HTIterator_Next.
-  if(HTIterator_IsValid(iter) == false) return false;
-  if(iter == NULL) return false;
-  if(iter -> ht == NULL) return false;
+// Allocates a new entry for key (whose HTKeyHash is hash), with a NULL
+// value and no TTL, and links it into the table.  Outside of multimaps the
+// caller has already checked that the key is absent.  The entry takes its
+// bucket's first slot if the bucket is empty, and otherwise goes on the
+// tail of the bucket's overflow chain; except that in a multimap it goes
+// just ahead of any entries that share its key, which keeps them
+// contiguous and newest first.
+//
+// Returns NULL if we run out of memory.
+static HTEntry* AddEntry(HashTable *table, HTKey_t key, uint64_t hash) {
+  uint64_t tag = HTHashTagBit(hash);
+  LinkedListNode *run = NULL, *node = NULL;
+  HTBucket *record;
+  HTEntry *entry;
+  bool displaced = false;
+  int bucket;
 
-  //if the lliterator does not past the end, move to the next one
-  if(LLIterator_Next(iter -> bucket_it)) {
-    return true;}
-  else{
-     int i = 0;
-    //locate to the next non-empty bucket
-    for (i = iter->bucket_idx + 1; i < iter->ht->num_buckets; i++) {
-    
-    if (LinkedList_NumElements(iter->ht->buckets[i]) > 0) {
-      iter->bucket_idx = i;
-      break;
+  // Only grow the table when we're actually adding to it.  A resize moves
+  // the key to a different bucket (keeping any run of duplicates intact),
+  // so we look for the run afterwards.  The seed survives the resize, so
+  // hash is still good.
+  MaybeResize(table);
+  bucket = hash % table->num_buckets;
+  record = &table->buckets[bucket];
+
+  if (BucketEmpty(table, bucket)) {
+    entry = &record->first;
+  } else {
+    entry = (HTEntry *) HTAlloc(table, sizeof(HTEntry));
+    if (entry == NULL) {
+      return NULL;
+    }
+    if ((table->flags & HT_FLAG_MULTIMAP) &&
+        (table->bucket_tags[bucket] & tag)) {
+      if (record->first.kv.key == key) {
+        // The key's run starts in the first slot, so the slot's entry
+        // moves to the head of the overflow chain to make room.
+        *entry = record->first;
+        run = (record->overflow != NULL) ? record->overflow->head : NULL;
+        displaced = true;
+      } else {
+        run = FindOverflowNode(table, bucket, key);
+      }
+    }
+    node = LinkOverflow(table, bucket, entry, run);
+    if (node == NULL) {
+      HTRelease(table, entry, sizeof(HTEntry));
+      return NULL;
+    }
+    if (displaced) {
+      entry = &record->first;
     }
-
   }
 
-  //if there is no more non empty buckets ahead
-  if (i == (iter->ht->num_buckets)) {
-    return false;
+  entry->kv.key = key;
+  entry->kv.value = NULL;
+  entry->expiry = 0;
+  table->bucket_tags[bucket] |= tag;
+  table->num_elements += 1;
+  if (node != NULL) {
+    TreeAddNode(table, bucket, node);
   }
+  return entry;
+}
+
+// Returns the entry for key, adding an entry (with a NULL value and no
+// TTL) if there isn't one.  *added reports which happened.  The bucket is
+// searched at most once, and nothing is allocated when the key is present.
+//
+// Returns NULL if a new entry was needed but couldn't be allocated.
+static HTEntry* FindOrAddEntry(HashTable *table, HTKey_t key, bool *added) {
+  uint64_t hash = HTKeyHash(table, key);
+  int bucket = hash % table->num_buckets;
+
+  // If the key's fingerprint isn't in the bucket's tag word, the key can't
+  // be in the bucket, so we skip the search.
+  if (table->bucket_tags[bucket] & HTHashTagBit(hash)) {
+    HTEntry *entry = FindEntry(table, bucket, key);
+
+    if (entry != NULL) {
+      *added = false;
+      return entry;
+    }
   }
-  
 
-  LLIterator_Free(iter->bucket_it);
-  iter->bucket_it = LLIterator_Allocate(iter->ht->buckets[iter->bucket_idx]);
+  *added = true;
+  return AddEntry(table, key, hash);
+}
 
+// Unlinks a node from the bucket's overflow chain and frees its entry,
+// leaving the customer's (key,value) in *keyvalue.  (A HashSet has no
+// entries, so the value is NULL.)  The caller settles the bucket.
+static void UnlinkOverflow(HashTable *table, int bucket,
+                           LinkedListNode *node, HTKeyValue_t *keyvalue) {
+  LLIterator lliter;
+
+  TreeRemoveNode(table, bucket, node);
+  *keyvalue = PayloadEntry(table, node->payload).kv;
+  if (!(table->flags & HT_FLAG_SET)) {
+    HTRelease(table, node->payload, sizeof(HTEntry));
+  }
 
-  return true;  // you may need to change this return value
+  // Unlink the node through a stack iterator parked on it.
+  lliter.list = table->buckets[bucket].overflow;
+  lliter.node = node;
+  LLIterator_Remove(&lliter, &LLNoOpFree);
 }
 
-bool HTIterator_Get(HTIterator *iter, HTKeyValue_t *keyvalue) {
-  // STEP 6: implement HTIterator_Get.
-  HTKeyValue_t *payload;
-  //if(iter -> ht == NULL) return false;
+// Removes a nonempty bucket's first entry, leaving the customer's
+// (key,value) in *keyvalue.  The head of the overflow chain, if there is
+// one, moves up into the first slot; otherwise the bucket is now empty.
+// The caller settles the bucket.
+static void RemoveFirst(HashTable *table, int bucket,
+                        HTKeyValue_t *keyvalue) {
+  HTBucket *record = &table->buckets[bucket];
+  LLPayload_t payload;
+
+  *keyvalue = record->first.kv;
+  if (record->overflow == NULL ||
+      LinkedList_NumElements(record->overflow) == 0) {
+    table->bucket_tags[bucket] = 0;
+    return;
+  }
 
-  if(HTIterator_IsValid(iter)){
-      LLIterator_Get(iter -> bucket_it, (void **) &payload);
+  TreeRemoveNode(table, bucket, record->overflow->head);
+  LinkedList_Pop(record->overflow, &payload);
+  record->first = PayloadEntry(table, payload);
+  if (!(table->flags & HT_FLAG_SET)) {
+    HTRelease(table, payload, sizeof(HTEntry));
+  }
+}
 
-      keyvalue->key = payload->key;
-      keyvalue->value = payload->value;
+// Brings a bucket's tag word and tree up to date after removals from it.
+// A treeified bucket's tag word stays all ones until the tree is dropped.
+static void SettleBucket(HashTable *table, int bucket) {
+  if (BucketEmpty(table, bucket)) {
+    return;
+  }
+  if (BucketTree(table, bucket) == NULL) {
+    RecomputeBucketTags(table, bucket);
+  } else if (BucketSize(table, bucket) < HT_UNTREEIFY_THRESHOLD) {
+    UntreeifyBucket(table, bucket);
+  }
+}
 
-      return true;
+// Removes an entry from the given bucket: the overflow chain node node,
+// or the bucket's first entry if node is NULL.  The customer's
+// (key,value) is left in *keyvalue.
+static void RemoveNode(HashTable *table,
+                       int bucket,
+                       LinkedListNode *node,
+                       HTKeyValue_t *keyvalue) {
+  if (node == NULL) {
+    RemoveFirst(table, bucket, keyvalue);
+  } else {
+    UnlinkOverflow(table, bucket, node, keyvalue);
   }
-  return false;  // you may need to change this return value
+  SettleBucket(table, bucket);
+  table->num_elements -= 1;
 }
 
-// Implemented for you
-bool HTIterator_Remove(HTIterator *iter, HTKeyValue_t *keyvalue) {
-  HTKeyValue_t kv;
+// Inserts a (key,value) with the given expiry time; this is the guts of
+// HashTable_Insert and HashTable_InsertWithTTL.  An existing entry is
+// updated in place, except in a multimap, where we always add one.
+static bool InsertEntry(HashTable *table,
+                        HTKeyValue_t newkeyvalue,
+                        uint64_t expiry,
+                        HTKeyValue_t *oldkeyvalue) {
+  bool added = true;
+  HTEntry *entry;
+
+  if (table->cuckoo != NULL) {
+    return CuckooHashTable_Insert(table->cuckoo, newkeyvalue, oldkeyvalue);
+  }
+  if (table->flags & HT_FLAG_MULTIMAP) {
+    entry = AddEntry(table, newkeyvalue.key,
+                     HTKeyHash(table, newkeyvalue.key));
+  } else {
+    entry = FindOrAddEntry(table, newkeyvalue.key, &added);
+  }
 
-  // Try to get what the iterator is pointing to.
-  if (!HTIterator_Get(iter, &kv)) {
+  if (entry == NULL) {
     return false;
   }
+  if (!added) {
+    *oldkeyvalue = entry->kv;
+  }
+  entry->kv.value = newkeyvalue.value;
+  entry->expiry = expiry;
+  return !added;
+}
 
-  // Advance the iterator.  Thanks to the above call to
-  // HTIterator_Get, we know that this iterator is valid (though it
-  // may not be valid after this call to HTIterator_Next).
-  HTIterator_Next(iter);
-
-  // Lastly, remove the element.  Again, we know this call will succeed
-  // due to the successful HTIterator_Get above.
-  HashTable_Remove(iter->ht, kv.key, keyvalue);
-
-  return true;
+bool HashTable_Insert(HashTable *table,
+                      HTKeyValue_t newkeyvalue,
+                      HTKeyValue_t *oldkeyvalue) {
+  uint64_t start = LatencyStart();
+  int size = TableSize(table);
+  bool replaced = InsertEntry(table, newkeyvalue, 0, oldkeyvalue);
+
+  // Inserts that resized the table are timed separately, so that they
+  // don't hide in (or distort) the ordinary inserts' percentiles.
+  LatencyRecord(TableSize(table) != size ?
+                LAT_HT_INSERT_RESIZE : LAT_HT_INSERT, start);
+  return replaced;
 }
 
-// Implemented for you
-static void MaybeResize(HashTable *ht) {
-  HashTable *newht;
-  HashTable tmp;
-  HTIterator *it;
+bool HashTable_InsertWithTTL(HashTable *table,
+                             HTKeyValue_t newkeyvalue,
+                             uint64_t ttl_ms,
+                             HTKeyValue_t *oldkeyvalue) {
+  uint64_t now = HTNowMs();
+  uint64_t expiry = now + (ttl_ms > 0 ? ttl_ms : 1);
 
-  // Resize if the load factor is > 3.
-  if (ht->num_elements < 3 * ht->num_buckets)
-    return;
+  if (table->cuckoo != NULL) {
+    return InsertEntry(table, newkeyvalue, 0, oldkeyvalue);
+  }
+  if (table->timers == NULL) {
+    table->timers = TimerWheel_Allocate(now);
+    if (table->timers == NULL) {
+      return false;
+    }
+  }
 
-  // This is the resize case.  Allocate a new hashtable,
-  // iterate over the old hashtable, do the surgery on
-  // the old hashtable record and free up the new hashtable
-  // record.
-  newht = HashTable_Allocate(ht->num_buckets * 9);
+  // The timer goes in first: an entry with an expiry time but no timer
+  // would never be reaped.  The timer isn't cancelled if the entry is later
+  // replaced or removed (or never inserted, for lack of memory);
+  // ExpireTimerFired checks that the entry still has this expiry time.
+  if (!TimerWheel_Add(table->timers, newkeyvalue.key, expiry)) {
+    return false;
+  }
+  return InsertEntry(table, newkeyvalue, expiry, oldkeyvalue);
+}
+
+HTValue_t* HashTable_FindOrInsert(HashTable *table,
+                                  HTKey_t key,
+                                  bool *inserted) {
+  HTEntry *entry;
 
-  // Loop through the old ht copying its elements over into the new one.
-  for (it = HTIterator_Allocate(ht);
-       HTIterator_IsValid(it);
-       HTIterator_Next(it)) {
-    HTKeyValue_t item, unused;
+  if (table->cuckoo != NULL) {
+    return CuckooHashTable_FindOrInsert(table->cuckoo, key, inserted);
+  }
+  entry = FindOrAddEntry(table, key, inserted);
+  if (entry == NULL) {
+    return NULL;
+  }
 
-    HTIterator_Get(it, &item);
-    HashTable_Insert(newht, item, &unused);
+  // An entry whose TTL has passed is as good as gone, so it's revived as a
+  // new entry with no TTL.  Its stale value stays in the slot for the
+  // caller to free.
+  if (!*inserted && HTEntryExpired(entry)) {
+    entry->expiry = 0;
+    *inserted = true;
   }
+  return &entry->kv.value;
+}
+
+bool HashTable_Upsert(HashTable *table,
+                      HTKeyValue_t newkeyvalue,
+                      HTMergeFnPtr merge_function,
+                      HTValue_t *expired_value) {
+  HTValue_t *value;
+  bool added;
+
+  *expired_value = NULL;
+  value = HashTable_FindOrInsert(table, newkeyvalue.key, &added);
+  if (value == NULL) {
+    return false;
+  }
+  if (added) {
+    *expired_value = *value;
+    *value = newkeyvalue.value;
+    return false;
+  }
+  *value = merge_function(*value, newkeyvalue.value);
+  return true;
+}
+
+// The guts of HashTable_Find.
+static bool FindLiveEntry(HashTable *table,
+                          HTKey_t key,
+                          HTKeyValue_t *keyvalue) {
+  uint64_t hash;
+  int bucket;
+  HTEntry *entry;
+
+  if (table->cuckoo != NULL) {
+    return CuckooHashTable_Find(table->cuckoo, key, keyvalue);
+  }
+  hash = HTKeyHash(table, key);
+  bucket = hash % table->num_buckets;
+
+  // A clear fingerprint bit means the key is definitely absent; this also
+  // covers empty buckets, since their tag word is zero.
+  if ((table->bucket_tags[bucket] & HTHashTagBit(hash)) == 0) return false;
+
+  entry = FindEntry(table, bucket, key);
+  if (entry == NULL) return false;
+
+  // An entry whose TTL has passed is a miss, even if the timer wheel
+  // hasn't gotten around to removing it yet.
+  if (HTEntryExpired(entry)) return false;
+
+  *keyvalue = entry->kv;
+  return true;
+}
+
+bool HashTable_Find(HashTable *table,
+                    HTKey_t key,
+                    HTKeyValue_t *keyvalue) {
+  uint64_t start = LatencyStart();
+  bool found = FindLiveEntry(table, key, keyvalue);
+
+  LatencyRecord(LAT_HT_FIND, start);
+  return found;
+}
+
+// The guts of HashTable_Remove.
+static bool RemoveEntry(HashTable *table,
+                        HTKey_t key,
+                        HTKeyValue_t *keyvalue) {
+  uint64_t hash;
+  int bucket;
+  LinkedListNode *node;
+
+  if (table->cuckoo != NULL) {
+    return CuckooHashTable_Remove(table->cuckoo, key, keyvalue);
+  }
+  hash = HTKeyHash(table, key);
+  bucket = hash % table->num_buckets;
+
+  // As in HashTable_Find, a clear fingerprint bit means a definite miss.
+  if ((table->bucket_tags[bucket] & HTHashTagBit(hash)) == 0) return false;
+
+  // A NULL node stands for the bucket's first entry.
+  node = NULL;
+  if (table->buckets[bucket].first.kv.key != key) {
+    node = FindOverflowNode(table, bucket, key);
+    if (node == NULL) return false;
+  }
+
+  RemoveNode(table, bucket, node, keyvalue);
+  return true;
+}
+
+bool HashTable_Remove(HashTable *table,
+                      HTKey_t key,
+                      HTKeyValue_t *keyvalue) {
+  uint64_t start = LatencyStart();
+  bool removed = RemoveEntry(table, key, keyvalue);
+
+  LatencyRecord(LAT_HT_REMOVE, start);
+  return removed;
+}
+
+// What an HTKeyCursor's next points at.
+#define HT_CURSOR_NODE 0    // an overflow chain node
+#define HT_CURSOR_LONE 1    // a lone HTKeyValue_t, in a cuckoo table
+#define HT_CURSOR_BUCKET 2  // a bucket record, whose first entry is next
+
+void HashTable_FindAll(HashTable *table, HTKey_t key, HTKeyCursor *cursor) {
+  uint64_t hash;
+  int bucket;
+
+  cursor->key = key;
+  cursor->next = NULL;
+  cursor->kind = HT_CURSOR_NODE;
+  if (table->cuckoo != NULL) {
+    cursor->next = CuckooHashTable_Lookup(table->cuckoo, key);
+    cursor->kind = HT_CURSOR_LONE;
+    return;
+  }
+
+  hash = HTKeyHash(table, key);
+  bucket = hash % table->num_buckets;
+  if ((table->bucket_tags[bucket] & HTHashTagBit(hash)) == 0) {
+    return;
+  }
+  if (table->buckets[bucket].first.kv.key == key) {
+    cursor->next = &table->buckets[bucket];
+    cursor->kind = HT_CURSOR_BUCKET;
+  } else {
+    cursor->next = FindOverflowNode(table, bucket, key);
+  }
+}
+
+bool HTKeyCursor_Next(HTKeyCursor *cursor, HTKeyValue_t *keyvalue) {
+  LinkedListNode *node;
+
+  if (cursor->kind == HT_CURSOR_LONE) {
+    if (cursor->next == NULL) {
+      return false;
+    }
+    *keyvalue = *(HTKeyValue_t *) cursor->next;
+    cursor->next = NULL;
+    return true;
+  }
+
+  // A run that starts with a bucket's first entry carries on at the head
+  // of its overflow chain.
+  if (cursor->kind == HT_CURSOR_BUCKET) {
+    HTBucket *record = (HTBucket *) cursor->next;
+
+    cursor->next = (record->overflow != NULL) ? record->overflow->head : NULL;
+    cursor->kind = HT_CURSOR_NODE;
+    if (!HTEntryExpired(&record->first)) {
+      *keyvalue = record->first.kv;
+      return true;
+    }
+  }
+
+  // The key's entries are contiguous, so the first entry with some other
+  // key ends the run.
+  node = (LinkedListNode *) cursor->next;
+  while (node != NULL && ((HTEntry *) node->payload)->kv.key == cursor->key) {
+    HTEntry *entry = (HTEntry *) node->payload;
+
+    node = node->next;
+    if (!HTEntryExpired(entry)) {
+      cursor->next = node;
+      *keyvalue = entry->kv;
+      return true;
+    }
+  }
+
+  cursor->next = NULL;
+  return false;
+}
+
+int HashTable_CountKey(HashTable *table, HTKey_t key, int limit) {
+  HTKeyCursor cursor;
+  HTKeyValue_t kv;
+  int count = 0;
+
+  HashTable_FindAll(table, key, &cursor);
+  while ((limit <= 0 || count < limit) && HTKeyCursor_Next(&cursor, &kv)) {
+    count += 1;
+  }
+  return count;
+}
+
+
+// State threaded through TimerWheel_Advance by HashTable_ExpireEntries.
+typedef struct {
+  HashTable      *table;
+  ValueFreeFnPtr  value_free_function;
+  int             num_removed;
+} HTExpireState;
+
+// Invoked by the timer wheel for each timer that comes due.  The timer may
+// be stale (the entry was removed, replaced, or given a new TTL), so we
+// only remove an entry if it still carries this exact expiry time.  In a
+// multimap, that may be any entry in the key's run.
+static void ExpireTimerFired(uint64_t key, uint64_t deadline, void *arg) {
+  HTExpireState *state = (HTExpireState *) arg;
+  HashTable *table = state->table;
+  uint64_t hash = HTKeyHash(table, key);
+  int bucket = hash % table->num_buckets;
+  HTEntry *first = &table->buckets[bucket].first;
+  LinkedListNode *node = NULL;
+  HTKeyValue_t kv;
+
+  if ((table->bucket_tags[bucket] & HTHashTagBit(hash)) == 0) return;
+
+  // A NULL node stands for the bucket's first entry.
+  if (first->kv.key != key || first->expiry != deadline) {
+    for (node = FindOverflowNode(table, bucket, key); node != NULL;
+         node = node->next) {
+      HTEntry *entry = (HTEntry *) node->payload;
+
+      if (entry->kv.key != key) return;  // the end of the key's run
+      if (entry->expiry == deadline) break;
+    }
+    if (node == NULL) return;
+  }
+
+  RemoveNode(table, bucket, node, &kv);
+  if (state->value_free_function != NULL) {
+    state->value_free_function(kv.value);
+  }
+  state->num_removed += 1;
+}
+
+int HashTable_ExpireEntries(HashTable *table,
+                            int max_timers,
+                            ValueFreeFnPtr value_free_function) {
+  HTExpireState state;
+
+  if (table->timers == NULL) {
+    return 0;
+  }
+
+  state.table = table;
+  state.value_free_function = value_free_function;
+  state.num_removed = 0;
+  TimerWheel_Advance(table->timers, HTNowMs(), max_timers,
+                     &ExpireTimerFired, &state);
+  return state.num_removed;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Bulk removal implementation.
+
+#define HT_REMOVE_BATCH 64  // values we hold before freeing them
+
+// Values waiting to be freed by HashTable_RemoveIf.
+typedef struct {
+  ValueFreeFnPtr  value_free_function;  // or NULL
+  int             num_values;
+  HTValue_t       values[HT_REMOVE_BATCH];
+} HTFreeBatch;
+
+static void FlushFreeBatch(HTFreeBatch *batch) {
+  int i;
+
+  if (batch->value_free_function != NULL) {
+    for (i = 0; i < batch->num_values; i++) {
+      batch->value_free_function(batch->values[i]);
+    }
+  }
+  batch->num_values = 0;
+}
+
+static void AddToFreeBatch(HTFreeBatch *batch, HTValue_t value) {
+  batch->values[batch->num_values++] = value;
+  if (batch->num_values == HT_REMOVE_BATCH) {
+    FlushFreeBatch(batch);
+  }
+}
+
+// Removes the matching entries of a cuckoo table.  Removing an entry may
+// move a stashed one into its slot, so we only step past a slot once
+// we've kept what's in it.
+static int CuckooRemoveIf(HashTable *table,
+                          HTPredicateFnPtr predicate_function, void *arg,
+                          HTFreeBatch *batch) {
+  uint64_t position = 0;
+  HTKeyValue_t *slot, kv;
+  int removed = 0;
+
+  while ((slot = CuckooHashTable_EntryAt(table->cuckoo, &position)) !=
+         NULL) {
+    kv = *slot;
+    if (predicate_function(&kv, arg)) {
+      CuckooHashTable_Remove(table->cuckoo, kv.key, &kv);
+      AddToFreeBatch(batch, kv.value);
+      removed++;
+    } else {
+      position++;
+    }
+  }
+  return removed;
+}
+
+int HashTable_RemoveIf(HashTable *table,
+                       HTPredicateFnPtr predicate_function,
+                       void *arg,
+                       ValueFreeFnPtr value_free_function) {
+  HTFreeBatch batch;
+  int i, removed = 0;
+
+  batch.value_free_function = value_free_function;
+  batch.num_values = 0;
+
+  if (table->cuckoo != NULL) {
+    removed = CuckooRemoveIf(table, predicate_function, arg, &batch);
+    FlushFreeBatch(&batch);
+    return removed;
+  }
+
+  for (i = 0; i < table->num_buckets; i++) {
+    HTBucket *record = &table->buckets[i];
+    LinkedListNode *node, *next;
+    HTEntry entry;
+    int before;
+
+    if (BucketEmpty(table, i)) {
+      continue;
+    }
+    before = BucketSize(table, i);
+
+    // As in RemoveNode, but the bucket is settled once all of it has been
+    // through.  The overflow chain goes first, so that whatever moves up
+    // into the first slot has already been kept.
+    for (node = record->overflow != NULL ? record->overflow->head : NULL;
+         node != NULL; node = next) {
+      next = node->next;
+      entry = PayloadEntry(table, node->payload);
+      if (!HTEntryExpired(&entry) && !predicate_function(&entry.kv, arg)) {
+        continue;
+      }
+      UnlinkOverflow(table, i, node, &entry.kv);
+      AddToFreeBatch(&batch, entry.kv.value);
+    }
+    entry = record->first;
+    if (HTEntryExpired(&entry) || predicate_function(&entry.kv, arg)) {
+      RemoveFirst(table, i, &entry.kv);
+      AddToFreeBatch(&batch, entry.kv.value);
+    }
+
+    if (BucketSize(table, i) != before) {
+      removed += before - BucketSize(table, i);
+      SettleBucket(table, i);
+    }
+  }
+
+  table->num_elements -= removed;
+  FlushFreeBatch(&batch);
+  return removed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Sorted snapshot implementation.
+//
+// We sort with an LSD radix sort on the 64-bit key, one byte per pass.
+// Each pass counts the byte values in the source array, turns the counts
+// into output positions, and scatters into the other array; passes in
+// which every key has the same byte are skipped.  With several threads,
+// each thread counts and scatters its own slice of the array, and the
+// slices' positions are interleaved so that the sort stays stable.
+
+#define HT_RADIX_BITS 8
+#define HT_RADIX (1 << HT_RADIX_BITS)
+#define HT_MAX_THREADS 64
+#define HT_MIN_KEYS_PER_THREAD 65536
+
+// Copies the (key,value) of every unexpired entry into out, which must
+// have room for table->num_elements entries, and returns how many were
+// copied.
+static int CopyLiveEntries(HashTable *table, HTKeyValue_t *out) {
+  int i, n = 0;
+
+  if (table->cuckoo != NULL) {
+    uint64_t position = 0;
+
+    while (CuckooHashTable_Next(table->cuckoo, &position, &out[n])) {
+      n++;
+    }
+    return n;
+  }
+
+  for (i = 0; i < table->num_buckets; i++) {
+    LinkedList *overflow = table->buckets[i].overflow;
+    LinkedListNode *node;
+
+    if (BucketEmpty(table, i)) {
+      continue;
+    }
+    if (!HTEntryExpired(&table->buckets[i].first)) {
+      out[n++] = table->buckets[i].first.kv;
+    }
+    for (node = overflow != NULL ? overflow->head : NULL; node != NULL;
+         node = node->next) {
+      HTEntry *entry = (HTEntry *) node->payload;
+
+      if (!HTEntryExpired(entry)) {
+        out[n++] = entry->kv;
+      }
+    }
+  }
+  return n;
+}
+
+// The part of the sort owned by one thread.
+typedef struct {
+  HTKeyValue_t *src;             // array we're sorting from this pass
+  HTKeyValue_t *dst;             // array we're scattering into
+  int           lo, hi;          // our slice of src is [lo, hi)
+  int           shift;           // which byte of the key this pass uses
+  int           hist[HT_RADIX];  // digit counts, then scatter positions
+} RadixSlice;
+
+static void* RadixCountSlice(void *arg) {
+  RadixSlice *slice = (RadixSlice *) arg;
+  int i;
+
+  memset(slice->hist, 0, sizeof(slice->hist));
+  for (i = slice->lo; i < slice->hi; i++) {
+    slice->hist[(slice->src[i].key >> slice->shift) & (HT_RADIX - 1)]++;
+  }
+  return NULL;
+}
+
+static void* RadixScatterSlice(void *arg) {
+  RadixSlice *slice = (RadixSlice *) arg;
+  int i;
+
+  for (i = slice->lo; i < slice->hi; i++) {
+    int digit = (slice->src[i].key >> slice->shift) & (HT_RADIX - 1);
+    slice->dst[slice->hist[digit]++] = slice->src[i];
+  }
+  return NULL;
+}
+
+// Runs fn over every slice, one thread per slice; the slices are
+// slice_size bytes apart.  The calling thread takes slice 0, and any slice
+// whose thread can't be started is run on the calling thread too.
+static void RunSlices(void *(*fn)(void *), void *slices, size_t slice_size,
+                      int num_slices) {
+  pthread_t threads[HT_MAX_THREADS];
+  bool started[HT_MAX_THREADS];
+  char *base = (char *) slices;
+  int i;
+
+  for (i = 1; i < num_slices; i++) {
+    started[i] = (pthread_create(&threads[i], NULL, fn,
+                                 base + i * slice_size) == 0);
+  }
+  fn(base);
+  for (i = 1; i < num_slices; i++) {
+    if (started[i]) {
+      pthread_join(threads[i], NULL);
+    } else {
+      fn(base + i * slice_size);
+    }
+  }
+}
+
+// Sorts a[0..n) by key, using tmp (also n long) as scratch space.  Returns
+// whichever of a and tmp holds the sorted result.
+static HTKeyValue_t* RadixSortByKey(HTKeyValue_t *a, HTKeyValue_t *tmp,
+                                    int n, int num_threads) {
+  RadixSlice slices[HT_MAX_THREADS];
+  HTKeyValue_t *src = a, *dst = tmp;
+  int shift, t, digit;
+
+  for (t = 0; t < num_threads; t++) {
+    slices[t].lo = (int) ((int64_t) n * t / num_threads);
+    slices[t].hi = (int) ((int64_t) n * (t + 1) / num_threads);
+  }
+
+  for (shift = 0; shift < 64; shift += HT_RADIX_BITS) {
+    int base = 0;
+    bool skip = false;
+
+    for (t = 0; t < num_threads; t++) {
+      slices[t].src = src;
+      slices[t].dst = dst;
+      slices[t].shift = shift;
+    }
+    RunSlices(&RadixCountSlice, slices, sizeof(RadixSlice), num_threads);
+
+    // Turn the counts into starting positions: all of digit 0 (slice by
+    // slice), then all of digit 1, and so on.
+    for (digit = 0; digit < HT_RADIX && !skip; digit++) {
+      int total = 0;
+
+      for (t = 0; t < num_threads; t++) {
+        int count = slices[t].hist[digit];
+        slices[t].hist[digit] = base + total;
+        total += count;
+      }
+      base += total;
+      skip = (total == n);
+    }
+    if (skip) {
+      // Every key has the same byte here; this pass wouldn't move anything.
+      continue;
+    }
+
+    RunSlices(&RadixScatterSlice, slices, sizeof(RadixSlice),
+              num_threads);
+    src = dst;
+    dst = (src == a) ? tmp : a;
+  }
+  return src;
+}
+
+int HashTable_SortedSnapshot(HashTable *table,
+                             HTKeyValue_t **snapshot,
+                             int num_threads) {
+  HTKeyValue_t *out = *snapshot, *tmp, *sorted;
+  int n;
+
+  if (out == NULL) {
+    if (HashTable_NumElements(table) == 0) {
+      return 0;
+    }
+    out = (HTKeyValue_t *) malloc(HashTable_NumElements(table) *
+                                  sizeof(HTKeyValue_t));
+    if (out == NULL) {
+      return -1;
+    }
+  }
+
+  n = CopyLiveEntries(table, out);
+
+  // Don't spin up threads that would have too little to do.
+  if (num_threads > n / HT_MIN_KEYS_PER_THREAD) {
+    num_threads = n / HT_MIN_KEYS_PER_THREAD;
+  }
+  if (num_threads > HT_MAX_THREADS) {
+    num_threads = HT_MAX_THREADS;
+  }
+  if (num_threads < 1) {
+    num_threads = 1;
+  }
+
+  if (n > 1) {
+    tmp = (HTKeyValue_t *) malloc(n * sizeof(HTKeyValue_t));
+    if (tmp == NULL) {
+      if (*snapshot == NULL) {
+        free(out);
+      }
+      return -1;
+    }
+    sorted = RadixSortByKey(out, tmp, n, num_threads);
+    if (sorted != out) {
+      memcpy(out, sorted, n * sizeof(HTKeyValue_t));
+    }
+    free(tmp);
+  }
+
+  *snapshot = out;
+  return n;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Join and set operation implementation.
+//
+// Probing one table's chains for every entry of another jumps all over
+// memory.  Instead we copy both inputs out and radix-partition them by the
+// top bits of their keys' hash, choosing enough partitions that one
+// partition of the right-hand input (plus a small hash index over it)
+// fits in cache.  Matching keys always land in the same partition, so each
+// partition pair is then joined on its own: we index the right-hand
+// partition and stream the left-hand one past it.  Partitions are divided
+// among threads round-robin.
+//
+// The hash is SipHash-1-3 under a seed drawn afresh for each join, so a
+// customer who picks the keys can't crowd them into one partition, or
+// into one chain of a partition's index.
+
+#define HT_JOIN_PARTITION_ENTRIES 4096  // target right-hand entries/partition
+#define HT_JOIN_MAX_PARTITION_BITS 12   // single-pass fanout stays TLB-sized
+#define HT_JOIN_NIL (-1)
+
+// Which operation a join pass is running.
+typedef enum {
+  HT_JOIN,
+  HT_INTERSECT,
+  HT_UNION,
+  HT_DIFFERENCE
+} HTJoinOp;
+
+// One input, copied out and partitioned.  Partition p is the slice
+// [start[p], start[p + 1]) of kvs.
+typedef struct {
+  HTKeyValue_t *kvs;
+  int          *start;
+} HTJoinInput;
+
+// The state owned by one join thread.
+typedef struct {
+  HTJoinOp       op;
+  uint64_t      *seed;             // the join's SipHash key
+  HTJoinInput   *left, *right;
+  int            num_partitions;
+  int            first_partition;  // we take every stride'th partition
+  int            stride;
+  HTJoinFnPtr    fn;
+  void          *arg;
+  int           *slots;            // hash index heads, HT_JOIN_NIL if empty
+  int           *next;             // hash index chains, by right-hand offset
+  unsigned char *matched;          // HT_UNION: right-hand entry was matched
+  int64_t        num_results;
+} HTJoinWorker;
+
+// Returns the partition number of a key's hash, given how many bits we
+// use.
+static inline int JoinPartition(uint64_t hash, int bits) {
+  return bits == 0 ? 0 : (int) (hash >> (64 - bits));
+}
+
+// Copies a table's live entries into in->kvs, grouped by partition of
+// their hash under seed.  Returns false if we run out of memory.
+static bool PartitionInput(HashTable *table, const uint64_t seed[2],
+                           int bits, HTJoinInput *in) {
+  int num_partitions = 1 << bits;
+  HTKeyValue_t *flat;
+  int *part;
+  int *pos;
+  int i, n;
+
+  in->kvs = NULL;
+  in->start = (int *) calloc(num_partitions + 1, sizeof(int));
+  flat = (HTKeyValue_t *) malloc((HashTable_NumElements(table) + 1) *
+                                 sizeof(HTKeyValue_t));
+  if (in->start == NULL || flat == NULL) {
+    free(flat);
+    return false;
+  }
+  n = CopyLiveEntries(table, flat);
+
+  if (bits == 0) {
+    in->kvs = flat;
+    in->start[1] = n;
+    return true;
+  }
+
+  in->kvs = (HTKeyValue_t *) malloc((n + 1) * sizeof(HTKeyValue_t));
+  part = (int *) malloc((n + 1) * sizeof(int));
+  pos = (int *) malloc(num_partitions * sizeof(int));
+  if (in->kvs == NULL || part == NULL || pos == NULL) {
+    free(pos);
+    free(part);
+    free(flat);
+    return false;
+  }
+
+  // Count each partition, turn the counts into starting offsets, and
+  // scatter.  Each key is hashed once, on the counting pass.
+  for (i = 0; i < n; i++) {
+    part[i] = JoinPartition(HTSipHash13(seed, flat[i].key), bits);
+    in->start[part[i] + 1]++;
+  }
+  for (i = 0; i < num_partitions; i++) {
+    in->start[i + 1] += in->start[i];
+    pos[i] = in->start[i];
+  }
+  for (i = 0; i < n; i++) {
+    in->kvs[pos[part[i]]++] = flat[i];
+  }
+
+  free(pos);
+  free(part);
+  free(flat);
+  return true;
+}
+
+// Joins one partition pair.
+static void JoinOnePartition(HTJoinWorker *w, int p) {
+  HTKeyValue_t *lkvs = w->left->kvs + w->left->start[p];
+  HTKeyValue_t *rkvs = w->right->kvs + w->right->start[p];
+  int nl = w->left->start[p + 1] - w->left->start[p];
+  int nr = w->right->start[p + 1] - w->right->start[p];
+  int mask, i, j;
+
+  // Index the right-hand partition.  The partition number came from the
+  // top bits of the hash, so the index uses the bottom ones.
+  for (mask = 1; mask < 2 * nr; mask <<= 1) {
+  }
+  mask -= 1;
+  for (i = 0; i <= mask; i++) {
+    w->slots[i] = HT_JOIN_NIL;
+  }
+  for (j = nr - 1; j >= 0; j--) {
+    int slot = (int) (HTSipHash13(w->seed, rkvs[j].key) & mask);
+
+    w->next[j] = w->slots[slot];
+    w->slots[slot] = j;
+    if (w->op == HT_UNION) {
+      w->matched[j] = 0;
+    }
+  }
+
+  // Stream the left-hand partition past the index.
+  for (i = 0; i < nl; i++) {
+    HTKey_t key = lkvs[i].key;
+    bool found = false;
+
+    j = (nr == 0) ? HT_JOIN_NIL
+                  : w->slots[HTSipHash13(w->seed, key) & mask];
+    for (; j != HT_JOIN_NIL; j = w->next[j]) {
+      if (rkvs[j].key != key) continue;
+
+      if (w->op == HT_UNION) {
+        w->matched[j] = 1;
+      }
+      if (w->op == HT_JOIN || (!found && w->op != HT_DIFFERENCE)) {
+        w->fn(&lkvs[i], &rkvs[j], w->arg);
+        w->num_results += 1;
+      }
+      found = true;
+      if (w->op != HT_JOIN && w->op != HT_UNION) break;
+    }
+
+    if (!found && (w->op == HT_UNION || w->op == HT_DIFFERENCE)) {
+      w->fn(&lkvs[i], NULL, w->arg);
+      w->num_results += 1;
+    }
+  }
+
+  // A union also reports the right-hand entries nobody matched.
+  if (w->op == HT_UNION) {
+    for (j = 0; j < nr; j++) {
+      if (!w->matched[j]) {
+        w->fn(NULL, &rkvs[j], w->arg);
+        w->num_results += 1;
+      }
+    }
+  }
+}
+
+static void* JoinWorkerMain(void *arg) {
+  HTJoinWorker *w = (HTJoinWorker *) arg;
+  int p;
+
+  for (p = w->first_partition; p < w->num_partitions; p += w->stride) {
+    JoinOnePartition(w, p);
+  }
+  return NULL;
+}
+
+// Runs op over left and right; this is the guts of HashTable_Join,
+// HashTable_Intersect, HashTable_Union and HashTable_Difference.
+static int64_t RunJoin(HTJoinOp op, HashTable *left, HashTable *right,
+                       HTJoinFnPtr fn, void *arg, int num_threads) {
+  HTJoinWorker workers[HT_MAX_THREADS];
+  HTJoinInput in_left = { NULL, NULL }, in_right = { NULL, NULL };
+  uint64_t seed[2];
+  int bits = 0, max_right = 0, max_slots = 1, num_partitions, t, p;
+  int64_t num_results = -1;
+  bool ok;
+
+  while (bits < HT_JOIN_MAX_PARTITION_BITS &&
+         (HashTable_NumElements(right) >> bits) > HT_JOIN_PARTITION_ENTRIES) {
+    bits++;
+  }
+  num_partitions = 1 << bits;
+
+  if (num_threads > num_partitions) {
+    num_threads = num_partitions;
+  }
+  if (num_threads > HT_MAX_THREADS) {
+    num_threads = HT_MAX_THREADS;
+  }
+  if (num_threads < 1) {
+    num_threads = 1;
+  }
+  memset(workers, 0, sizeof(workers));
+
+  HTRandomSeed(seed);
+  ok = PartitionInput(left, seed, bits, &in_left) &&
+       PartitionInput(right, seed, bits, &in_right);
+
+  // Every worker gets scratch space big enough for the largest right-hand
+  // partition.
+  for (p = 0; ok && p < num_partitions; p++) {
+    int nr = in_right.start[p + 1] - in_right.start[p];
+    if (nr > max_right) max_right = nr;
+  }
+  while (max_slots < 2 * max_right) {
+    max_slots <<= 1;
+  }
+  for (t = 0; ok && t < num_threads; t++) {
+    HTJoinWorker *w = &workers[t];
+
+    w->op = op;
+    w->seed = seed;
+    w->left = &in_left;
+    w->right = &in_right;
+    w->num_partitions = num_partitions;
+    w->first_partition = t;
+    w->stride = num_threads;
+    w->fn = fn;
+    w->arg = arg;
+    w->slots = (int *) malloc(max_slots * sizeof(int));
+    w->next = (int *) malloc((max_right + 1) * sizeof(int));
+    w->matched = (unsigned char *) malloc(max_right + 1);
+    ok = (w->slots != NULL && w->next != NULL && w->matched != NULL);
+  }
+
+  if (ok) {
+    RunSlices(&JoinWorkerMain, workers, sizeof(HTJoinWorker), num_threads);
+    num_results = 0;
+    for (t = 0; t < num_threads; t++) {
+      num_results += workers[t].num_results;
+    }
+  }
+
+  for (t = 0; t < num_threads; t++) {
+    free(workers[t].slots);
+    free(workers[t].next);
+    free(workers[t].matched);
+  }
+  free(in_left.kvs);
+  free(in_left.start);
+  free(in_right.kvs);
+  free(in_right.start);
+  return num_results;
+}
+
+int64_t HashTable_Join(HashTable *left, HashTable *right,
+                       HTJoinFnPtr join_function, void *arg,
+                       int num_threads) {
+  return RunJoin(HT_JOIN, left, right, join_function, arg, num_threads);
+}
+
+int64_t HashTable_Intersect(HashTable *left, HashTable *right,
+                            HTJoinFnPtr join_function, void *arg,
+                            int num_threads) {
+  return RunJoin(HT_INTERSECT, left, right, join_function, arg,
+                 num_threads);
+}
+
+int64_t HashTable_Union(HashTable *left, HashTable *right,
+                        HTJoinFnPtr join_function, void *arg,
+                        int num_threads) {
+  return RunJoin(HT_UNION, left, right, join_function, arg, num_threads);
+}
+
+int64_t HashTable_Difference(HashTable *left, HashTable *right,
+                             HTJoinFnPtr join_function, void *arg,
+                             int num_threads) {
+  return RunJoin(HT_DIFFERENCE, left, right, join_function, arg,
+                 num_threads);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// HashSet implementation.
+//
+// A HashSet wraps a HashTable with HT_FLAG_SET, whose overflow payloads
+// are keys (see PayloadKey), and whose buckets keep their first key in
+// first.kv.key.  The bucket machinery is shared; only the parts that would
+// touch an HTEntry are done differently here.
+
+#define HT_SET_BATCH 16  // keys whose lookups HashSet_ContainsBatch overlaps
+
+HashSet* HashSet_Allocate(int num_buckets, int flags) {
+  HashSet *set;
+
+  if (flags & (HT_FLAG_MULTIMAP | HT_FLAG_CUCKOO)) {
+    return NULL;
+  }
+  set = (HashSet *) malloc(sizeof(HashSet));
+  if (set == NULL) {
+    return NULL;
+  }
+  set->table = HashTable_AllocateWithFlags(num_buckets, flags);
+  if (set->table == NULL) {
+    free(set);
+    return NULL;
+  }
+  set->table->flags |= HT_FLAG_SET;
+  return set;
+}
+
+void HashSet_Free(HashSet *set) {
+  HashTable *table = set->table;
+
+  // There are no entries to free, so the buckets can go as they are.
+  if (table->arena != NULL) {
+    Arena_Free(table->arena);
+  } else {
+    FreeBuckets(table);
+  }
+  free(table);
+  free(set);
+}
+
+int HashSet_NumElements(HashSet *set) {
+  return set->table->num_elements;
+}
+
+// Returns true if the set's nonempty bucket holds key.
+static bool SetBucketContains(HashTable *table, int bucket, HTKey_t key) {
+  return table->buckets[bucket].first.kv.key == key ||
+         FindOverflowNode(table, bucket, key) != NULL;
+}
+
+bool HashSet_Add(HashSet *set, HTKey_t key) {
+  HashTable *table = set->table;
+  uint64_t hash = HTKeyHash(table, key);
+  int bucket = hash % table->num_buckets;
+  LinkedListNode *node = NULL;
+
+  if ((table->bucket_tags[bucket] & HTHashTagBit(hash)) &&
+      SetBucketContains(table, bucket, key)) {
+    return false;
+  }
+
+  // As in AddEntry, though with no runs to keep together.
+  MaybeResize(table);
+  bucket = hash % table->num_buckets;
+  if (BucketEmpty(table, bucket)) {
+    table->buckets[bucket].first.kv.key = key;
+    table->buckets[bucket].first.kv.value = NULL;
+    table->buckets[bucket].first.expiry = 0;
+  } else {
+    node = LinkOverflow(table, bucket, (LLPayload_t) (uintptr_t) key, NULL);
+    if (node == NULL) {
+      return false;
+    }
+  }
+  table->bucket_tags[bucket] |= HTHashTagBit(hash);
+  table->num_elements += 1;
+  if (node != NULL) {
+    TreeAddNode(table, bucket, node);
+  }
+  return true;
+}
+
+bool HashSet_Contains(HashSet *set, HTKey_t key) {
+  HashTable *table = set->table;
+  uint64_t hash = HTKeyHash(table, key);
+  int bucket = hash % table->num_buckets;
+
+  if ((table->bucket_tags[bucket] & HTHashTagBit(hash)) == 0) {
+    return false;
+  }
+  return SetBucketContains(table, bucket, key);
+}
+
+bool HashSet_Remove(HashSet *set, HTKey_t key) {
+  HTKeyValue_t kv;
+
+  return RemoveEntry(set->table, key, &kv);
+}
+
+int HashSet_ContainsBatch(HashSet *set, const HTKey_t *keys, int num_keys,
+                          bool *found) {
+  HashTable *table = set->table;
+  int buckets[HT_SET_BATCH];
+  uint64_t tags[HT_SET_BATCH];
+  int base, i, n, num_found = 0;
+
+  for (base = 0; base < num_keys; base += HT_SET_BATCH) {
+    n = num_keys - base < HT_SET_BATCH ? num_keys - base : HT_SET_BATCH;
+
+    // Each pass touches memory the previous pass prefetched, and
+    // prefetches what the next one needs: first the tag word, then the
+    // bucket record, then (if the first key isn't a match) the overflow
+    // list, whose head node the last pass reads.
+    for (i = 0; i < n; i++) {
+      uint64_t hash = HTKeyHash(table, keys[base + i]);
+
+      buckets[i] = hash % table->num_buckets;
+      tags[i] = HTHashTagBit(hash);
+      found[base + i] = false;
+      __builtin_prefetch(&table->bucket_tags[buckets[i]]);
+    }
+    for (i = 0; i < n; i++) {
+      if (table->bucket_tags[buckets[i]] & tags[i]) {
+        __builtin_prefetch(&table->buckets[buckets[i]]);
+      } else {
+        buckets[i] = -1;  // a definite miss
+      }
+    }
+    for (i = 0; i < n; i++) {
+      HTBucket *record;
+
+      if (buckets[i] < 0) continue;
+      record = &table->buckets[buckets[i]];
+      if (record->first.kv.key == keys[base + i]) {
+        found[base + i] = true;
+        buckets[i] = -1;
+      } else if (record->overflow != NULL) {
+        __builtin_prefetch(record->overflow);
+      } else {
+        buckets[i] = -1;
+      }
+    }
+    for (i = 0; i < n; i++) {
+      if (buckets[i] >= 0) {
+        found[base + i] =
+            FindOverflowNode(table, buckets[i], keys[base + i]) != NULL;
+      }
+      num_found += found[base + i];
+    }
+  }
+  return num_found;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// HTIterator implementation.
+//
+// The iterator walks each nonempty bucket's first entry and then its
+// overflow chain.  Its LLIterator is parked on a NULL node while it's at a
+// first entry, and moves along the overflow chain after that.
+
+// Moves the iterator to the first entry of the first nonempty bucket at or
+// after bucket, and returns true; or returns false if there are none.
+static bool HTIteratorSeek(HTIterator *iter, int bucket) {
+  HashTable *table = iter->ht;
+
+  iter->bucket_it->node = NULL;
+  for (; bucket < table->num_buckets; bucket++) {
+    if (!BucketEmpty(table, bucket)) {
+      iter->bucket_idx = bucket;
+      return true;
+    }
+  }
+  iter->bucket_idx = INVALID_IDX;
+  return false;
+}
+
+// Implemented for you
+HTIterator* HTIterator_Allocate(HashTable *table) {
+  HTIterator *iter;
+
+  iter = (HTIterator *) malloc(sizeof(HTIterator));
+  if (iter == NULL) {
+    return NULL;
+  }
+  iter->ht = table;
+  iter->bucket_it = NULL;
+  iter->bucket_idx = INVALID_IDX;
+  iter->cuckoo_pos = 0;
+
+  // A cuckoo table's iterator is just a position in its CuckooHashTable.
+  if (table->cuckoo != NULL) {
+    return iter;
+  }
+
+  // The bucket iterator is reused from bucket to bucket, so walking the
+  // table never allocates.
+  iter->bucket_it = (LLIterator *) malloc(sizeof(LLIterator));
+  if (iter->bucket_it == NULL) {
+    free(iter);
+    return NULL;
+  }
+  iter->bucket_it->list = NULL;
+  iter->bucket_it->index = 0;
+
+  // Point the iterator at the first element, if there is one; if the hash
+  // table is empty, the iterator is immediately invalid.
+  HTIteratorSeek(iter, 0);
+  return iter;
+}
+
+// Implemented for you
+void HTIterator_Free(HTIterator *iter) {
+  if (iter->bucket_it != NULL) {
+    LLIterator_Free(iter->bucket_it);
+    iter->bucket_it = NULL;
+  }
+  free(iter);
+}
+
+bool HTIterator_IsValid(HTIterator *iter) {
+  // STEP 4: implement HTIterator_IsValid.
+  if (iter->ht->cuckoo != NULL) {
+    return CuckooHashTable_EntryAt(iter->ht->cuckoo, &iter->cuckoo_pos) != NULL;
+  }
+  if (iter->bucket_idx == INVALID_IDX) return false;
+  if (iter->bucket_idx >= iter->ht->num_buckets) return false;
+
+  return !BucketEmpty(iter->ht, iter->bucket_idx);
+}
+
+bool HTIterator_Next(HTIterator *iter) {
+  // STEP 5: implement HTIterator_Next.
+  LinkedList *overflow;
+  LinkedListNode *node;
+
+  if(HTIterator_IsValid(iter) == false) return false;
+
+  if (iter->ht->cuckoo != NULL) {
+    iter->cuckoo_pos += 1;
+    return HTIterator_IsValid(iter);
+  }
+
+  // From a bucket's first entry we go on to its overflow chain, and from
+  // the end of that to the next nonempty bucket.
+  overflow = iter->ht->buckets[iter->bucket_idx].overflow;
+  node = iter->bucket_it->node;
+  if (node == NULL) {
+    node = (overflow != NULL) ? overflow->head : NULL;
+  } else {
+    node = node->next;
+  }
+  if (node != NULL) {
+    iter->bucket_it->list = overflow;
+    iter->bucket_it->node = node;
+    return true;
+  }
+  return HTIteratorSeek(iter, iter->bucket_idx + 1);
+}
+
+bool HTIterator_Get(HTIterator *iter, HTKeyValue_t *keyvalue) {
+  // STEP 6: implement HTIterator_Get.
+  LinkedListNode *node;
+
+  if (iter->ht->cuckoo != NULL) {
+    HTKeyValue_t *kv = CuckooHashTable_EntryAt(iter->ht->cuckoo,
+                                               &iter->cuckoo_pos);
+    if (kv == NULL) return false;
+    *keyvalue = *kv;
+    return true;
+  }
+
+  if (!HTIterator_IsValid(iter)) {
+    return false;
+  }
+  node = iter->bucket_it->node;
+  if (node == NULL) {
+    *keyvalue = iter->ht->buckets[iter->bucket_idx].first.kv;
+  } else {
+    *keyvalue = PayloadEntry(iter->ht, node->payload).kv;
+  }
+  return true;
+}
+
+// Implemented for you
+bool HTIterator_Remove(HTIterator *iter, HTKeyValue_t *keyvalue) {
+  HTKeyValue_t kv;
+  LinkedListNode *node;
+  int bucket;
+
+  // Try to get what the iterator is pointing to.
+  if (!HTIterator_Get(iter, &kv)) {
+    return false;
+  }
+
+  // Removing from a cuckoo table may move a stashed entry into the freed
+  // slot, so rather than advancing, we leave the iterator where it is: the
+  // next entry (if any) is at or after the same position.
+  if (iter->ht->cuckoo != NULL) {
+    return CuckooHashTable_Remove(iter->ht->cuckoo, kv.key, keyvalue);
+  }
+
+  // Remember exactly which entry we're on; in a multimap, removing by key
+  // could take a different entry with the same key.
+  bucket = iter->bucket_idx;
+  node = iter->bucket_it->node;
+
+  // Removing a bucket's first entry moves the next one up into its place,
+  // so there we stay put, unless the bucket is now empty.
+  if (node == NULL) {
+    RemoveNode(iter->ht, bucket, NULL, keyvalue);
+    if (BucketEmpty(iter->ht, bucket)) {
+      HTIteratorSeek(iter, bucket + 1);
+    }
+    return true;
+  }
+
+  // Advance the iterator.  Thanks to the above call to
+  // HTIterator_Get, we know that this iterator is valid (though it
+  // may not be valid after this call to HTIterator_Next).
+  HTIterator_Next(iter);
+
+  // Lastly, remove the element.  The iterator has moved past it, so
+  // unlinking the node doesn't disturb the iterator.
+  RemoveNode(iter->ht, bucket, node, keyvalue);
+
+  return true;
+}
+
+// Copies an entry into table during a resize: into its bucket's first
+// slot if the bucket is still empty, and otherwise onto the tail of the
+// bucket's overflow chain.  Copying a table's entries in order thus keeps
+// each multimap run contiguous and newest first.  Returns false if we run
+// out of memory.
+static bool CopyEntry(HashTable *table, const HTEntry *entry) {
+  uint64_t hash = HTKeyHash(table, entry->kv.key);
+  int bucket = hash % table->num_buckets;
+  LLPayload_t payload;
+
+  if (BucketEmpty(table, bucket)) {
+    table->buckets[bucket].first = *entry;
+  } else {
+    if (table->flags & HT_FLAG_SET) {
+      payload = (LLPayload_t) (uintptr_t) entry->kv.key;
+    } else {
+      payload = HTAlloc(table, sizeof(HTEntry));
+      if (payload == NULL) {
+        return false;
+      }
+      *(HTEntry *) payload = *entry;
+    }
+    if (LinkOverflow(table, bucket, payload, NULL) == NULL) {
+      if (!(table->flags & HT_FLAG_SET)) {
+        HTRelease(table, payload, sizeof(HTEntry));
+      }
+      return false;
+    }
+  }
+  table->bucket_tags[bucket] |= HTHashTagBit(hash);
+  table->num_elements += 1;
+  return true;
+}
+
+// Implemented for you
+static void MaybeResize(HashTable *ht) {
+  HashTable *newht;
+  HashTable tmp;
+  bool ok = true;
+  int i;
+
+  // Resize if the load factor is > 3.
+  if (ht->num_elements < 3 * ht->num_buckets)
+    return;
+
+  // This is the resize case.  Allocate a new hashtable, copy the old
+  // hashtable's entries over, do the surgery on the old hashtable record
+  // and free up the new hashtable record.  The old table isn't touched
+  // until the copy is complete, so if we run out of memory along the way
+  // we throw the copy away and carry on at the old size.
+  newht = AllocateTable(ht->num_buckets * 9, ht->flags, ht->arena, ht->seed);
+  if (newht == NULL) {
+    return;
+  }
+
+  for (i = 0; ok && i < ht->num_buckets; i++) {
+    LinkedList *overflow = ht->buckets[i].overflow;
+    LinkedListNode *node;
+
+    if (BucketEmpty(ht, i)) {
+      continue;
+    }
+    ok = CopyEntry(newht, &ht->buckets[i].first);
+    for (node = overflow != NULL ? overflow->head : NULL;
+         ok && node != NULL; node = node->next) {
+      HTEntry entry = PayloadEntry(ht, node->payload);
+
+      ok = CopyEntry(newht, &entry);
+    }
+  }
+  if (!ok) {
+    FreeEntries(newht, NULL);
+    FreeBuckets(newht);
+    free(newht);
+    return;
+  }
+
+  // Buckets that are still too big get trees of their own.
+  for (i = 0; i < newht->num_buckets; i++) {
+    if (BucketSize(newht, i) > HT_TREEIFY_THRESHOLD) {
+      TreeifyBucket(newht, i);
+    }
+  }
+
+  // The timer wheel holds keys, not bucket positions, so it carries over.
+  newht->timers = ht->timers;
+  ht->timers = NULL;
 
-  // Swap the new table onto the old, then free the old table (tricky!).  We
-  // use the "no-op free" because we don't actually want to free the elements;
-  // they're owned by the new table.
+  // Swap the new table onto the old, then free the old table's entries
+  // and buckets (tricky!).  It shares our arena, so we free just those
+  // rather than calling HashTable_Free.
   tmp = *ht;
   *ht = *newht;
   *newht = tmp;
 
-  // Done!  Clean up our iterator and temporary table.
-  HTIterator_Free(it);
-  HashTable_Free(newht, &HTNoOpFree);
+  // Done!  Clean up our temporary table.
+  FreeEntries(newht, NULL);
+  FreeBuckets(newht);
+  free(newht);
 }
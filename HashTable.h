@@ -15,6 +15,8 @@
 #include <stdbool.h>    // for bool type (true, false)
 #include <stdint.h>     // for uint64_t, etc.
 
+#include "./Arena.h"    // for Arena
+
 ///////////////////////////////////////////////////////////////////////////////
 // A HashTable is a automatically-resizing chained hash table.
 //
@@ -67,6 +69,10 @@ typedef void(*ValueFreeFnPtr)(HTValue_t value);
 // - buffer: a pointer to a len-size buffer of unsigned chars.
 // - len: how many bytes are in the buffer.
 //
+// FNV is not keyed, so customers can easily find strings whose hashes
+// share low bits.  That's fine for a key: the table rehashes every key
+// under its own secret seed before choosing a bucket.
+//
 // Returns:
 // - a nicely distributed 64-bit hash value suitable for
 //   use in a HTKeyValue_t.
@@ -82,6 +88,59 @@ HTKey_t FNVHash64(unsigned char *buffer, int len);
 // Returns NULL on error, non-NULL on success.
 HashTable* HashTable_Allocate(int num_buckets);
 
+// Flags for HashTable_AllocateWithFlags; combine them with bitwise or.
+//
+// HT_FLAG_ARENA: the table's internal structures (entries, chains and
+//   bucket arrays) are carved out of a private Arena instead of malloc'd,
+//   so HashTable_Free releases them all with a handful of munmap calls.
+//   Customers may also allocate values from the table's arena (see
+//   HashTable_GetArena), in which case they pass a NULL value freeing
+//   function to HashTable_Free.
+//
+// HT_FLAG_MULTIMAP: the table may hold several entries with the same key.
+//   HashTable_Insert always adds a new entry (and returns false) rather
+//   than replacing an existing one.  Entries with the same key are kept
+//   next to each other in their chain, most recently inserted first, so
+//   HashTable_FindAll and HashTable_CountKey visit just that run.
+//   HashTable_Find, HashTable_Remove, HashTable_FindOrInsert and
+//   HashTable_Upsert act on the most recently inserted entry for the key.
+//
+// HT_FLAG_CUCKOO: the entries live in a CuckooHashTable (see
+//   CuckooHashTable.h) instead of in chains, so a lookup reads at most two
+//   cache lines however full the table is; num_buckets is taken as the
+//   expected number of entries.  Cuckoo tables don't support TTLs:
+//   HashTable_InsertWithTTL inserts the entry with no expiry.  This flag
+//   can't be combined with HT_FLAG_ARENA or HT_FLAG_MULTIMAP.
+//
+// HT_FLAG_HUGE_PAGES, HT_FLAG_HUGETLB, HT_FLAG_NUMA_INTERLEAVE,
+// HT_FLAG_NUMA_LOCAL: set the policy for the memory the table's buckets
+//   and entries live in; see the matching ARENA_POLICY_* in Arena.h.  Any
+//   of these implies HT_FLAG_ARENA.  They help tables too big for the TLB
+//   to cover with ordinary pages, and tables shared across sockets.
+#define HT_FLAG_ARENA           0x1
+#define HT_FLAG_MULTIMAP        0x2
+#define HT_FLAG_CUCKOO          0x4
+#define HT_FLAG_HUGE_PAGES      0x8
+#define HT_FLAG_HUGETLB         0x10
+#define HT_FLAG_NUMA_INTERLEAVE 0x20
+#define HT_FLAG_NUMA_LOCAL      0x40
+
+// Allocate and return a new HashTable with the given HT_FLAG_* options.
+// HashTable_Allocate(n) is the same as HashTable_AllocateWithFlags(n, 0).
+//
+// Arguments:
+// - num_buckets: the number of buckets the hash table should
+//   initially contain; MUST be greater than zero.
+// - flags: zero or more HT_FLAG_* values.
+//
+// Returns NULL on error, non-NULL on success.
+HashTable* HashTable_AllocateWithFlags(int num_buckets, int flags);
+
+// Returns the Arena that an HT_FLAG_ARENA table allocates from, or NULL
+// for other tables.  Memory the customer allocates from it lives until
+// the table is freed.
+Arena* HashTable_GetArena(HashTable *table);
+
 // Free a HashTable and its entries.
 //
 // Arguments:
@@ -89,7 +148,8 @@ HashTable* HashTable_Allocate(int num_buckets);
 //   after this function returns.
 //
 // - value_free_function:  this argument is a pointer to a value
-//   freeing function; see above for details.
+//   freeing function; see above for details.  It may be NULL if the
+//   values don't need freeing (eg, they live in the table's arena).
 void HashTable_Free(HashTable *table, ValueFreeFnPtr value_free_function);
 
 // Figure out the number of elements in the hash table.
@@ -103,6 +163,12 @@ void HashTable_Free(HashTable *table, ValueFreeFnPtr value_free_function);
 // - table size (>=0); note that this is an unsigned 64-bit integer.
 int HashTable_NumElements(HashTable *table);
 
+// Returns the number of entries in the table's longest chain (zero for an
+// HT_FLAG_CUCKOO table, which has no chains).  Keys are hashed under a
+// random per-table seed, so this stays small even when the keys were
+// chosen to collide; it's meant for monitoring and tests.
+int HashTable_LongestChain(HashTable *table);
+
 // Inserts a (key,value) pair into the HashTable.
 //
 // Arguments:
@@ -144,6 +210,61 @@ bool HashTable_Find(HashTable *table,
                     HTKey_t key,
                     HTKeyValue_t *keyvalue);
 
+// Looks up a key, adding it (with a NULL value) if it isn't present, and
+// returns a pointer to the value slot in the table.  The chain is walked
+// once, and nothing is allocated if the key is already present, so this
+// replaces a HashTable_Find followed by a HashTable_Insert.
+//
+// The returned pointer remains valid until the table is next modified
+// (a resize may move entries, to keep them in their buckets' cache
+// lines), and the caller may read and write the value through it.
+//
+// An entry whose TTL has passed, but which has not yet been removed, is
+// treated as absent, as HashTable_Find treats it: the entry is reused as
+// the key's new entry, with no TTL, and *inserted is set to true.  Its
+// expired value is left in the slot, and the caller takes ownership of it.
+// (The slot of a key that had no entry at all holds NULL.)
+//
+// Arguments:
+// - table: the HashTable to look in.
+// - key: the key to look up or add.
+// - inserted: a return parameter; set to true if the key was added (or
+//   its entry had expired), or to false if it was already present.
+//
+// Returns:
+// - a pointer to the key's value slot, or NULL on error (out of memory).
+HTValue_t* HashTable_FindOrInsert(HashTable *table,
+                                  HTKey_t key,
+                                  bool *inserted);
+
+// When upserting a key that is already present, customers pass a function
+// that combines the existing value with the new one.  The function returns
+// the value to keep, and is responsible for freeing whatever it discards.
+typedef HTValue_t(*HTMergeFnPtr)(HTValue_t oldvalue, HTValue_t newvalue);
+
+// Inserts a (key,value) pair, or, if the key is already present, replaces
+// its value with merge_function(old value, new value).  Like
+// HashTable_FindOrInsert, this walks the chain once and updates an existing
+// entry in place.  An entry whose TTL has passed counts as absent: it is
+// replaced by newkeyvalue, not merged with it.
+//
+// Arguments:
+// - table: the HashTable to upsert into.
+// - newkeyvalue: the (key,value) to insert or merge.
+// - merge_function: combines the old and new values; see above.
+// - expired_value: a return parameter; set to the value of an expired
+//   entry that newkeyvalue replaced, which the caller must now free, or
+//   to NULL.
+//
+// Returns:
+// - false: if the key was not present and newkeyvalue was inserted (or
+//   the insert failed for lack of memory).
+// - true: if the key was present and its value was merged.
+bool HashTable_Upsert(HashTable *table,
+                      HTKeyValue_t newkeyvalue,
+                      HTMergeFnPtr merge_function,
+                      HTValue_t *expired_value);
+
 // Removes a (key,value) from the HashTable and returns it to the
 // caller.
 //
@@ -166,6 +287,203 @@ bool HashTable_Remove(HashTable *table,
                       HTKey_t key,
                       HTKeyValue_t *keyvalue);
 
+// A cursor over every entry with a given key; see HashTable_FindAll.  It
+// lives wherever the caller declares it (typically on the stack), so
+// walking the entries never allocates.  Customers should treat its fields
+// as private.
+typedef struct {
+  HTKey_t  key;   // the key we are enumerating
+  void    *next;  // where to resume the walk, or NULL when done
+  int      kind;  // what next points at
+} HTKeyCursor;
+
+// Positions a cursor on the entries with the given key.  This is mostly
+// useful for HT_FLAG_MULTIMAP tables; in other tables a key has at most
+// one entry.
+//
+// The cursor is invalidated by any change to the table, so the caller
+// must finish with it before inserting or removing anything.
+//
+// Arguments:
+// - table: the HashTable to look in.
+// - key: the key to look up.
+// - cursor: the cursor to initialize.
+void HashTable_FindAll(HashTable *table, HTKey_t key, HTKeyCursor *cursor);
+
+// Returns the next (key,value) with the cursor's key, most recently
+// inserted first.  As with HashTable_Find, entries whose TTL has passed
+// are skipped, and the value is left in the table.
+//
+// Arguments:
+// - cursor: a cursor set up by HashTable_FindAll.
+// - keyvalue: a return parameter for the next (key,value).
+//
+// Returns:
+// - true if a (key,value) was returned, or false if there are no more.
+bool HTKeyCursor_Next(HTKeyCursor *cursor, HTKeyValue_t *keyvalue);
+
+// Counts the entries with the given key, stopping once limit have been
+// found.  Because a key's entries are contiguous, the count stops walking
+// at the end of the key's run, or earlier if the limit is reached; so
+// asking "does this key have at least n values?" costs O(n).
+//
+// Arguments:
+// - table: the HashTable to look in.
+// - key: the key to count.
+// - limit: the most entries to count, or 0 for no limit.
+//
+// Returns:
+// - the number of (unexpired) entries with the key, capped at limit.
+int HashTable_CountKey(HashTable *table, HTKey_t key, int limit);
+
+// Inserts a (key,value) pair that expires ttl_ms milliseconds from now.
+//
+// Once an entry has expired, HashTable_Find treats it as missing.  The
+// entry itself is removed (and its value freed) by a later call to
+// HashTable_ExpireEntries.  Until then it still counts towards
+// HashTable_NumElements, iterators still visit it, and HashTable_Insert
+// and HashTable_Remove still hand it back so that the caller can free its
+// value.  Re-inserting a key with HashTable_Insert clears its TTL.
+//
+// If memory for the entry's expiry timer can't be allocated, nothing is
+// inserted (an entry that could never be reaped would be worse), and
+// false is returned.
+//
+// Arguments and return values are as for HashTable_Insert, plus:
+// - ttl_ms: how long, in milliseconds, the entry should live.
+bool HashTable_InsertWithTTL(HashTable *table,
+                             HTKeyValue_t newkeyvalue,
+                             uint64_t ttl_ms,
+                             HTKeyValue_t *oldkeyvalue);
+
+// Removes entries whose TTL has passed.
+//
+// Expiry times are tracked in a hierarchical timer wheel, so the cost of
+// this call is proportional to the number of timers that have come due,
+// not to the size of the table.  Callers can bound the work done per call
+// with max_timers, and call this function periodically.
+//
+// Arguments:
+// - table: the HashTable to expire entries from.
+// - max_timers: the maximum number of expiry timers to process in this
+//   call, or 0 for no limit.  Timers left over are processed first on
+//   the next call.
+// - value_free_function: invoked once for the value of each entry removed,
+//   or NULL if the values don't need freeing.
+//
+// Returns:
+// - the number of entries removed.
+int HashTable_ExpireEntries(HashTable *table,
+                            int max_timers,
+                            ValueFreeFnPtr value_free_function);
+
+// A predicate over (key,value)s, for HashTable_RemoveIf: returns true if
+// the entry should be removed.  arg is passed through from the caller.
+typedef bool(*HTPredicateFnPtr)(const HTKeyValue_t *keyvalue, void *arg);
+
+// Removes every entry that satisfies a predicate, in a single pass over
+// the table.  Unlike removing through an HTIterator, which looks each key
+// up again, this unlinks entries where it finds them, and fixes up each
+// bucket's bookkeeping once rather than once per entry.  Removed values
+// are freed in batches, after their entries have been unlinked.
+//
+// Entries whose TTL has passed are removed too, without consulting the
+// predicate.
+//
+// Arguments:
+// - table: the HashTable to remove from.
+// - predicate_function: called once on each unexpired entry, in no
+//   particular order, with arg; see above.  It must not modify the table.
+// - arg: passed through to predicate_function.
+// - value_free_function: invoked once for the value of each entry
+//   removed, or NULL if the values don't need freeing.
+//
+// Returns:
+// - the number of entries removed.
+int HashTable_RemoveIf(HashTable *table,
+                       HTPredicateFnPtr predicate_function,
+                       void *arg,
+                       ValueFreeFnPtr value_free_function);
+
+// Copies every (key,value) in the table into a contiguous array, sorted by
+// ascending key.  Entries whose TTL has passed are left out.
+//
+// The copy is sorted with a radix sort on the 64-bit key, which takes a
+// fixed number of linear passes regardless of the key distribution.
+//
+// Arguments:
+// - table: the HashTable to snapshot.
+// - snapshot: a pointer to the output array.  If *snapshot is non-NULL,
+//   it must point to room for at least HashTable_NumElements(table)
+//   entries.  If *snapshot is NULL, the array is malloc'd, returned via
+//   *snapshot, and the caller is responsible for freeing it.
+// - num_threads: how many threads may be used to sort.  Small snapshots
+//   are always sorted on the calling thread.
+//
+// Returns:
+// - the number of entries written, or -1 on error (out of memory).
+//   The values are shared with the table, so the caller must not free
+//   them while they are still in the table.
+int HashTable_SortedSnapshot(HashTable *table,
+                             HTKeyValue_t **snapshot,
+                             int num_threads);
+
+// Join and set operations between two tables stream their results to a
+// customer-supplied function.  left and right point to (key,value)s from
+// the left and right tables respectively; one of them is NULL when the
+// operation reports a key that only one side has.  The (key,value)s are
+// copies that are only valid during the call, but the values are shared
+// with the tables.
+//
+// The function may be called concurrently from several threads, so it must
+// do its own locking if it touches shared state.
+typedef void(*HTJoinFnPtr)(const HTKeyValue_t *left,
+                           const HTKeyValue_t *right,
+                           void *arg);
+
+// Calls join_function(l, r, arg) for every pair of entries l in left and r
+// in right with the same key.  (If neither table is an HT_FLAG_MULTIMAP,
+// that's once per key the tables share.)
+//
+// Rather than probing right's chains for each entry of left, both tables
+// are copied out and radix-partitioned by hash into cache-sized pieces,
+// and the pieces are joined in parallel.  Entries whose TTL has passed are
+// left out.  Neither table may be modified during the call.
+//
+// Arguments:
+// - left, right: the tables to join.
+// - join_function: receives each result; see above.
+// - arg: passed through to join_function.
+// - num_threads: how many threads may be used.
+//
+// Returns:
+// - the number of calls made to join_function, or -1 on error (out of
+//   memory), in which case no calls were made.
+int64_t HashTable_Join(HashTable *left, HashTable *right,
+                       HTJoinFnPtr join_function, void *arg,
+                       int num_threads);
+
+// Like HashTable_Join, but calls join_function(l, r, arg) just once for
+// each entry l in left whose key is in right; r is one of the matching
+// entries.
+int64_t HashTable_Intersect(HashTable *left, HashTable *right,
+                            HTJoinFnPtr join_function, void *arg,
+                            int num_threads);
+
+// Like HashTable_Intersect, but also calls join_function(l, NULL, arg) for
+// each entry l in left whose key is not in right, and
+// join_function(NULL, r, arg) for each entry r in right whose key is not
+// in left.
+int64_t HashTable_Union(HashTable *left, HashTable *right,
+                        HTJoinFnPtr join_function, void *arg,
+                        int num_threads);
+
+// Like HashTable_Join, but calls join_function(l, NULL, arg) for each entry
+// l in left whose key is not in right.
+int64_t HashTable_Difference(HashTable *left, HashTable *right,
+                             HTJoinFnPtr join_function, void *arg,
+                             int num_threads);
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // HashTable iterator
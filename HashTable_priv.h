@@ -16,6 +16,8 @@
 
 #include "./LinkedList.h"
 #include "./HashTable.h"
+#include "./TimerWheel.h"
+#include "./CuckooHashTable.h"
 
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 // Internal structures and helper functions for our HashTable implementation.
@@ -29,25 +31,173 @@
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 
 
+// A single entry, as stored in a bucket's chain.
+//
+// The customer's (key,value) comes first, so a pointer to an entry can be
+// used wherever a pointer to an HTKeyValue_t is expected.
+typedef struct ht_entry {
+  HTKeyValue_t  kv;      // the customer's (key,value)
+  uint64_t      expiry;  // when the entry expires, in ms, or 0 for never
+} HTEntry;
+
+// A node in a bucket's search tree (see "struct ht" below).  Each distinct
+// key in a treeified overflow chain has one node, pointing at the first
+// chain node with that key.
+typedef struct ht_tree_node {
+  HTKey_t               key;
+  struct ll_node       *chain_node;  // first chain node with this key
+  struct ht_tree_node  *left;        // subtree of smaller keys
+  struct ht_tree_node  *right;       // subtree of larger keys
+  int                   height;      // AVL height; a leaf is 1
+} HTTreeNode;
+
+#define HT_TREEIFY_THRESHOLD 8    // treeify a bucket bigger than this...
+#define HT_UNTREEIFY_THRESHOLD 6  // ...and drop its tree below this
+
+// A bucket record: the bucket's first entry, held inline, and a pointer
+// to a list of the rest (its "overflow chain").  A record is 32 bytes, and
+// the bucket array is aligned to match, so no record straddles two cache
+// lines.  At our load factors most buckets hold at most one entry, so most
+// hits are done after reading the tag word (see below) and this record,
+// without following any pointers.
+//
+// A bucket's entries, in order, are first and then the overflow chain's.
+// first is occupied exactly when the bucket is nonempty: removing it moves
+// the overflow chain's head up into its place.  The overflow list is only
+// allocated once the bucket first needs it, and is kept once it has been.
+//
+// A HashSet keeps its first key in first.kv.key (with a NULL value and no
+// expiry), and its overflow payloads are the keys themselves.
+typedef struct ht_bucket {
+  HTEntry      first;     // the bucket's first entry, if it's nonempty
+  LinkedList  *overflow;  // the rest of the bucket's entries, or NULL
+} HTBucket;
+
+// An internal flag, alongside the public HT_FLAG_*s: the table is a
+// HashSet, whose chain payloads are the keys themselves rather than
+// pointers to HTEntry records.
+#define HT_FLAG_SET 0x10000
+
 // The hash table implementation.
 //
-// A hash table is an array of buckets, where each bucket is a linked list
-// of HTKeyValue structs.
+// A hash table is an array of buckets, each an HTBucket record (see
+// above) holding one entry inline and the rest in a linked list.
+//
+// Keys are hashed with SipHash-1-3 under a random per-table seed before
+// being mapped to a bucket, so a customer who controls the keys can't
+// predict which keys share a bucket, and so can't pile them all into one
+// chain.
+//
+// Alongside the buckets we keep a parallel array of 64-bit "tag words", one
+// per bucket.  Each key present in a bucket sets one bit (its fingerprint,
+// see HTHashTagBit) in that bucket's tag word, so a lookup whose bit is
+// clear can report a miss without touching the bucket at all.  The words
+// are dense, so a miss costs a single 8-byte read.  A bucket is empty
+// exactly when its tag word is zero.
+//
+// A bucket that grows past HT_TREEIFY_THRESHOLD entries (because of bad
+// luck, or keys that were chosen to collide) gets an AVL tree indexing its
+// overflow chain's nodes by key, so that lookups in it take O(log n) time.
+// The chain stays as it was, so iteration is unaffected; the tree is
+// dropped once the bucket is small again.  A treeified bucket's tag word
+// is all ones, so that removals needn't recompute it.
 typedef struct ht {
   int             num_buckets;   // # of buckets in this HT?
   int             num_elements;  // # of elements currently in this HT?
-  LinkedList    **buckets;       // the array of buckets
+  int             flags;         // HT_FLAG_* passed at allocation
+  Arena          *arena;         // where our structures live, or NULL
+  HTBucket       *buckets;       // the array of buckets
+  void           *bucket_mem;    // the allocation buckets is aligned within
+  uint64_t       *bucket_tags;   // per-bucket fingerprint bloom words
+  TimerWheel     *timers;        // expiry timers, or NULL if no TTLs yet
+  CuckooHashTable *cuckoo;       // holds the entries if HT_FLAG_CUCKOO
+  uint64_t        seed[2];       // SipHash key for this table's hashes
+  HTTreeNode    **bucket_trees;  // per-bucket trees, or NULL if none yet
 } HashTable;
 
+// A HashSet (see HashSet.h) wraps a HashTable with HT_FLAG_SET.  It is a
+// type of its own only so that a set can't be passed where a table is
+// expected, or the other way around.
+typedef struct hs {
+  HashTable      *table;         // the engine table, with HT_FLAG_SET
+} HashSet;
+
 // The hash table iterator.
 typedef struct ht_it {
   HashTable  *ht;          // the HT we're pointing into
   int         bucket_idx;  // which bucket are we in?
-  LLIterator *bucket_it;   // iterator for the bucket, or NULL
+  LLIterator *bucket_it;   // our overflow chain node; NULL node means
+                           // we're at the bucket's first entry
+  uint64_t    cuckoo_pos;  // our position in ht->cuckoo, if it has one
 } HTIterator;
 
 // This is the internal hash function we use to map from HTKey_t keys to a
 // bucket number.
 int HashKeyToBucketNum(HashTable *ht, HTKey_t key);
 
+// Fills seed with 128 random bits, for keying HTSipHash13.
+void HTRandomSeed(uint64_t seed[2]);
+
+// Mixes all 64 bits of a key into a well-distributed 64-bit value.  The
+// bucket number is taken from the low bits of the key, so anything that
+// wants bits that are independent of the bucket (eg, fingerprints) should
+// take them from the top of this mix instead.
+static inline uint64_t HTMix64(uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+#define HT_ROTL64(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+#define HT_SIPROUND(v0, v1, v2, v3)                               \
+  do {                                                            \
+    v0 += v1; v1 = HT_ROTL64(v1, 13); v1 ^= v0;                   \
+    v0 = HT_ROTL64(v0, 32);                                       \
+    v2 += v3; v3 = HT_ROTL64(v3, 16); v3 ^= v2;                   \
+    v0 += v3; v3 = HT_ROTL64(v3, 21); v3 ^= v0;                   \
+    v2 += v1; v1 = HT_ROTL64(v1, 17); v1 ^= v2;                   \
+    v2 = HT_ROTL64(v2, 32);                                       \
+  } while (0)
+
+// SipHash-1-3 of a single 64-bit word (as its 8 little-endian bytes),
+// keyed by seed.  Unlike HTMix64, this can't be inverted or steered
+// without knowing the seed.
+static inline uint64_t HTSipHash13(const uint64_t seed[2], uint64_t word) {
+  uint64_t v0 = seed[0] ^ 0x736f6d6570736575ULL;
+  uint64_t v1 = seed[1] ^ 0x646f72616e646f6dULL;
+  uint64_t v2 = seed[0] ^ 0x6c7967656e657261ULL;
+  uint64_t v3 = seed[1] ^ 0x7465646279746573ULL;
+  uint64_t last = 8ULL << 56;  // message length, and no leftover bytes
+
+  v3 ^= word;
+  HT_SIPROUND(v0, v1, v2, v3);
+  v0 ^= word;
+
+  v3 ^= last;
+  HT_SIPROUND(v0, v1, v2, v3);
+  v0 ^= last;
+
+  v2 ^= 0xff;
+  HT_SIPROUND(v0, v1, v2, v3);
+  HT_SIPROUND(v0, v1, v2, v3);
+  HT_SIPROUND(v0, v1, v2, v3);
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+// Returns the table's keyed hash of key.  The bucket number is the hash
+// modulo the number of buckets, and the fingerprint comes from its top
+// bits, so one hash serves both.
+static inline uint64_t HTKeyHash(HashTable *ht, HTKey_t key) {
+  return HTSipHash13(ht->seed, key);
+}
+
+// Returns the single bit that represents a key with the given HTKeyHash in
+// its bucket's tag word.
+static inline uint64_t HTHashTagBit(uint64_t hash) {
+  return 1ULL << (hash >> 58);
+}
+
 #endif  // HW0_HASHTABLE_PRIV_H_
@@ -0,0 +1,371 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "LRUCache.h"
+#include "LRUCache_priv.h"
+#include "HashTable_priv.h"  // for HTSipHash13, HTRandomSeed
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+//
+#define LRU_MIN_BUCKETS 16
+#define LRU_MIN_BLOCK   16
+
+// Maps a key to its bucket.  num_buckets is a power of two, so we can mask.
+// Without a per-cache seed, keys chosen to collide would all share a chain.
+static int LRUBucket(LRUCache *cache, HTKey_t key) {
+  return (int) (HTSipHash13(cache->seed, key) &
+                (uint64_t) (cache->num_buckets - 1));
+}
+
+// Finds the node holding key.  On return, *prevlink points at the link that
+// refers to the returned node (or at the NULL that ends the chain), so the
+// caller can unlink it without a second walk.
+static LRUNode* LRUFindNode(LRUCache *cache, HTKey_t key,
+                            LRUNode ***prevlink) {
+  LRUNode **link = &cache->buckets[LRUBucket(cache, key)];
+
+  while (*link != NULL && (*link)->kv.key != key) {
+    link = &(*link)->hnext;
+  }
+  *prevlink = link;
+  return *link;
+}
+
+// Unlinks a node from the recency list.
+static void LRUUnlinkRecency(LRUCache *cache, LRUNode *node) {
+  if (node->prev != NULL) {
+    node->prev->next = node->next;
+  } else {
+    cache->head = node->next;
+  }
+  if (node->next != NULL) {
+    node->next->prev = node->prev;
+  } else {
+    cache->tail = node->prev;
+  }
+}
+
+// Links a node in at the most recently used end of the recency list.
+static void LRUPushFront(LRUCache *cache, LRUNode *node) {
+  node->prev = NULL;
+  node->next = cache->head;
+  if (cache->head != NULL) {
+    cache->head->prev = node;
+  } else {
+    cache->tail = node;
+  }
+  cache->head = node;
+}
+
+// Removes a node from both its hash chain and the recency list, and puts
+// it back on the free list.  The caller has already copied out its kv.
+static void LRUReleaseNode(LRUCache *cache, LRUNode **prevlink,
+                           LRUNode *node) {
+  *prevlink = node->hnext;
+  LRUUnlinkRecency(cache, node);
+  cache->num_elements -= 1;
+  cache->num_bytes -= node->size;
+
+  node->hnext = cache->free_nodes;
+  cache->free_nodes = node;
+}
+
+// Returns a node from the free list, allocating a new block of nodes if
+// the free list is empty.  Blocks double in size, so allocation stops
+// quickly once the cache reaches its steady-state size.
+static LRUNode* LRUGetNode(LRUCache *cache) {
+  LRUNode *node;
+
+  if (cache->free_nodes == NULL) {
+    int count = cache->num_nodes < LRU_MIN_BLOCK ?
+                LRU_MIN_BLOCK : cache->num_nodes;
+    LRUBlock *block;
+    int i;
+
+    if (cache->max_entries > 0 &&
+        count > cache->max_entries - cache->num_nodes) {
+      count = cache->max_entries - cache->num_nodes;
+    }
+    if (count <= 0) {
+      count = 1;
+    }
+
+    block = (LRUBlock *) malloc(sizeof(LRUBlock) + count * sizeof(LRUNode));
+    if (block == NULL) {
+      return NULL;
+    }
+    block->next = cache->blocks;
+    cache->blocks = block;
+    cache->num_nodes += count;
+
+    node = (LRUNode *) (block + 1);
+    for (i = 0; i < count; i++) {
+      node[i].hnext = cache->free_nodes;
+      cache->free_nodes = &node[i];
+    }
+  }
+
+  node = cache->free_nodes;
+  cache->free_nodes = node->hnext;
+  return node;
+}
+
+// Doubles the bucket array of a cache that has no entry bound, once the
+// load factor passes 1.  Nodes are relinked, not copied.
+static void LRUMaybeResize(LRUCache *cache) {
+  LRUNode **newbuckets;
+  LRUNode  *node;
+  int       newsize;
+
+  if (cache->max_entries > 0 || cache->num_elements < cache->num_buckets)
+    return;
+
+  newsize = cache->num_buckets * 2;
+  newbuckets = (LRUNode **) calloc(newsize, sizeof(LRUNode *));
+  if (newbuckets == NULL) {
+    // We can keep going with longer chains.
+    return;
+  }
+
+  free(cache->buckets);
+  cache->buckets = newbuckets;
+  cache->num_buckets = newsize;
+  for (node = cache->head; node != NULL; node = node->next) {
+    int b = LRUBucket(cache, node->kv.key);
+    node->hnext = newbuckets[b];
+    newbuckets[b] = node;
+  }
+}
+
+// Evicts the least recently used entry.
+static void LRUEvictTail(LRUCache *cache) {
+  LRUNode *victim = cache->tail;
+  LRUNode **prevlink;
+  HTKeyValue_t kv = victim->kv;
+
+  LRUFindNode(cache, kv.key, &prevlink);
+  LRUReleaseNode(cache, prevlink, victim);
+  cache->stats.evictions += 1;
+  if (cache->evict_fn != NULL) {
+    cache->evict_fn(kv, cache->evict_arg);
+  }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// LRUCache implementation.
+
+LRUCache* LRUCache_Allocate(int max_entries, uint64_t max_bytes,
+                            LRUEvictFnPtr evict_function, void *evict_arg) {
+  LRUCache *cache;
+  int num_buckets = LRU_MIN_BUCKETS;
+
+  if (max_entries < 0 || max_entries > LRU_MAX_ENTRIES ||
+      (max_entries == 0 && max_bytes == 0)) {
+    return NULL;
+  }
+
+  cache = (LRUCache *) malloc(sizeof(LRUCache));
+  if (cache == NULL) {
+    return NULL;
+  }
+
+  // With an entry bound, size the bucket array once so that the load factor
+  // never exceeds 1; otherwise start small and grow.
+  while (num_buckets < max_entries) {
+    num_buckets *= 2;
+  }
+  cache->buckets = (LRUNode **) calloc(num_buckets, sizeof(LRUNode *));
+  if (cache->buckets == NULL) {
+    free(cache);
+    return NULL;
+  }
+
+  cache->num_buckets = num_buckets;
+  cache->num_elements = 0;
+  cache->max_entries = max_entries;
+  cache->num_bytes = 0;
+  cache->max_bytes = max_bytes;
+  cache->head = cache->tail = NULL;
+  cache->free_nodes = NULL;
+  cache->blocks = NULL;
+  cache->num_nodes = 0;
+  cache->evict_fn = evict_function;
+  cache->evict_arg = evict_arg;
+  cache->stats.hits = 0;
+  cache->stats.misses = 0;
+  cache->stats.insertions = 0;
+  cache->stats.evictions = 0;
+  HTRandomSeed(cache->seed);
+  return cache;
+}
+
+void LRUCache_Free(LRUCache *cache, ValueFreeFnPtr value_free_function) {
+  LRUNode *node;
+  LRUBlock *block;
+
+  if (value_free_function != NULL) {
+    for (node = cache->head; node != NULL; node = node->next) {
+      value_free_function(node->kv.value);
+    }
+  }
+
+  block = cache->blocks;
+  while (block != NULL) {
+    LRUBlock *next = block->next;
+    free(block);
+    block = next;
+  }
+  free(cache->buckets);
+  free(cache);
+}
+
+int LRUCache_NumElements(LRUCache *cache) {
+  return cache->num_elements;
+}
+
+uint64_t LRUCache_NumBytes(LRUCache *cache) {
+  return cache->num_bytes;
+}
+
+bool LRUCache_Get(LRUCache *cache, HTKey_t key, HTKeyValue_t *keyvalue) {
+  LRUNode **prevlink;
+  LRUNode *node = LRUFindNode(cache, key, &prevlink);
+
+  if (node == NULL) {
+    cache->stats.misses += 1;
+    return false;
+  }
+
+  cache->stats.hits += 1;
+  if (node != cache->head) {
+    LRUUnlinkRecency(cache, node);
+    LRUPushFront(cache, node);
+  }
+  *keyvalue = node->kv;
+  return true;
+}
+
+bool LRUCache_Peek(LRUCache *cache, HTKey_t key, HTKeyValue_t *keyvalue) {
+  LRUNode **prevlink;
+  LRUNode *node = LRUFindNode(cache, key, &prevlink);
+
+  if (node == NULL) {
+    return false;
+  }
+  *keyvalue = node->kv;
+  return true;
+}
+
+bool LRUCache_Put(LRUCache *cache, HTKeyValue_t newkeyvalue, uint64_t size,
+                  HTKeyValue_t *oldkeyvalue) {
+  LRUNode **prevlink;
+  LRUNode *node = LRUFindNode(cache, newkeyvalue.key, &prevlink);
+  bool replaced = false;
+
+  if (cache->max_bytes > 0 && size > cache->max_bytes) {
+    // This entry can never fit, so it is evicted on arrival.  An entry it
+    // would have replaced goes back to the caller, as for any replacement,
+    // and nothing else is disturbed.
+    if (node != NULL) {
+      *oldkeyvalue = node->kv;
+      LRUReleaseNode(cache, prevlink, node);
+      replaced = true;
+    }
+    cache->stats.evictions += 1;
+    if (cache->evict_fn != NULL) {
+      cache->evict_fn(newkeyvalue, cache->evict_arg);
+    }
+    return replaced;
+  }
+
+  if (node != NULL) {
+    // Replace in place: the node keeps its chain position, and moves to
+    // the front of the recency list.
+    *oldkeyvalue = node->kv;
+    node->kv = newkeyvalue;
+    cache->num_bytes -= node->size;
+    node->size = size;
+    cache->num_bytes += size;
+    if (node != cache->head) {
+      LRUUnlinkRecency(cache, node);
+      LRUPushFront(cache, node);
+    }
+    replaced = true;
+  } else {
+    // Make room for one more entry before we grab a node, so that a full
+    // cache recycles the victim's node rather than allocating.
+    if (cache->max_entries > 0 && cache->num_elements >= cache->max_entries) {
+      LRUEvictTail(cache);
+    }
+
+    node = LRUGetNode(cache);
+    if (node == NULL) {
+      return false;
+    }
+    node->kv = newkeyvalue;
+    node->size = size;
+
+    LRUMaybeResize(cache);
+    prevlink = &cache->buckets[LRUBucket(cache, newkeyvalue.key)];
+    node->hnext = *prevlink;
+    *prevlink = node;
+    LRUPushFront(cache, node);
+    cache->num_elements += 1;
+    cache->num_bytes += size;
+    cache->stats.insertions += 1;
+  }
+
+  // Trim the byte budget from the cold end.  The new entry is at the head
+  // and fits on its own, so this never evicts it.
+  while (cache->max_bytes > 0 && cache->num_bytes > cache->max_bytes) {
+    LRUEvictTail(cache);
+  }
+  return replaced;
+}
+
+bool LRUCache_Remove(LRUCache *cache, HTKey_t key, HTKeyValue_t *keyvalue) {
+  LRUNode **prevlink;
+  LRUNode *node = LRUFindNode(cache, key, &prevlink);
+
+  if (node == NULL) {
+    return false;
+  }
+  *keyvalue = node->kv;
+  LRUReleaseNode(cache, prevlink, node);
+  return true;
+}
+
+bool LRUCache_EvictOne(LRUCache *cache) {
+  if (cache->tail == NULL) {
+    return false;
+  }
+  LRUEvictTail(cache);
+  return true;
+}
+
+void LRUCache_GetStats(LRUCache *cache, LRUStats *stats) {
+  *stats = cache->stats;
+}
+
+double LRUCache_HitRate(LRUCache *cache) {
+  uint64_t lookups = cache->stats.hits + cache->stats.misses;
+
+  if (lookups == 0) {
+    return 0.0;
+  }
+  return (double) cache->stats.hits / (double) lookups;
+}
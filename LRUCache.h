@@ -0,0 +1,150 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_LRUCACHE_H_
+#define HW0_LRUCACHE_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stdint.h>     // for uint64_t, etc.
+
+#include "./HashTable.h"  // for HTKey_t, HTValue_t, HTKeyValue_t
+
+///////////////////////////////////////////////////////////////////////////////
+// An LRUCache is a bounded (key,value) map that evicts its least recently
+// used entry when it runs out of room.
+//
+// Keys and values use the same types as HashTable: the caller hashes the key
+// into an HTKey_t, and the value is an opaque HTValue_t.  The cache can be
+// bounded by a number of entries, by a byte budget (where the caller tells us
+// how many bytes each entry is worth), or both.
+//
+// Each entry is a single node that lives in a hash chain and in the recency
+// list at the same time, so Get, Put and eviction are all O(1).  Nodes are
+// recycled through an internal free list; once the cache has filled up,
+// none of the operations below call malloc or free.
+//
+// As with HashTable, we declare the "struct lru" structure here but
+// *define* it in the internal header LRUCache_priv.h.
+typedef struct lru LRUCache;
+
+// When an entry is evicted to make room, the cache hands the (key,value) to
+// an eviction function supplied by the customer, along with the opaque
+// argument passed to LRUCache_Allocate.  The customer assumes ownership of
+// the evicted value.
+typedef void(*LRUEvictFnPtr)(HTKeyValue_t evicted, void *arg);
+
+// Counters describing the cache's behavior since it was allocated.
+typedef struct {
+  uint64_t hits;        // # of LRUCache_Get calls that found their key
+  uint64_t misses;      // # of LRUCache_Get calls that didn't
+  uint64_t insertions;  // # of LRUCache_Put calls that added a new key
+  uint64_t evictions;   // # of entries handed to the eviction function
+} LRUStats;
+
+// The largest entry bound a cache may have.
+#define LRU_MAX_ENTRIES (1 << 30)
+
+// Allocate and return a new LRUCache.
+//
+// Arguments:
+// - max_entries: the maximum number of entries the cache may hold, or 0
+//   if the number of entries is unbounded.  It may be no more than
+//   LRU_MAX_ENTRIES.
+// - max_bytes: the maximum total size (as reported to LRUCache_Put) of
+//   the entries in the cache, or 0 if the size is unbounded.  At least
+//   one of max_entries and max_bytes MUST be non-zero.
+// - evict_function: invoked once for each entry evicted to make room.
+//   May be NULL, in which case evicted values are simply dropped.
+// - evict_arg: passed through to evict_function.
+//
+// Returns NULL on error, non-NULL on success.
+LRUCache* LRUCache_Allocate(int max_entries, uint64_t max_bytes,
+                            LRUEvictFnPtr evict_function, void *evict_arg);
+
+// Free an LRUCache and its entries.
+//
+// Arguments:
+// - cache: the LRUCache to free.  It is unsafe to use cache after this
+//   function returns.
+// - value_free_function: invoked once for each value still in the cache,
+//   or NULL if the values don't need freeing.  Note that this is not the
+//   eviction function.
+void LRUCache_Free(LRUCache *cache, ValueFreeFnPtr value_free_function);
+
+// Returns the number of entries currently in the cache.
+int LRUCache_NumElements(LRUCache *cache);
+
+// Returns the total size of the entries currently in the cache.
+uint64_t LRUCache_NumBytes(LRUCache *cache);
+
+// Looks up a key, and if it is present, marks it as the most recently
+// used entry and returns a copy of its (key,value).
+//
+// Arguments:
+// - cache: the LRUCache to look in.
+// - key: the key to look up.
+// - keyvalue: if the key is present, a copy of the (key,value) is returned
+//   through this return parameter.  The (key,value) stays in the cache.
+//
+// Returns:
+// - false: if the key wasn't found (this counts as a miss).
+// - true: if the key was found (this counts as a hit).
+bool LRUCache_Get(LRUCache *cache, HTKey_t key, HTKeyValue_t *keyvalue);
+
+// Same as LRUCache_Get, but neither changes the recency order nor
+// updates the hit/miss counters.
+bool LRUCache_Peek(LRUCache *cache, HTKey_t key, HTKeyValue_t *keyvalue);
+
+// Inserts a (key,value) as the most recently used entry, evicting least
+// recently used entries until the new one fits.
+//
+// An entry that is bigger than max_bytes on its own can never fit; it is
+// handed straight to the eviction function instead of being inserted.  If
+// its key was already present, the old entry is still removed and
+// returned through oldkeyvalue, and no other entry is evicted.
+//
+// Arguments:
+// - cache: the LRUCache to insert into.
+// - newkeyvalue: the (key,value) to insert.
+// - size: how many bytes this entry counts for against max_bytes.
+// - oldkeyvalue: if the key was already present, its old (key,value) is
+//   replaced and returned through this return parameter, and the caller
+//   assumes ownership of oldkeyvalue->value.
+//
+// Returns:
+// - false: if there was no existing entry with that key.
+// - true: if an existing entry was replaced and returned via oldkeyvalue.
+bool LRUCache_Put(LRUCache *cache, HTKeyValue_t newkeyvalue, uint64_t size,
+                  HTKeyValue_t *oldkeyvalue);
+
+// Removes a key from the cache and returns its (key,value) to the caller,
+// who assumes ownership of keyvalue->value.
+//
+// Returns:
+// - false: if the key wasn't found.
+// - true: if the key was found and removed.
+bool LRUCache_Remove(LRUCache *cache, HTKey_t key, HTKeyValue_t *keyvalue);
+
+// Evicts the least recently used entry, handing it to the eviction
+// function.
+//
+// Returns:
+// - false: if the cache is empty.
+// - true: if an entry was evicted.
+bool LRUCache_EvictOne(LRUCache *cache);
+
+// Copies the cache's counters into the stats return parameter.
+void LRUCache_GetStats(LRUCache *cache, LRUStats *stats);
+
+// Returns hits / (hits + misses), or 0 if there have been no lookups.
+double LRUCache_HitRate(LRUCache *cache);
+
+#endif  // HW0_LRUCACHE_H_
@@ -0,0 +1,68 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_LRUCACHE_PRIV_H_
+#define HW0_LRUCACHE_PRIV_H_
+
+#include <stdint.h>  // for uint64_t, etc.
+
+#include "./LRUCache.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our LRUCache implementation.
+//
+// These would typically be located in LRUCache.c; however, we have broken
+// them out into a "private .h" so that our unittests can access them.
+//
+// Customers should not include this file or assume anything based on
+// its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// A single cache entry.
+//
+// The node is intrusive: it is linked into its bucket's hash chain through
+// hnext, and into the recency list through prev/next, so there is no
+// separate allocation for either structure.  Free nodes are kept on a
+// singly-linked free list threaded through hnext.
+typedef struct lru_node {
+  HTKeyValue_t     kv;     // the customer's (key,value)
+  uint64_t         size;   // bytes this entry counts against max_bytes
+  struct lru_node *hnext;  // next node in the hash chain (or free list)
+  struct lru_node *prev;   // more recently used neighbor, or NULL
+  struct lru_node *next;   // less recently used neighbor, or NULL
+} LRUNode;
+
+// A block of nodes carved up by the cache.  Blocks are chained together so
+// that LRUCache_Free can release them; the nodes follow the header.
+typedef struct lru_block {
+  struct lru_block *next;  // next block, or NULL
+} LRUBlock;
+
+// The cache itself.
+typedef struct lru {
+  int            num_buckets;   // always a power of two
+  int            num_elements;  // # entries currently in the cache
+  int            max_entries;   // entry bound, or 0 for unbounded
+  uint64_t       num_bytes;     // sum of the sizes of the current entries
+  uint64_t       max_bytes;     // byte bound, or 0 for unbounded
+  LRUNode      **buckets;       // the hash chains
+  LRUNode       *head;          // most recently used entry, or NULL
+  LRUNode       *tail;          // least recently used entry, or NULL
+  LRUNode       *free_nodes;    // recycled nodes, chained through hnext
+  LRUBlock      *blocks;        // every block of nodes we've allocated
+  int            num_nodes;     // # nodes across all blocks
+  LRUEvictFnPtr  evict_fn;      // customer's eviction function, or NULL
+  void          *evict_arg;     // argument for evict_fn
+  LRUStats       stats;         // hit/miss/eviction counters
+  uint64_t       seed[2];       // SipHash key for choosing buckets
+} LRUCache;
+
+#endif  // HW0_LRUCACHE_PRIV_H_
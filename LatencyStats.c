@@ -0,0 +1,218 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // for clock_gettime, nanosleep
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "LatencyStats.h"
+#include "LatencyStats_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+atomic_bool latency_enabled = false;
+
+// This thread's histograms, allocated the first time it records a call.
+static _Thread_local LatencyBlock *my_block = NULL;
+
+// Every thread's histograms.
+static pthread_mutex_t blocks_lock = PTHREAD_MUTEX_INITIALIZER;
+static LatencyBlock *all_blocks = NULL;
+
+// How many nanoseconds a tick of LatencyTicks is worth.
+static double ns_per_tick = 1.0;
+static pthread_once_t calibrate_once = PTHREAD_ONCE_INIT;
+
+static const char *kOpNames[LAT_NUM_OPS] = {
+  "HashTable_Insert",
+  "HashTable_Insert (resize)",
+  "HashTable_Find",
+  "HashTable_Remove",
+  "LinkedList_Push",
+  "LinkedList_Pop",
+  "LinkedList_Append",
+  "LinkedList_Slice",
+};
+
+// Measures the cycle counter against the monotonic clock.
+static void Calibrate(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  struct timespec t0, t1, pause = { 0, 10 * 1000 * 1000 };
+  uint64_t c0, c1;
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  c0 = LatencyTicks();
+  nanosleep(&pause, NULL);
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  c1 = LatencyTicks();
+  if (c1 > c0) {
+    ns_per_tick = ((t1.tv_sec - t0.tv_sec) * 1e9 +
+                   (t1.tv_nsec - t0.tv_nsec)) / (double) (c1 - c0);
+  }
+#endif
+}
+
+// Gives the calling thread its own histograms.  Returns false if we're out
+// of memory, in which case the call goes unrecorded.
+static bool RegisterThread(void) {
+  LatencyBlock *block = (LatencyBlock *) calloc(1, sizeof(LatencyBlock));
+
+  if (block == NULL) {
+    return false;
+  }
+  pthread_mutex_lock(&blocks_lock);
+  block->next = all_blocks;
+  all_blocks = block;
+  pthread_mutex_unlock(&blocks_lock);
+  my_block = block;
+  return true;
+}
+
+int LatencyBucket(uint64_t value) {
+  int msb;
+
+  if (value < LAT_SUB_BUCKETS) {
+    return (int) value;
+  }
+  msb = 63 - __builtin_clzll(value);
+  return (msb - LAT_SUB_BUCKET_BITS + 1) * LAT_SUB_BUCKETS +
+         (int) ((value >> (msb - LAT_SUB_BUCKET_BITS)) &
+                (LAT_SUB_BUCKETS - 1));
+}
+
+uint64_t LatencyBucketLow(int bucket) {
+  if (bucket < LAT_SUB_BUCKETS) {
+    return bucket;
+  }
+  return (uint64_t) (LAT_SUB_BUCKETS + bucket % LAT_SUB_BUCKETS)
+         << (bucket / LAT_SUB_BUCKETS - 1);
+}
+
+void LatencyRecordSlow(LatencyOp op, uint64_t start) {
+  uint64_t ticks = LatencyTicks() - start;
+  LatencyHistogram *hist;
+  int bucket;
+
+  if (my_block == NULL && !RegisterThread()) {
+    return;
+  }
+
+  // We're the only writer, so a load and a store will do; no need for an
+  // atomic read-modify-write.
+  hist = &my_block->ops[op];
+  bucket = LatencyBucket(ticks);
+  atomic_store_explicit(&hist->buckets[bucket],
+                        atomic_load_explicit(&hist->buckets[bucket],
+                                             memory_order_relaxed) + 1,
+                        memory_order_relaxed);
+  if (ticks > atomic_load_explicit(&hist->max, memory_order_relaxed)) {
+    atomic_store_explicit(&hist->max, ticks, memory_order_relaxed);
+  }
+}
+
+// Returns the value at quantile q of a merged histogram with total counts,
+// in ticks: the middle of the bucket that the quantile falls in, but no
+// more than the largest value recorded.
+static double Quantile(const uint64_t *counts, uint64_t total, double q,
+                       uint64_t max) {
+  uint64_t rank = (uint64_t) (q * total + 0.5), seen = 0;
+  int b;
+
+  if (rank < 1) rank = 1;
+  for (b = 0; b < LAT_NUM_BUCKETS; b++) {
+    seen += counts[b];
+    if (seen >= rank) {
+      double low = (double) LatencyBucketLow(b);
+      double high = (b + 1 < LAT_NUM_BUCKETS) ?
+                    (double) LatencyBucketLow(b + 1) : low;
+      double mid = low + (high - low - 1) / 2;
+
+      return (mid < (double) max) ? mid : (double) max;
+    }
+  }
+  return (double) max;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// LatencyStats implementation.
+
+void LatencyStats_Enable(bool enable) {
+  atomic_store(&latency_enabled, enable);
+}
+
+bool LatencyStats_IsEnabled(void) {
+  return atomic_load(&latency_enabled);
+}
+
+void LatencyStats_Reset(void) {
+  LatencyBlock *block;
+  int op, b;
+
+  pthread_mutex_lock(&blocks_lock);
+  for (block = all_blocks; block != NULL; block = block->next) {
+    for (op = 0; op < LAT_NUM_OPS; op++) {
+      for (b = 0; b < LAT_NUM_BUCKETS; b++) {
+        atomic_store_explicit(&block->ops[op].buckets[b], 0,
+                              memory_order_relaxed);
+      }
+      atomic_store_explicit(&block->ops[op].max, 0, memory_order_relaxed);
+    }
+  }
+  pthread_mutex_unlock(&blocks_lock);
+}
+
+void LatencyStats_Summarize(LatencyOp op, LatencySummary *summary) {
+  uint64_t counts[LAT_NUM_BUCKETS];
+  uint64_t total = 0, max = 0;
+  LatencyBlock *block;
+  int b;
+
+  pthread_once(&calibrate_once, &Calibrate);
+  memset(counts, 0, sizeof(counts));
+
+  pthread_mutex_lock(&blocks_lock);
+  for (block = all_blocks; block != NULL; block = block->next) {
+    LatencyHistogram *hist = &block->ops[op];
+    uint64_t block_max = atomic_load_explicit(&hist->max,
+                                              memory_order_relaxed);
+
+    for (b = 0; b < LAT_NUM_BUCKETS; b++) {
+      counts[b] += atomic_load_explicit(&hist->buckets[b],
+                                        memory_order_relaxed);
+    }
+    if (block_max > max) max = block_max;
+  }
+  pthread_mutex_unlock(&blocks_lock);
+
+  memset(summary, 0, sizeof(LatencySummary));
+  for (b = 0; b < LAT_NUM_BUCKETS; b++) {
+    total += counts[b];
+  }
+  if (total == 0) {
+    return;
+  }
+  summary->count = total;
+  summary->p50 = Quantile(counts, total, 0.50, max) * ns_per_tick;
+  summary->p99 = Quantile(counts, total, 0.99, max) * ns_per_tick;
+  summary->p999 = Quantile(counts, total, 0.999, max) * ns_per_tick;
+  summary->max = max * ns_per_tick;
+}
+
+const char* LatencyStats_OpName(LatencyOp op) {
+  return (op >= 0 && op < LAT_NUM_OPS) ? kOpNames[op] : "?";
+}
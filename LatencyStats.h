@@ -0,0 +1,77 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_LATENCYSTATS_H_
+#define HW0_LATENCYSTATS_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stdint.h>     // for uint64_t, etc.
+
+///////////////////////////////////////////////////////////////////////////////
+// LatencyStats is an opt-in instrumentation layer that records how long
+// individual HashTable and LinkedList calls take.
+//
+// Averages hide the occasional slow call (a resize, or a long chain), so
+// each operation gets a histogram of latencies instead.  The histograms are
+// log-linear, in the style of HdrHistogram: each power of two is split
+// into 16 sub-buckets, so any reported value is within about 6% of the
+// true one, at a fixed 8KB per operation.
+//
+// Timing uses the CPU's cycle counter where there is one.  Each thread
+// records into its own set of histograms, so recording never contends;
+// the sets are merged when statistics are read.
+//
+// Recording is off by default.  While it is off, an instrumented call pays
+// only for checking a flag.
+typedef enum {
+  LAT_HT_INSERT = 0,     // HashTable_Insert calls that didn't resize
+  LAT_HT_INSERT_RESIZE,  // HashTable_Insert calls that resized the table
+  LAT_HT_FIND,           // HashTable_Find
+  LAT_HT_REMOVE,         // HashTable_Remove
+  LAT_LL_PUSH,           // LinkedList_Push
+  LAT_LL_POP,            // LinkedList_Pop
+  LAT_LL_APPEND,         // LinkedList_Append
+  LAT_LL_SLICE,          // LinkedList_Slice
+  LAT_NUM_OPS
+} LatencyOp;
+
+// A summary of one operation's latencies, in nanoseconds.
+typedef struct {
+  uint64_t count;    // # of calls recorded
+  double   p50;      // median
+  double   p99;      // 99th percentile
+  double   p999;     // 99.9th percentile
+  double   max;      // slowest call
+} LatencySummary;
+
+// Turns recording on or off for every thread.
+void LatencyStats_Enable(bool enable);
+
+// Returns true if recording is on.
+bool LatencyStats_IsEnabled(void);
+
+// Discards everything recorded so far.  Calls that are in flight on other
+// threads may still be recorded afterwards.
+void LatencyStats_Reset(void);
+
+// Merges every thread's histogram for op and summarizes it.  Calls that
+// are in flight on other threads may or may not be included.
+//
+// Arguments:
+// - op: the operation to summarize.
+// - summary: a return parameter for the summary.  If nothing has been
+//   recorded, the count and all of the latencies are zero.
+void LatencyStats_Summarize(LatencyOp op, LatencySummary *summary);
+
+// Returns a short name for op, for printing (eg, "HashTable_Find").
+const char* LatencyStats_OpName(LatencyOp op);
+
+#endif  // HW0_LATENCYSTATS_H_
@@ -0,0 +1,97 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_LATENCYSTATS_PRIV_H_
+#define HW0_LATENCYSTATS_PRIV_H_
+
+#include <stdint.h>     // for uint64_t, etc.
+#include <stdatomic.h>  // for atomic_bool, etc.
+#include <time.h>       // for timespec_get
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>  // for __rdtsc
+#endif
+
+#include "./LatencyStats.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our LatencyStats
+// implementation.
+//
+// These would typically be located in LatencyStats.c; however, we have
+// broken them out into a "private .h" so that our unittests (and the
+// instrumented modules) can access them.
+//
+// Customers should not include this file or assume anything based on
+// its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// Histogram layout.  Values below LAT_SUB_BUCKETS get a bucket each; above
+// that, each power of two gets LAT_SUB_BUCKETS buckets.
+#define LAT_SUB_BUCKET_BITS 4
+#define LAT_SUB_BUCKETS (1 << LAT_SUB_BUCKET_BITS)
+#define LAT_NUM_BUCKETS ((64 - LAT_SUB_BUCKET_BITS + 1) * LAT_SUB_BUCKETS)
+
+// One thread's histogram for one operation.  Only the owning thread writes
+// it; readers merging histograms use relaxed atomic loads, and so may see
+// a call's count before its max (or vice versa).
+typedef struct {
+  _Atomic uint64_t buckets[LAT_NUM_BUCKETS];
+  _Atomic uint64_t max;  // slowest call, in ticks
+} LatencyHistogram;
+
+// One thread's histograms.  The blocks are linked together so that
+// readers can find them all, and are never freed, so a thread's numbers
+// survive it.
+typedef struct lat_block {
+  LatencyHistogram  ops[LAT_NUM_OPS];
+  struct lat_block *next;
+} LatencyBlock;
+
+// Set by LatencyStats_Enable.
+extern atomic_bool latency_enabled;
+
+// Returns the current value of the cycle counter (or, without one, of a
+// nanosecond clock).
+static inline uint64_t LatencyTicks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+
+  timespec_get(&ts, TIME_UTC);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+// Instrumented functions call LatencyStart on entry and LatencyRecord on
+// exit.  LatencyStart returns 0 if recording is off, in which case
+// LatencyRecord does nothing.
+static inline uint64_t LatencyStart(void) {
+  if (!atomic_load_explicit(&latency_enabled, memory_order_relaxed)) {
+    return 0;
+  }
+  return LatencyTicks();
+}
+
+void LatencyRecordSlow(LatencyOp op, uint64_t start);
+
+static inline void LatencyRecord(LatencyOp op, uint64_t start) {
+  if (start != 0) {
+    LatencyRecordSlow(op, start);
+  }
+}
+
+// Returns the histogram bucket for a value, and the smallest value that
+// falls in a bucket.
+int LatencyBucket(uint64_t value);
+uint64_t LatencyBucketLow(int bucket);
+
+#endif  // HW0_LATENCYSTATS_PRIV_H_
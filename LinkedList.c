@@ -14,6 +14,226 @@
 
 #include "LinkedList.h"
 #include "LinkedList_priv.h"
+#include "LatencyStats_priv.h"
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+// Allocates a node for the given list, from its arena if it has one.
+static LinkedListNode* NewNode(LinkedList *list) {
+  if (list->arena != NULL) {
+    return (LinkedListNode *) Arena_Alloc(list->arena, sizeof(LinkedListNode));
+  }
+  return (LinkedListNode *) malloc(sizeof(LinkedListNode));
+}
+
+// Frees a node that belonged to the given list.
+static void FreeNode(LinkedList *list, LinkedListNode *node) {
+  if (list->arena != NULL) {
+    Arena_Release(list->arena, node, sizeof(LinkedListNode));
+  } else {
+    free(node);
+  }
+}
+
+// Ring lists start with this many slots.
+#define LL_RING_MIN_CAPACITY 8
+
+// Returns the slot holding element i of a ring list.
+static inline LLPayload_t* RingSlot(LinkedList *list, int i) {
+  return &list->ring[(list->ring_start + i) & (list->ring_capacity - 1)];
+}
+
+// Moves a ring list's elements into a new array with the given number of
+// slots, starting at slot 0.  Returns false if we're out of memory.
+static bool RingResize(LinkedList *list, int capacity) {
+  LLPayload_t *ring;
+  int i;
+
+  ring = (LLPayload_t *) malloc(capacity * sizeof(LLPayload_t));
+  if (ring == NULL) {
+    return false;
+  }
+  for (i = 0; i < list->num_elements; i++) {
+    ring[i] = *RingSlot(list, i);
+  }
+  free(list->ring);
+  list->ring = ring;
+  list->ring_capacity = capacity;
+  list->ring_start = 0;
+  return true;
+}
+
+// Makes room for n more elements in a ring list, doubling its array as
+// many times as that takes.  Returns false if we're out of memory.
+static bool RingReserve(LinkedList *list, int n) {
+  int capacity = list->ring_capacity;
+
+  while (capacity < list->num_elements + n) {
+    capacity *= 2;
+  }
+  if (capacity == list->ring_capacity) {
+    return true;
+  }
+  return RingResize(list, capacity);
+}
+
+// Inserts a payload so that it becomes element i of a ring list, shifting
+// whichever side of i is shorter.
+static bool RingInsertAt(LinkedList *list, int i, LLPayload_t payload) {
+  int n = list->num_elements, k;
+
+  if (!RingReserve(list, 1)) {
+    return false;
+  }
+  if (i < n - i) {
+    list->ring_start = (list->ring_start - 1) & (list->ring_capacity - 1);
+    for (k = 0; k < i; k++) {
+      *RingSlot(list, k) = *RingSlot(list, k + 1);
+    }
+  } else {
+    for (k = n; k > i; k--) {
+      *RingSlot(list, k) = *RingSlot(list, k - 1);
+    }
+  }
+  *RingSlot(list, i) = payload;
+  list->num_elements += 1;
+  return true;
+}
+
+// Removes element i of a ring list, shifting whichever side of it is
+// shorter, and returns its payload.
+static LLPayload_t RingRemoveAt(LinkedList *list, int i) {
+  LLPayload_t payload = *RingSlot(list, i);
+  int n = list->num_elements, k;
+
+  if (i < n - 1 - i) {
+    for (k = i; k > 0; k--) {
+      *RingSlot(list, k) = *RingSlot(list, k - 1);
+    }
+    list->ring_start = (list->ring_start + 1) & (list->ring_capacity - 1);
+  } else {
+    for (k = i; k < n - 1; k++) {
+      *RingSlot(list, k) = *RingSlot(list, k + 1);
+    }
+  }
+  list->num_elements -= 1;
+  return payload;
+}
+
+// Returns true if nodes can be relinked from src into dst: both lists
+// keep nodes (rather than a ring) and get them from the same allocator.
+static bool CanRelinkNodes(LinkedList *dst, LinkedList *src) {
+  return dst->ring == NULL && src->ring == NULL && dst->arena == src->arena;
+}
+
+// Allocates an empty list of the same kind as list: a ring if list is
+// one, and otherwise a node-based list using the same allocator.
+static LinkedList* AllocateLike(LinkedList *list) {
+  if (list->ring != NULL) {
+    return LinkedList_AllocateRing();
+  }
+  if (list->arena != NULL) {
+    return LinkedList_AllocateInArena(list->arena);
+  }
+  return LinkedList_Allocate();
+}
+
+// Readies src's elements to be moved into dst when src's nodes can't
+// simply be relinked there, so that the move itself can't fail.  If dst
+// is a ring, we make room in it for src's elements and return src.
+// Otherwise we copy src's elements into a new list whose nodes can be
+// relinked into dst, empty src, and return the new list, which the caller
+// then frees.  Returns NULL if we're out of memory, with src unchanged.
+static LinkedList* StageForMove(LinkedList *dst, LinkedList *src) {
+  LinkedList *staged;
+  LinkedListNode *node;
+  LLPayload_t payload;
+  int i;
+
+  if (dst->ring != NULL) {
+    return RingReserve(dst, src->num_elements) ? src : NULL;
+  }
+
+  staged = AllocateLike(dst);
+  if (staged == NULL) {
+    return NULL;
+  }
+  for (i = 0, node = src->head; i < src->num_elements; i++) {
+    if (src->ring != NULL) {
+      payload = *RingSlot(src, i);
+    } else {
+      payload = node->payload;
+      node = node->next;
+    }
+    if (!LinkedList_Append(staged, payload)) {
+      while (LinkedList_Pop(staged, &payload)) { }
+      LinkedList_Free(staged, NULL);
+      return NULL;
+    }
+  }
+  while (LinkedList_Pop(src, &payload)) { }
+  return staged;
+}
+
+// Sorts a ring list's elements with a bottom-up merge sort.  If we can't
+// get scratch space, we fall back on an insertion sort.
+static void RingSort(LinkedList *list, int sign,
+                     LLPayloadComparatorFnPtr comparator_function) {
+  int n = list->num_elements, width, i;
+  LLPayload_t *src, *dst, *tmp;
+
+  // Rotate the elements to the front of the array first, so that the
+  // sort works on plain indices.
+  if (list->ring_start != 0 && !RingResize(list, list->ring_capacity)) {
+    return;  // out of memory
+  }
+
+  src = list->ring;
+  tmp = (LLPayload_t *) malloc(n * sizeof(LLPayload_t));
+  if (tmp == NULL) {
+    for (i = 1; i < n; i++) {
+      LLPayload_t p = src[i];
+      int j = i;
+      while (j > 0 && sign * comparator_function(src[j - 1], p) > 0) {
+        src[j] = src[j - 1];
+        j--;
+      }
+      src[j] = p;
+    }
+    return;
+  }
+
+  dst = tmp;
+  for (width = 1; width < n; width *= 2) {
+    for (i = 0; i < n; i += 2 * width) {
+      int lo = i, mid = i + width, hi = i + 2 * width, a, b, k;
+
+      if (mid > n) mid = n;
+      if (hi > n) hi = n;
+      for (a = lo, b = mid, k = lo; k < hi; k++) {
+        if (a < mid && (b >= hi ||
+                        sign * comparator_function(src[a], src[b]) <= 0)) {
+          dst[k] = src[a++];
+        } else {
+          dst[k] = src[b++];
+        }
+      }
+    }
+    tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+  if (src != list->ring) {
+    for (i = 0; i < n; i++) {
+      list->ring[i] = src[i];
+    }
+    free(src);
+  } else {
+    free(dst);
+  }
+}
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -29,6 +249,41 @@ LinkedList* LinkedList_Allocate(void) {
   ll->num_elements = 0;
   ll->head = NULL;
   ll->tail = NULL;
+  ll->arena = NULL;
+  ll->ring = NULL;
+  ll->ring_capacity = 0;
+  ll->ring_start = 0;
+
+  return ll;
+}
+
+LinkedList* LinkedList_AllocateRing(void) {
+  LinkedList *ll = LinkedList_Allocate();
+
+  if (ll == NULL) return NULL;
+
+  ll->ring = (LLPayload_t *) malloc(LL_RING_MIN_CAPACITY *
+                                    sizeof(LLPayload_t));
+  if (ll->ring == NULL) {
+    free(ll);
+    return NULL;
+  }
+  ll->ring_capacity = LL_RING_MIN_CAPACITY;
+  return ll;
+}
+
+LinkedList* LinkedList_AllocateInArena(Arena *arena) {
+  LinkedList *ll = (LinkedList *) Arena_Alloc(arena, sizeof(LinkedList));
+
+  if (ll == NULL) return NULL;
+
+  ll->num_elements = 0;
+  ll->head = NULL;
+  ll->tail = NULL;
+  ll->arena = arena;
+  ll->ring = NULL;
+  ll->ring_capacity = 0;
+  ll->ring_start = 0;
 
   return ll;
 }
@@ -40,24 +295,53 @@ void LinkedList_Free(LinkedList *list,
   // (using the payload_free_function supplied as an argument) and
   // the nodes themselves. 
 
+  if (list->ring != NULL) {
+    int i;
+
+    for (i = 0; i < list->num_elements; i++) {
+      payload_free_function(*RingSlot(list, i));
+    }
+    free(list->ring);
+    free(list);
+    return;
+  }
+
   // free the LinkedList
   while(list -> head != NULL){
     payload_free_function(list -> head -> payload);
     LinkedListNode* temp = list->head;
     list->head = list->head->next;
-    free(temp);
+    FreeNode(list, temp);
 
   }
-  free(list);
+  if (list->arena != NULL) {
+    Arena_Release(list->arena, list, sizeof(LinkedList));
+  } else {
+    free(list);
+  }
 }
 
 int LinkedList_NumElements(LinkedList *list) {
   return list->num_elements;
 }
 
-void LinkedList_Push(LinkedList *list, LLPayload_t payload) {
+bool LinkedList_Push(LinkedList *list, LLPayload_t payload) {
   // TODO: implement LinkedList_Push
-  LinkedListNode* ln = malloc(sizeof(LinkedListNode));
+  uint64_t start = LatencyStart();
+  bool ok;
+
+  if (list->ring != NULL) {
+    ok = RingInsertAt(list, 0, payload);
+    LatencyRecord(LAT_LL_PUSH, start);
+    return ok;
+  }
+
+  LinkedListNode* ln = NewNode(list);
+  if (ln == NULL) {
+    // failure of malloc
+    LatencyRecord(LAT_LL_PUSH, start);
+    return false;
+  }
 
   ln->payload = payload;
 
@@ -73,6 +357,8 @@ void LinkedList_Push(LinkedList *list, LLPayload_t payload) {
       list->num_elements += 1;
   }
 
+  LatencyRecord(LAT_LL_PUSH, start);
+  return true;
 }
 
 bool LinkedList_Pop(LinkedList *list, LLPayload_t *payload_ptr) {
@@ -83,9 +369,19 @@ bool LinkedList_Pop(LinkedList *list, LLPayload_t *payload_ptr) {
   // Be sure to call free() to deallocate the memory that was
   // previously allocated by LinkedList_Push().
    
+  uint64_t start = LatencyStart();
+
   // if nothing 
-  if (list->num_elements == 0)
+  if (list->num_elements == 0) {
+    LatencyRecord(LAT_LL_POP, start);
     return false;
+  }
+
+  if (list->ring != NULL) {
+    *payload_ptr = RingRemoveAt(list, 0);
+    LatencyRecord(LAT_LL_POP, start);
+    return true;
+  }
 
   // make a copy of pl
   *payload_ptr = list->head->payload;
@@ -103,20 +399,31 @@ bool LinkedList_Pop(LinkedList *list, LLPayload_t *payload_ptr) {
   }
 
   list->num_elements -= 1;
-  free(temp);
+  FreeNode(list, temp);
+  LatencyRecord(LAT_LL_POP, start);
 
   //success
   return true;  // you may need to change this return value
 }
 
-void LinkedList_Append(LinkedList *list, LLPayload_t payload) {
+bool LinkedList_Append(LinkedList *list, LLPayload_t payload) {
   // TODO: implement LinkedList_Append.  It's kind of like
   // LinkedList_Push, but obviously you need to add to the end
   // instead of the beginning.
-  LinkedListNode* ln = malloc(sizeof(LinkedListNode));
+  uint64_t start = LatencyStart();
+  bool ok;
+
+  if (list->ring != NULL) {
+    ok = RingInsertAt(list, list->num_elements, payload);
+    LatencyRecord(LAT_LL_APPEND, start);
+    return ok;
+  }
+
+  LinkedListNode* ln = NewNode(list);
   if (ln == NULL) {
     // failure of malloc
-    return ;
+    LatencyRecord(LAT_LL_APPEND, start);
+    return false;
   }
 
   // set the payload
@@ -138,13 +445,25 @@ void LinkedList_Append(LinkedList *list, LLPayload_t payload) {
 
   }
 
+  LatencyRecord(LAT_LL_APPEND, start);
+  return true;
 }
 
 bool LinkedList_Slice(LinkedList *list, LLPayload_t *payload_ptr) {
   // TODO: implement LinkedList_Slice.
+  uint64_t start = LatencyStart();
+
   // list is empty
-  if (list->num_elements == 0)
+  if (list->num_elements == 0) {
+    LatencyRecord(LAT_LL_SLICE, start);
     return false;
+  }
+
+  if (list->ring != NULL) {
+    *payload_ptr = RingRemoveAt(list, list->num_elements - 1);
+    LatencyRecord(LAT_LL_SLICE, start);
+    return true;
+  }
 
   // make a copy of payload
   *payload_ptr = list->tail->payload;
@@ -162,7 +481,8 @@ bool LinkedList_Slice(LinkedList *list, LLPayload_t *payload_ptr) {
 
   list->num_elements -= 1;
  
-  free(temp);
+  FreeNode(list, temp);
+  LatencyRecord(LAT_LL_SLICE, start);
 
   
   return true;
@@ -170,6 +490,166 @@ bool LinkedList_Slice(LinkedList *list, LLPayload_t *payload_ptr) {
 }
 
 
+bool LinkedList_AppendArray(LinkedList *list,
+                            const LLPayload_t *payloads,
+                            int num_payloads) {
+  LinkedListNode *nodes = NULL, *first = NULL, *last = NULL;
+  int i;
+
+  if (num_payloads <= 0) {
+    return true;
+  }
+
+  if (list->ring != NULL) {
+    if (!RingReserve(list, num_payloads)) {
+      return false;
+    }
+    for (i = 0; i < num_payloads; i++) {
+      *RingSlot(list, list->num_elements + i) = payloads[i];
+    }
+    list->num_elements += num_payloads;
+    return true;
+  }
+
+  // Build the new nodes into a chain of their own, then link the chain
+  // onto the tail.  An arena hands out the nodes as one block; the arena
+  // can still take them back one at a time.
+  if (list->arena != NULL) {
+    nodes = (LinkedListNode *) Arena_Alloc(list->arena,
+                                           num_payloads *
+                                           sizeof(LinkedListNode));
+    if (nodes == NULL) {
+      return false;
+    }
+  }
+  for (i = 0; i < num_payloads; i++) {
+    LinkedListNode *ln = (nodes != NULL) ? &nodes[i] : NewNode(list);
+
+    if (ln == NULL) {
+      // Give back what we've built so far.
+      while (first != NULL) {
+        LinkedListNode *next = first->next;
+        FreeNode(list, first);
+        first = next;
+      }
+      return false;
+    }
+    ln->payload = payloads[i];
+    ln->next = NULL;
+    ln->prev = last;
+    if (last != NULL) {
+      last->next = ln;
+    } else {
+      first = ln;
+    }
+    last = ln;
+  }
+
+  if (list->tail != NULL) {
+    list->tail->next = first;
+    first->prev = list->tail;
+  } else {
+    list->head = first;
+  }
+  list->tail = last;
+  list->num_elements += num_payloads;
+  return true;
+}
+
+bool LinkedList_Concat(LinkedList *dst, LinkedList *src) {
+  LinkedList *staged;
+  LLPayload_t payload;
+
+  if (src->num_elements == 0) {
+    return true;
+  }
+
+  if (!CanRelinkNodes(dst, src)) {
+    staged = StageForMove(dst, src);
+    if (staged == NULL) {
+      return false;
+    }
+    if (staged == src) {
+      // dst is a ring with room for everything, so these can't fail.
+      while (LinkedList_Pop(src, &payload)) {
+        LinkedList_Append(dst, payload);
+      }
+    } else {
+      LinkedList_Concat(dst, staged);
+      LinkedList_Free(staged, NULL);
+    }
+    return true;
+  }
+
+  if (dst->tail != NULL) {
+    dst->tail->next = src->head;
+    src->head->prev = dst->tail;
+  } else {
+    dst->head = src->head;
+  }
+  dst->tail = src->tail;
+  dst->num_elements += src->num_elements;
+
+  src->head = src->tail = NULL;
+  src->num_elements = 0;
+  return true;
+}
+
+LinkedList* LinkedList_SplitAt(LinkedList *list, int k) {
+  LinkedList *rest;
+  LinkedListNode *node;
+  int n = list->num_elements, i;
+
+  if (k < 0) k = 0;
+  if (k > n) k = n;
+
+  rest = AllocateLike(list);
+  if (rest == NULL) {
+    return NULL;
+  }
+  if (k == n) {
+    return rest;
+  }
+
+  if (list->ring != NULL) {
+    if (!RingReserve(rest, n - k)) {
+      LinkedList_Free(rest, NULL);
+      return NULL;
+    }
+    for (i = k; i < n; i++) {
+      rest->ring[i - k] = *RingSlot(list, i);
+    }
+    rest->num_elements = n - k;
+    list->num_elements = k;
+    return rest;
+  }
+
+  // Find the first node that moves, walking in from the nearer end.
+  if (k <= n - k) {
+    for (node = list->head, i = 0; i < k; i++) {
+      node = node->next;
+    }
+  } else {
+    for (node = list->tail, i = n - 1; i > k; i--) {
+      node = node->prev;
+    }
+  }
+
+  rest->head = node;
+  rest->tail = list->tail;
+  rest->num_elements = n - k;
+
+  list->tail = node->prev;
+  if (list->tail != NULL) {
+    list->tail->next = NULL;
+  } else {
+    list->head = NULL;
+  }
+  list->num_elements = k;
+  node->prev = NULL;
+  return rest;
+}
+
 // this function is completed for you
 void LinkedList_Sort(LinkedList *list, bool ascending,
                      LLPayloadComparatorFnPtr comparator_function) {
@@ -178,6 +658,11 @@ void LinkedList_Sort(LinkedList *list, bool ascending,
     return;
   }
 
+  if (list->ring != NULL) {
+    RingSort(list, ascending ? 1 : -1, comparator_function);
+    return;
+  }
+
   // We'll implement bubblesort! Nnice and easy, and nice and slow :)
   int swapped;
   do {
@@ -204,6 +689,56 @@ void LinkedList_Sort(LinkedList *list, bool ascending,
   } while (swapped);
 }
 
+int LinkedList_RemoveIf(LinkedList *list,
+                        LLPayloadPredicateFnPtr predicate_function,
+                        void *arg,
+                        LLPayloadFreeFnPtr payload_free_function) {
+  LinkedListNode *node, *next;
+  int removed = 0;
+
+  if (list->ring != NULL) {
+    // Slide the survivors down over the removed elements; slot w is
+    // always one we've already read.
+    int i, w = 0;
+
+    for (i = 0; i < list->num_elements; i++) {
+      LLPayload_t payload = *RingSlot(list, i);
+
+      if (predicate_function(payload, arg)) {
+        payload_free_function(payload);
+      } else {
+        *RingSlot(list, w++) = payload;
+      }
+    }
+    removed = list->num_elements - w;
+    list->num_elements = w;
+    return removed;
+  }
+
+  for (node = list->head; node != NULL; node = next) {
+    next = node->next;
+    if (!predicate_function(node->payload, arg)) {
+      continue;
+    }
+
+    if (node->prev != NULL) {
+      node->prev->next = next;
+    } else {
+      list->head = next;
+    }
+    if (next != NULL) {
+      next->prev = node->prev;
+    } else {
+      list->tail = node->prev;
+    }
+    payload_free_function(node->payload);
+    FreeNode(list, node);
+    removed++;
+  }
+  list->num_elements -= removed;
+  return removed;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // LLIterator implementation.
@@ -220,6 +755,7 @@ LLIterator* LLIterator_Allocate(LinkedList *list) {
   // set up the iterator.
   li->list = list;
   li->node = list->head;
+  li->index = 0;
   
   return li;
  
@@ -233,6 +769,10 @@ void LLIterator_Free(LLIterator *iter) {
 bool LLIterator_IsValid(LLIterator *iter) {
   // TODO: implement
 
+  if (iter->list->ring != NULL) {
+    return iter->index >= 0 && iter->index < iter->list->num_elements;
+  }
+
   if (iter->node == NULL) return false;  // no
 
   return true;  // yes
@@ -242,6 +782,11 @@ bool LLIterator_IsValid(LLIterator *iter) {
 bool LLIterator_Next(LLIterator *iter) {
   // TODO: try to advance iterator to the next node and return true if
   // you succeed and are now on a new node, false otherwise
+
+  if (iter->list->ring != NULL) {
+    iter->index += 1;
+    return LLIterator_IsValid(iter);
+  }
     
   iter->node = iter->node->next;
 
@@ -255,6 +800,12 @@ bool LLIterator_Next(LLIterator *iter) {
 
 void LLIterator_Get(LLIterator *iter, LLPayload_t *payload) {
   // TODO: implement
+  if (iter->list->ring != NULL) {
+    if (LLIterator_IsValid(iter)) {
+      *payload = *RingSlot(iter->list, iter->index);
+    }
+    return;
+  }
   if (LLIterator_IsValid(iter)) {
       *payload = iter->node->payload;
   }
@@ -276,6 +827,16 @@ bool LLIterator_Remove(LLIterator *iter,
   // the iterator is pointing to, and also free any LinkedList
   // data structure element as appropriate.
 
+  if (iter->list->ring != NULL) {
+    // The elements after the removed one shift into its place (or the
+    // ones before it shift over), so the same index names the successor.
+    payload_free_function(RingRemoveAt(iter->list, iter->index));
+    if (iter->index == iter->list->num_elements) {
+      iter->index -= 1;
+    }
+    return iter->list->num_elements > 0;
+  }
+
   // free the current  payload
   payload_free_function(iter->node->payload);
   // pointcurrent node
@@ -288,7 +849,7 @@ bool LLIterator_Remove(LLIterator *iter,
     iter->list->tail = NULL;
 
     // free the node
-    free(temp);
+    FreeNode(iter->list, temp);
     //the list is empty
     return false;
   }
@@ -313,13 +874,102 @@ bool LLIterator_Remove(LLIterator *iter,
   }
 
   // free the node
-  free(temp);
+  FreeNode(iter->list, temp);
 
   return true;  // you may need to change this return value
 }
 
 
+bool LLIterator_Insert(LLIterator *iter, LLPayload_t payload) {
+  LinkedList *list = iter->list;
+  LinkedListNode* ln;
+
+  if (list->ring != NULL) {
+    // Past the end is any index >= num_elements.
+    int i = iter->index < list->num_elements ? iter->index :
+                                               list->num_elements;
+    if (!RingInsertAt(list, i, payload)) return false;
+    iter->index += 1;  // our element moved up one
+    return true;
+  }
+
+  ln = NewNode(list);
+  if (ln == NULL) return false;
+  ln->payload = payload;
+
+  if (iter->node == NULL) {
+    // Past the end: link the node in at the tail.
+    ln->next = NULL;
+    ln->prev = list->tail;
+    if (list->tail != NULL) {
+      list->tail->next = ln;
+    } else {
+      list->head = ln;
+    }
+    list->tail = ln;
+  } else {
+    // Link the node in between iter->node and its predecessor.
+    ln->next = iter->node;
+    ln->prev = iter->node->prev;
+    if (ln->prev != NULL) {
+      ln->prev->next = ln;
+    } else {
+      list->head = ln;
+    }
+    iter->node->prev = ln;
+  }
+
+  list->num_elements += 1;
+  return true;
+}
+
+bool LinkedList_SpliceAt(LLIterator *iter, LinkedList *src) {
+  LinkedList *list = iter->list, *staged;
+  LLPayload_t payload;
+
+  if (src->num_elements == 0) {
+    return true;
+  }
+
+  if (!CanRelinkNodes(list, src)) {
+    staged = StageForMove(list, src);
+    if (staged == NULL) {
+      return false;
+    }
+    if (staged == src) {
+      // list is a ring with room for everything, so these can't fail.
+      while (LinkedList_Pop(src, &payload)) {
+        LLIterator_Insert(iter, payload);
+      }
+    } else {
+      LinkedList_SpliceAt(iter, staged);
+      LinkedList_Free(staged, NULL);
+    }
+    return true;
+  }
+
+  if (iter->node == NULL) {
+    return LinkedList_Concat(list, src);
+  }
+
+  // Link src's chain in between iter->node and its predecessor.
+  src->head->prev = iter->node->prev;
+  if (iter->node->prev != NULL) {
+    iter->node->prev->next = src->head;
+  } else {
+    list->head = src->head;
+  }
+  src->tail->next = iter->node;
+  iter->node->prev = src->tail;
+  list->num_elements += src->num_elements;
+
+  src->head = src->tail = NULL;
+  src->num_elements = 0;
+  return true;
+}
+
 // Implemented for you
 void LLIterator_Rewind(LLIterator *iter) {
   iter->node = iter->list->head;
+  iter->index = 0;
 }
@@ -15,6 +15,7 @@
 #include <stdbool.h>    // for bool type (true, false)
 #include <stdint.h>     // for uint64_t, etc.
 
+#include "./Arena.h"    // for Arena
 
 ///////////////////////////////////////////////////////////////////////////////
 // A LinkedList is a doubly-linked list.
@@ -55,6 +56,33 @@ typedef void(*LLPayloadFreeFnPtr)(LLPayload_t payload);
 // - the newly-allocated linked list or NULL on error.
 LinkedList* LinkedList_Allocate(void);
 
+// Allocate and return a new linked list whose record and nodes are carved
+// out of an Arena rather than malloc'd.  Nodes that the list frees are
+// handed back to the arena for reuse.  The list must still be freed with
+// LinkedList_Free, unless the whole arena is being freed, in which case
+// the list goes with it.
+//
+// Arguments:
+// - arena: the Arena to allocate from.
+//
+// Returns:
+// - the newly-allocated linked list or NULL on error.
+LinkedList* LinkedList_AllocateInArena(Arena *arena);
+
+// Allocate and return a new list that keeps its payloads in a growable
+// circular array instead of in nodes.  It supports the whole LinkedList
+// API, but is much cheaper for queue and stack traffic (Push, Pop, Append
+// and Slice never allocate, except when the array doubles), and iterating
+// over it walks contiguous memory.  In exchange, LLIterator_Remove and
+// LLIterator_Insert in the middle of the list shift up to half of the
+// elements.
+//
+// Arguments: none.
+//
+// Returns:
+// - the newly-allocated list or NULL on error.
+LinkedList* LinkedList_AllocateRing(void);
+
 // Free a linked list that was previously allocated by LinkedList_Allocate.
 //
 // Arguments:
@@ -80,7 +108,13 @@ int LinkedList_NumElements(LinkedList *list);
 // - list: the LinkedList to push onto.
 // - payload: the payload to push; it's up to the caller to interpret and
 //   manage the memory of the payload.
-void LinkedList_Push(LinkedList *list, LLPayload_t payload);
+//
+// Returns:
+// - false if memory couldn't be allocated (for a new node, or to grow a
+//   ring list's array), in which case the list is unchanged and the
+//   payload still belongs to the caller.
+// - true on success.
+bool LinkedList_Push(LinkedList *list, LLPayload_t payload);
 
 // Pop an element from the head of the linked list.
 //
@@ -102,7 +136,11 @@ bool LinkedList_Pop(LinkedList *list, LLPayload_t *payload_ptr);
 // - list: the LinkedList to push onto.
 // - payload: the payload to push; it's up to the caller to interpret and
 //   manage the memory of the payload.
-void LinkedList_Append(LinkedList *list, LLPayload_t payload);
+//
+// Returns:
+// - false if memory couldn't be allocated, as for LinkedList_Push.
+// - true on success.
+bool LinkedList_Append(LinkedList *list, LLPayload_t payload);
 
 // Remove an element from the tail of the linked list.
 //
@@ -119,6 +157,59 @@ void LinkedList_Append(LinkedList *list, LLPayload_t payload);
 // - true: on success.
 bool LinkedList_Slice(LinkedList *list, LLPayload_t *payload_ptr);
 
+// Appends an array of payloads to the tail of the linked list, in order.
+//
+// The nodes are allocated up front, and in an arena-backed list they come
+// from a single arena allocation.  In a ring list, the array grows at most
+// once and the payloads are copied straight in.
+//
+// Arguments:
+// - list: the LinkedList to append to.
+// - payloads: the payloads to append.
+// - num_payloads: how many payloads there are.
+//
+// Returns:
+// - false if memory couldn't be allocated, in which case the list is
+//   unchanged.
+// - true on success.
+bool LinkedList_AppendArray(LinkedList *list,
+                            const LLPayload_t *payloads,
+                            int num_payloads);
+
+// Moves every element of src onto the tail of dst, leaving src empty (but
+// still allocated).
+//
+// When both are node-based lists that allocate from the same place (both
+// from malloc, or both from the same arena), the nodes are relinked rather
+// than copied, so this takes O(1) time.  Otherwise the elements are moved
+// one at a time.
+//
+// Arguments:
+// - dst: the list to append to.
+// - src: the list to empty; it must not be dst.
+//
+// Returns:
+// - false if memory couldn't be allocated to move the elements, in which
+//   case both lists are unchanged.  (Relinking never fails.)
+// - true on success.
+bool LinkedList_Concat(LinkedList *dst, LinkedList *src);
+
+// Splits a linked list in two.  The first k elements stay in list, and the
+// rest are moved, in order, into a new list (which allocates from the
+// same place as list, and which the caller must eventually free).
+//
+// In a node-based list, the split point is found by walking in from
+// whichever end is nearer, and the nodes are relinked rather than copied.
+//
+// Arguments:
+// - list: the list to split.
+// - k: how many elements to keep in list; it is clamped to [0, length].
+//
+// Returns:
+// - the new list, or NULL on error (out of memory), in which case list is
+//   unchanged.
+LinkedList* LinkedList_SplitAt(LinkedList *list, int k);
+
 
 // When sorting a linked list or comparing two elements of a linked list,
 // customers must pass in a comparator function.  The function accepts two
@@ -139,6 +230,28 @@ typedef int(*LLPayloadComparatorFnPtr)(LLPayload_t payload_a,
 void LinkedList_Sort(LinkedList *list, bool ascending,
                      LLPayloadComparatorFnPtr comparator_function);
 
+// A predicate over payloads, for LinkedList_RemoveIf: returns true if the
+// payload should be removed.  arg is passed through from the caller.
+typedef bool(*LLPayloadPredicateFnPtr)(LLPayload_t payload, void *arg);
+
+// Removes every element whose payload satisfies a predicate, in a single
+// pass over the list that unlinks the nodes in place.  The survivors keep
+// their order.
+//
+// Arguments:
+// - list: the list to remove from.
+// - predicate_function: called once on each payload, in order, with arg;
+//   see above.  It must not modify the list.
+// - arg: passed through to predicate_function.
+// - payload_free_function: invoked on each removed payload.
+//
+// Returns:
+// - the number of elements removed.
+int LinkedList_RemoveIf(LinkedList *list,
+                        LLPayloadPredicateFnPtr predicate_function,
+                        void *arg,
+                        LLPayloadFreeFnPtr payload_free_function);
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Linked list iterator.
@@ -226,6 +339,35 @@ void LLIterator_Get(LLIterator *iter, LLPayload_t *payload);
 bool LLIterator_Remove(LLIterator *iter,
                        LLPayloadFreeFnPtr payload_free_function);
 
+// Insert a new node holding payload just before the node the iterator is
+// pointing to.  If the iterator is "past the end" (eg, the list is empty),
+// the node is appended to the tail of the list instead.  Either way, the
+// iterator keeps pointing at the same place.
+//
+// Arguments:
+// - iter: the iterator to insert at.
+// - payload: the payload for the new node.
+//
+// Returns:
+// - false if memory for the node couldn't be allocated.
+// - true on success.
+bool LLIterator_Insert(LLIterator *iter, LLPayload_t payload);
+
+// Moves every element of src into the iterator's list, just before the
+// node the iterator is pointing to (or at the tail, if the iterator is
+// "past the end").  src is left empty, and the iterator keeps pointing at
+// the same place.  As with LinkedList_Concat, this is O(1) when both lists
+// are node-based and allocate from the same place.
+//
+// Arguments:
+// - iter: the iterator to splice at.
+// - src: the list to empty; it must not be the iterator's list.
+//
+// Returns:
+// - false if memory couldn't be allocated, as for LinkedList_Concat.
+// - true on success.
+bool LinkedList_SpliceAt(LLIterator *iter, LinkedList *src);
+
 // Rewind an iterator to the front of its list.
 //
 // Arguments:
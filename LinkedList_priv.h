@@ -13,6 +13,7 @@
 #define HW0_LINKEDLIST_PRIV_H_
 
 #include "./LinkedList.h"  // for LinkedList and LLIterator
+#include "./Arena.h"       // for Arena
 
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 // Internal structures and helper functions for our LinkedList implementation.
@@ -41,10 +42,21 @@ typedef struct ll_node {
 // We provided a struct declaration (but not definition) in LinkedList.h;
 // this is the associated definition.  This struct contains metadata
 // about the linked list.
+//
+// A list allocated with LinkedList_AllocateInArena takes its nodes (and
+// this record) from the arena; otherwise they come from malloc.
+//
+// A list allocated with LinkedList_AllocateRing has no nodes at all: its
+// payloads live in a circular array, with element i in slot
+// (ring_start + i) % ring_capacity, and head and tail are always NULL.
 typedef struct ll {
   int               num_elements;  //  # elements in the list
   LinkedListNode   *head;  // head of linked list, or NULL if empty
   LinkedListNode   *tail;  // tail of linked list, or NULL if empty
+  Arena            *arena;  // where nodes come from, or NULL for malloc
+  LLPayload_t      *ring;           // ring buffer, or NULL for nodes
+  int               ring_capacity;  // # slots in ring; a power of two
+  int               ring_start;     // slot holding the first element
 } LinkedList;
 
 // A linked list iterator.
@@ -52,8 +64,9 @@ typedef struct ll {
 // We expose the struct declaration in LinkedList.h, but not the definition,
 // similar to what we did above for the linked list itself.
 typedef struct ll_iter {
-  LinkedList       *list;  // the list we're for
-  LinkedListNode   *node;  // the node we are at, or NULL if broken
+  LinkedList       *list;   // the list we're for
+  LinkedListNode   *node;   // the node we are at, or NULL if broken
+  int               index;  // ring lists: the element we are at
 } LLIterator;
 
 
@@ -0,0 +1,507 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "PersistentHashTable.h"
+#include "PersistentHashTable_priv.h"
+#include "HashTable_priv.h"  // for HTSipHash13, HTRandomSeed
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+//
+// Functions that build nodes return NULL if memory runs out, having
+// released whatever they built along the way, so that a failed update
+// leaves the table as it was.
+
+// Returns key's hash in table.
+static inline uint64_t KeyHash(PersistentHashTable *table, HTKey_t key) {
+  return HTSipHash13(table->seed, key);
+}
+
+// Returns the bit for hash's fragment at the level for shift.
+static inline uint32_t FragmentBit(uint64_t hash, int shift) {
+  return 1u << ((hash >> shift) & (PHT_FANOUT - 1));
+}
+
+// Returns the index, among the slots marked in map, of the slot for bit.
+static inline int SlotIndex(uint32_t map, uint32_t bit) {
+  return __builtin_popcount(map & (bit - 1));
+}
+
+// Returns the number of entries in a node at the level for shift.
+static inline int NumEntries(const PHTNode *node, int shift) {
+  if (shift >= PHT_HASH_BITS) {
+    return (int) node->datamap;
+  }
+  return __builtin_popcount(node->datamap);
+}
+
+// Returns a node's array of children.
+static inline PHTNode** Children(const PHTNode *node, int num_entries) {
+  return (PHTNode **) &node->entries[num_entries];
+}
+
+// Is node (at the level for shift) just a single entry, with no children?
+static inline bool IsSingleton(const PHTNode *node, int shift) {
+  return node->nodemap == 0 && NumEntries(node, shift) == 1;
+}
+
+static inline void Retain(PHTNode *node) {
+  atomic_fetch_add_explicit(&node->refcount, 1, memory_order_relaxed);
+}
+
+// Drops a reference to a node at the level for shift, freeing it (and
+// dropping its references to its children) if it was the last.
+static void Release(PHTNode *node, int shift) {
+  PHTNode **children;
+  int i, num_children;
+
+  // The release half makes our reads of the node happen before another
+  // thread frees it; the acquire half makes theirs happen before we do.
+  if (atomic_fetch_sub_explicit(&node->refcount, 1,
+                                memory_order_acq_rel) != 1) {
+    return;
+  }
+  num_children = __builtin_popcount(node->nodemap);
+  children = Children(node, NumEntries(node, shift));
+  for (i = 0; i < num_children; i++) {
+    Release(children[i], shift + PHT_BITS);
+  }
+  free(node);
+}
+
+// Allocates a node with room for the given number of entries and
+// children, with one reference.
+static PHTNode* NewNode(int num_entries, int num_children) {
+  PHTNode *node = (PHTNode *) malloc(sizeof(PHTNode) +
+                                     num_entries * sizeof(HTKeyValue_t) +
+                                     num_children * sizeof(PHTNode *));
+
+  if (node != NULL) {
+    atomic_init(&node->refcount, 1);
+  }
+  return node;
+}
+
+// Builds a node from the given maps, entries and children.  Each child
+// gains a reference from the new node, except for fresh (if not NULL),
+// a newly built child whose only reference the new node takes over.
+static PHTNode* Pack(uint32_t datamap, uint32_t nodemap,
+                     int num_entries, const HTKeyValue_t *entries,
+                     int num_children, PHTNode *const *children,
+                     PHTNode *fresh) {
+  PHTNode *node, **kids;
+  int i;
+
+  node = NewNode(num_entries, num_children);
+  if (node == NULL) {
+    return NULL;
+  }
+  node->datamap = datamap;
+  node->nodemap = nodemap;
+  for (i = 0; i < num_entries; i++) {
+    node->entries[i] = entries[i];
+  }
+  kids = Children(node, num_entries);
+  for (i = 0; i < num_children; i++) {
+    kids[i] = children[i];
+    if (children[i] != fresh) {
+      Retain(children[i]);
+    }
+  }
+  return node;
+}
+
+// Like Pack, but releases fresh if the node can't be built.
+static PHTNode* PackOrRelease(uint32_t datamap, uint32_t nodemap,
+                              int num_entries, const HTKeyValue_t *entries,
+                              int num_children, PHTNode *const *children,
+                              PHTNode *fresh, int fresh_shift) {
+  PHTNode *node = Pack(datamap, nodemap, num_entries, entries,
+                       num_children, children, fresh);
+
+  if (node == NULL && fresh != NULL) {
+    Release(fresh, fresh_shift);
+  }
+  return node;
+}
+
+// Builds the subtree, rooted at the level for shift, that holds the two
+// entries a and b (with hashes ha and hb).
+static PHTNode* MergeEntries(HTKeyValue_t a, uint64_t ha,
+                             HTKeyValue_t b, uint64_t hb, int shift) {
+  HTKeyValue_t pair[2];
+  uint32_t bit_a, bit_b;
+  PHTNode *child;
+
+  if (shift >= PHT_HASH_BITS) {
+    pair[0] = a;
+    pair[1] = b;
+    return Pack(2, 0, 2, pair, 0, NULL, NULL);
+  }
+
+  bit_a = FragmentBit(ha, shift);
+  bit_b = FragmentBit(hb, shift);
+  if (bit_a != bit_b) {
+    pair[bit_a < bit_b ? 0 : 1] = a;
+    pair[bit_a < bit_b ? 1 : 0] = b;
+    return Pack(bit_a | bit_b, 0, 2, pair, 0, NULL, NULL);
+  }
+
+  child = MergeEntries(a, ha, b, hb, shift + PHT_BITS);
+  if (child == NULL) {
+    return NULL;
+  }
+  return PackOrRelease(0, bit_a, 0, NULL, 1, &child, child,
+                       shift + PHT_BITS);
+}
+
+// Returns a copy of collision node with kv added (or replacing the entry
+// with the same key).
+static PHTNode* InsertIntoCollision(const PHTNode *node, HTKeyValue_t kv,
+                                    HTKeyValue_t *old, bool *replaced) {
+  int i, count = (int) node->datamap;
+  PHTNode *copy;
+
+  for (i = 0; i < count && node->entries[i].key != kv.key; i++) {
+  }
+  copy = NewNode(i < count ? count : count + 1, 0);
+  if (copy == NULL) {
+    return NULL;
+  }
+  copy->datamap = (uint32_t) (i < count ? count : count + 1);
+  copy->nodemap = 0;
+  memcpy(copy->entries, node->entries, count * sizeof(HTKeyValue_t));
+  if (i < count) {
+    *old = copy->entries[i];
+    *replaced = true;
+  }
+  copy->entries[i] = kv;
+  return copy;
+}
+
+// Returns a copy of node, at the level for shift, with kv inserted (or
+// replacing the entry with the same key, which is returned through old,
+// with *replaced set to true).
+static PHTNode* InsertInto(PersistentHashTable *table, const PHTNode *node,
+                           int shift, uint64_t hash, HTKeyValue_t kv,
+                           HTKeyValue_t *old, bool *replaced) {
+  HTKeyValue_t entries[PHT_FANOUT];
+  PHTNode *children[PHT_FANOUT], *child;
+  uint32_t bit, datamap = node->datamap, nodemap = node->nodemap;
+  int i, j, num_entries, num_children;
+
+  if (shift >= PHT_HASH_BITS) {
+    return InsertIntoCollision(node, kv, old, replaced);
+  }
+
+  num_entries = __builtin_popcount(datamap);
+  num_children = __builtin_popcount(nodemap);
+  memcpy(entries, node->entries, num_entries * sizeof(HTKeyValue_t));
+  memcpy(children, Children(node, num_entries),
+         num_children * sizeof(PHTNode *));
+  bit = FragmentBit(hash, shift);
+  i = SlotIndex(datamap, bit);
+  j = SlotIndex(nodemap, bit);
+
+  if (datamap & bit) {
+    if (entries[i].key == kv.key) {
+      *old = entries[i];
+      *replaced = true;
+      entries[i] = kv;
+      return Pack(datamap, nodemap, num_entries, entries,
+                  num_children, children, NULL);
+    }
+
+    // Another key has this fragment: push both down into a new child.
+    child = MergeEntries(entries[i], KeyHash(table, entries[i].key),
+                         kv, hash, shift + PHT_BITS);
+    if (child == NULL) {
+      return NULL;
+    }
+    memmove(&entries[i], &entries[i + 1],
+            (num_entries - i - 1) * sizeof(HTKeyValue_t));
+    memmove(&children[j + 1], &children[j],
+            (num_children - j) * sizeof(PHTNode *));
+    children[j] = child;
+    return PackOrRelease(datamap & ~bit, nodemap | bit,
+                         num_entries - 1, entries,
+                         num_children + 1, children,
+                         child, shift + PHT_BITS);
+  }
+
+  if (nodemap & bit) {
+    child = InsertInto(table, children[j], shift + PHT_BITS, hash, kv,
+                       old, replaced);
+    if (child == NULL) {
+      return NULL;
+    }
+    children[j] = child;
+    return PackOrRelease(datamap, nodemap, num_entries, entries,
+                         num_children, children, child, shift + PHT_BITS);
+  }
+
+  memmove(&entries[i + 1], &entries[i],
+          (num_entries - i) * sizeof(HTKeyValue_t));
+  entries[i] = kv;
+  return Pack(datamap | bit, nodemap, num_entries + 1, entries,
+              num_children, children, NULL);
+}
+
+// Removes key (with the given hash) from node, at the level for shift.
+// If the key is there, sets *found to true, returns its entry through
+// removed, and sets *result to a copy of node without it (or NULL, if
+// that copy would be empty).
+//
+// Returns false if memory ran out, true otherwise.
+static bool RemoveFrom(const PHTNode *node, int shift, uint64_t hash,
+                       HTKey_t key, HTKeyValue_t *removed, bool *found,
+                       PHTNode **result) {
+  HTKeyValue_t entries[PHT_FANOUT];
+  PHTNode *children[PHT_FANOUT], *child;
+  uint32_t bit, datamap = node->datamap, nodemap = node->nodemap;
+  int i, j, num_entries, num_children;
+
+  if (shift >= PHT_HASH_BITS) {
+    num_entries = (int) datamap;
+    for (i = 0; i < num_entries && node->entries[i].key != key; i++) {
+    }
+    if (i == num_entries) {
+      return true;
+    }
+    *found = true;
+    *removed = node->entries[i];
+    *result = NewNode(num_entries - 1, 0);
+    if (*result == NULL) {
+      return false;
+    }
+    (*result)->datamap = (uint32_t) (num_entries - 1);
+    (*result)->nodemap = 0;
+    memcpy((*result)->entries, node->entries, i * sizeof(HTKeyValue_t));
+    memcpy(&(*result)->entries[i], &node->entries[i + 1],
+           (num_entries - i - 1) * sizeof(HTKeyValue_t));
+    return true;
+  }
+
+  num_entries = __builtin_popcount(datamap);
+  num_children = __builtin_popcount(nodemap);
+  memcpy(entries, node->entries, num_entries * sizeof(HTKeyValue_t));
+  memcpy(children, Children(node, num_entries),
+         num_children * sizeof(PHTNode *));
+  bit = FragmentBit(hash, shift);
+  i = SlotIndex(datamap, bit);
+  j = SlotIndex(nodemap, bit);
+
+  if (datamap & bit) {
+    if (entries[i].key != key) {
+      return true;
+    }
+    *found = true;
+    *removed = entries[i];
+    if (num_entries == 1 && num_children == 0) {
+      *result = NULL;
+      return true;
+    }
+    memmove(&entries[i], &entries[i + 1],
+            (num_entries - i - 1) * sizeof(HTKeyValue_t));
+    *result = Pack(datamap & ~bit, nodemap, num_entries - 1, entries,
+                   num_children, children, NULL);
+    return *result != NULL;
+  }
+
+  if (!(nodemap & bit)) {
+    return true;
+  }
+  if (!RemoveFrom(children[j], shift + PHT_BITS, hash, key, removed,
+                  found, &child)) {
+    return false;
+  }
+  if (!*found) {
+    return true;
+  }
+
+  // A child always has at least two entries below it, so child isn't
+  // empty.  If it's down to one, pull that entry up into this node.
+  if (IsSingleton(child, shift + PHT_BITS)) {
+    memmove(&children[j], &children[j + 1],
+            (num_children - j - 1) * sizeof(PHTNode *));
+    memmove(&entries[i + 1], &entries[i],
+            (num_entries - i) * sizeof(HTKeyValue_t));
+    entries[i] = child->entries[0];
+    Release(child, shift + PHT_BITS);
+    *result = Pack(datamap | bit, nodemap & ~bit, num_entries + 1, entries,
+                   num_children - 1, children, NULL);
+    return *result != NULL;
+  }
+  children[j] = child;
+  *result = PackOrRelease(datamap, nodemap, num_entries, entries,
+                          num_children, children, child, shift + PHT_BITS);
+  return *result != NULL;
+}
+
+// Calls visit_function on every entry under node, at the level for shift.
+static void VisitNode(const PHTNode *node, int shift,
+                      PHTVisitFnPtr visit_function, void *arg) {
+  int i, num_entries = NumEntries(node, shift);
+  int num_children = __builtin_popcount(node->nodemap);
+  PHTNode **children = Children(node, num_entries);
+
+  for (i = 0; i < num_entries; i++) {
+    visit_function(&node->entries[i], arg);
+  }
+  for (i = 0; i < num_children; i++) {
+    VisitNode(children[i], shift + PHT_BITS, visit_function, arg);
+  }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// PersistentHashTable implementation.
+
+PersistentHashTable* PersistentHashTable_Allocate(void) {
+  PersistentHashTable *table =
+    (PersistentHashTable *) malloc(sizeof(PersistentHashTable));
+
+  if (table == NULL) {
+    return NULL;
+  }
+  table->root = NULL;
+  table->num_elements = 0;
+  HTRandomSeed(table->seed);
+  return table;
+}
+
+PersistentHashTable* PersistentHashTable_Clone(PersistentHashTable *table) {
+  PersistentHashTable *clone =
+    (PersistentHashTable *) malloc(sizeof(PersistentHashTable));
+
+  if (clone == NULL) {
+    return NULL;
+  }
+  *clone = *table;
+  if (clone->root != NULL) {
+    Retain(clone->root);
+  }
+  return clone;
+}
+
+void PersistentHashTable_Free(PersistentHashTable *table) {
+  if (table->root != NULL) {
+    Release(table->root, 0);
+  }
+  free(table);
+}
+
+int PersistentHashTable_NumElements(PersistentHashTable *table) {
+  return table->num_elements;
+}
+
+bool PersistentHashTable_Insert(PersistentHashTable *table,
+                                HTKeyValue_t newkeyvalue,
+                                HTKeyValue_t *oldkeyvalue) {
+  uint64_t hash = KeyHash(table, newkeyvalue.key);
+  HTKeyValue_t old;
+  bool replaced = false;
+  PHTNode *root;
+
+  if (table->root == NULL) {
+    root = Pack(FragmentBit(hash, 0), 0, 1, &newkeyvalue, 0, NULL, NULL);
+  } else {
+    root = InsertInto(table, table->root, 0, hash, newkeyvalue, &old,
+                      &replaced);
+  }
+  if (root == NULL) {
+    return false;
+  }
+
+  if (table->root != NULL) {
+    Release(table->root, 0);
+  }
+  table->root = root;
+  if (replaced) {
+    *oldkeyvalue = old;
+  } else {
+    table->num_elements++;
+  }
+  return replaced;
+}
+
+bool PersistentHashTable_Find(PersistentHashTable *table,
+                              HTKey_t key,
+                              HTKeyValue_t *keyvalue) {
+  const PHTNode *node = table->root;
+  uint64_t hash = KeyHash(table, key);
+  uint32_t bit;
+  int i, shift = 0;
+
+  while (node != NULL) {
+    if (shift >= PHT_HASH_BITS) {
+      for (i = 0; i < (int) node->datamap; i++) {
+        if (node->entries[i].key == key) {
+          *keyvalue = node->entries[i];
+          return true;
+        }
+      }
+      return false;
+    }
+
+    bit = FragmentBit(hash, shift);
+    if (node->datamap & bit) {
+      i = SlotIndex(node->datamap, bit);
+      if (node->entries[i].key != key) {
+        return false;
+      }
+      *keyvalue = node->entries[i];
+      return true;
+    }
+    if (!(node->nodemap & bit)) {
+      return false;
+    }
+    node = Children(node, __builtin_popcount(node->datamap))
+             [SlotIndex(node->nodemap, bit)];
+    shift += PHT_BITS;
+  }
+  return false;
+}
+
+bool PersistentHashTable_Remove(PersistentHashTable *table,
+                                HTKey_t key,
+                                HTKeyValue_t *keyvalue) {
+  HTKeyValue_t removed;
+  PHTNode *root = NULL;
+  bool found = false;
+
+  if (table->root == NULL ||
+      !RemoveFrom(table->root, 0, KeyHash(table, key), key, &removed,
+                  &found, &root) ||
+      !found) {
+    return false;
+  }
+
+  Release(table->root, 0);
+  table->root = root;
+  table->num_elements--;
+  *keyvalue = removed;
+  return true;
+}
+
+void PersistentHashTable_Visit(PersistentHashTable *table,
+                               PHTVisitFnPtr visit_function,
+                               void *arg) {
+  if (table->root != NULL) {
+    VisitNode(table->root, 0, visit_function, arg);
+  }
+}
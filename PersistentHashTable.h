@@ -0,0 +1,95 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_PERSISTENTHASHTABLE_H_
+#define HW0_PERSISTENTHASHTABLE_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+
+#include "./HashTable.h"  // for HTKey_t, HTValue_t, HTKeyValue_t
+
+///////////////////////////////////////////////////////////////////////////////
+// A PersistentHashTable is a map from HTKey_t to HTValue_t that can be
+// cloned in constant time, for publishing consistent snapshots of a table
+// to readers.
+//
+// It is a hash array mapped trie: each node covers five bits of the key's
+// hash and holds only the entries and children that are actually present,
+// packed in an array indexed by the popcount of a 32-bit bitmap.  Nodes are
+// never changed once built.  An update copies just the nodes on the path
+// from the root to the key (at most 13, and about log32(n) in practice)
+// and shares everything else with the version it started from.  A clone
+// just shares the root.
+//
+// So each PersistentHashTable is a version of the map that nothing else
+// can change: updating one clone never affects another, and a reader can
+// keep using its clone while a writer goes on updating (and cloning) its
+// own.  A given PersistentHashTable must only be used by one thread at a
+// time, but different clones may be used (and freed) by different threads
+// at once.
+//
+// The values are shared between clones and are never freed by the table,
+// so they should be plain data, or managed (eg, reference counted) by the
+// customer.
+//
+// As with HashTable, "struct pht" is defined in PersistentHashTable_priv.h.
+typedef struct pht PersistentHashTable;
+
+// Allocate and return a new, empty PersistentHashTable.
+//
+// Returns NULL on error, non-NULL on success.
+PersistentHashTable* PersistentHashTable_Allocate(void);
+
+// Returns a new PersistentHashTable holding the same entries as table, in
+// constant time.  The two can then be updated independently.
+//
+// Returns NULL on error (out of memory), non-NULL on success.
+PersistentHashTable* PersistentHashTable_Clone(PersistentHashTable *table);
+
+// Free a PersistentHashTable.  Nodes shared with other clones are kept
+// until the last clone using them is freed.
+//
+// Arguments:
+// - table: the table to free.  It is unsafe to use table after this
+//   function returns.
+void PersistentHashTable_Free(PersistentHashTable *table);
+
+// Returns the number of entries in the table.
+int PersistentHashTable_NumElements(PersistentHashTable *table);
+
+// Inserts a (key,value) pair into the table, replacing (and returning via
+// oldkeyvalue) any existing entry with the same key.  Arguments and return
+// values are as for HashTable_Insert, except that false is also returned
+// if memory ran out, in which case the table is unchanged.
+bool PersistentHashTable_Insert(PersistentHashTable *table,
+                                HTKeyValue_t newkeyvalue,
+                                HTKeyValue_t *oldkeyvalue);
+
+// Looks up a key; arguments and return values are as for HashTable_Find.
+bool PersistentHashTable_Find(PersistentHashTable *table,
+                              HTKey_t key,
+                              HTKeyValue_t *keyvalue);
+
+// Removes a key; arguments and return values are as for HashTable_Remove,
+// except that false is also returned if memory ran out (a removal copies
+// nodes too), in which case the table is unchanged.
+bool PersistentHashTable_Remove(PersistentHashTable *table,
+                                HTKey_t key,
+                                HTKeyValue_t *keyvalue);
+
+// Calls visit_function(kv, arg) once for each entry in the table, in no
+// particular order.  kv is only valid during the call.
+typedef void(*PHTVisitFnPtr)(const HTKeyValue_t *kv, void *arg);
+void PersistentHashTable_Visit(PersistentHashTable *table,
+                               PHTVisitFnPtr visit_function,
+                               void *arg);
+
+#endif  // HW0_PERSISTENTHASHTABLE_H_
@@ -0,0 +1,66 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_PERSISTENTHASHTABLE_PRIV_H_
+#define HW0_PERSISTENTHASHTABLE_PRIV_H_
+
+#include <stdint.h>     // for uint64_t, etc.
+#include <stdatomic.h>  // for atomic_int
+
+#include "./PersistentHashTable.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our PersistentHashTable
+// implementation.
+//
+// These would typically be located in PersistentHashTable.c; however, we
+// have broken them out into a "private .h" so that our unittests can
+// access them.
+//
+// Customers should not include this file or assume anything based on
+// its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// Each level of the trie consumes PHT_BITS bits of the key's hash, starting
+// from the low bits.  Below the last level (once shift reaches 64) the hash
+// is used up, and keys whose hashes are entirely equal share a "collision
+// node": a plain array of entries, whose count is kept in datamap.
+#define PHT_BITS 5
+#define PHT_FANOUT (1 << PHT_BITS)
+#define PHT_HASH_BITS 64
+
+// A trie node.  Bit f of datamap (or nodemap) is set if the node has an
+// entry (or a child) for hash fragment f; the entries come first, in
+// fragment order, followed by the child pointers, also in fragment order,
+// so the slot for fragment f is found by counting the bits below it.
+//
+// A node never holds both an entry and a child for the same fragment, and
+// a child always has at least two entries below it, so each set of
+// entries has exactly one shape.
+//
+// refcount counts the parents and tables pointing at the node.  A node is
+// shared (and so must not be changed) while other clones use it, and is
+// freed when the last of them lets go of it.
+typedef struct pht_node {
+  atomic_int    refcount;
+  uint32_t      datamap;    // see above; the entry count in collision nodes
+  uint32_t      nodemap;    // see above; zero in collision nodes
+  HTKeyValue_t  entries[];  // the entries, then the child pointers
+} PHTNode;
+
+// One version of the map.
+typedef struct pht {
+  PHTNode  *root;          // the trie, or NULL if empty
+  int       num_elements;  // # entries in the trie
+  uint64_t  seed[2];       // SipHash key; shared by all clones
+} PersistentHashTable;
+
+#endif  // HW0_PERSISTENTHASHTABLE_PRIV_H_
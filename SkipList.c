@@ -0,0 +1,241 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "SkipList.h"
+#include "SkipList_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+// Used when a payload leaves the list but is handed back to the customer.
+static void KeepPayload(LLPayload_t payload) {
+  (void) payload;
+}
+
+// Picks the number of express levels for a new element: 0 with
+// probability 1 - 1/SL_BRANCHING, and each further level with
+// probability 1/SL_BRANCHING.  Heights don't depend on the payloads, so
+// they can't be steered by a customer choosing what to insert.
+static int RandomHeight(SkipList *sl) {
+  uint64_t r;
+  int height = 0;
+
+  sl->rng ^= sl->rng << 13;
+  sl->rng ^= sl->rng >> 7;
+  sl->rng ^= sl->rng << 17;
+  r = sl->rng;
+  while (height < SL_MAX_LEVELS && r % SL_BRANCHING == 0) {
+    height++;
+    r /= SL_BRANCHING;
+  }
+  return height;
+}
+
+// Returns the first node that doesn't compare less than probe, or NULL if
+// there is none.  If update isn't NULL, also sets update[i], for each
+// express level in use, to the last tower at level i + 1 that compares
+// less than probe (or to the head).
+static LinkedListNode* SearchNode(SkipList *sl, LLPayload_t probe,
+                                  SkipListTower **update) {
+  SkipListTower *x = sl->head;
+  LinkedListNode *node;
+  int i;
+
+  for (i = sl->levels - 1; i >= 0; i--) {
+    while (x->next[i] != NULL &&
+           sl->comparator(x->next[i]->payload, probe) < 0) {
+      x = x->next[i];
+    }
+    if (update != NULL) {
+      update[i] = x;
+    }
+  }
+
+  // Finish along the list itself, from the last tower we passed.
+  node = (x == sl->head) ? sl->list->head : x->node->next;
+  while (node != NULL && sl->comparator(node->payload, probe) < 0) {
+    node = node->next;
+  }
+  return node;
+}
+
+// Returns node's tower, given the update array from the search that found
+// it, or NULL if node has none.
+static SkipListTower* NodeTower(SkipList *sl, LinkedListNode *node,
+                                SkipListTower **update) {
+  if (sl->levels > 0 && update[0]->next[0] != NULL &&
+      update[0]->next[0]->node == node) {
+    return update[0]->next[0];
+  }
+  return NULL;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SkipList implementation.
+
+SkipList* SkipList_Allocate(LLPayloadComparatorFnPtr comparator_function) {
+  SkipList *sl = (SkipList *) malloc(sizeof(SkipList));
+
+  if (sl == NULL) {
+    return NULL;
+  }
+  sl->list = LinkedList_Allocate();
+  sl->head = (SkipListTower *) calloc(1, sizeof(SkipListTower) +
+                                      SL_MAX_LEVELS *
+                                      sizeof(SkipListTower *));
+  if (sl->list == NULL || sl->head == NULL) {
+    if (sl->list != NULL) {
+      LinkedList_Free(sl->list, &KeepPayload);
+    }
+    free(sl->head);
+    free(sl);
+    return NULL;
+  }
+  sl->head->height = SL_MAX_LEVELS;
+  sl->comparator = comparator_function;
+  sl->levels = 0;
+  sl->rng = 0x9e3779b97f4a7c15ULL;
+  return sl;
+}
+
+void SkipList_Free(SkipList *list, LLPayloadFreeFnPtr payload_free_function) {
+  SkipListTower *tower = list->head->next[0], *next;
+
+  // Every tower is on level 1.
+  while (tower != NULL) {
+    next = tower->next[0];
+    free(tower);
+    tower = next;
+  }
+  LinkedList_Free(list->list, payload_free_function);
+  free(list->head);
+  free(list);
+}
+
+int SkipList_NumElements(SkipList *list) {
+  return LinkedList_NumElements(list->list);
+}
+
+bool SkipList_Insert(SkipList *list, LLPayload_t payload,
+                     LLPayload_t *old_payload) {
+  SkipListTower *update[SL_MAX_LEVELS], *tower = NULL;
+  LinkedListNode *node;
+  LLIterator iter;
+  int height, i;
+
+  node = SearchNode(list, payload, update);
+  if (node != NULL && list->comparator(node->payload, payload) == 0) {
+    *old_payload = node->payload;
+    node->payload = payload;
+    tower = NodeTower(list, node, update);
+    if (tower != NULL) {
+      tower->payload = payload;
+    }
+    return true;
+  }
+
+  height = RandomHeight(list);
+  if (height > 0) {
+    tower = (SkipListTower *) malloc(sizeof(SkipListTower) +
+                                     height * sizeof(SkipListTower *));
+    if (tower == NULL) {
+      return false;
+    }
+  }
+
+  // Link the new node in just before node (or at the tail).
+  iter.list = list->list;
+  iter.node = node;
+  iter.index = 0;
+  if (!LLIterator_Insert(&iter, payload)) {
+    free(tower);
+    return false;
+  }
+  if (tower == NULL) {
+    return false;
+  }
+
+  tower->payload = payload;
+  tower->node = (node != NULL) ? node->prev : list->list->tail;
+  tower->height = height;
+  for (i = list->levels; i < height; i++) {
+    update[i] = list->head;
+  }
+  if (height > list->levels) {
+    list->levels = height;
+  }
+  for (i = 0; i < height; i++) {
+    tower->next[i] = update[i]->next[i];
+    update[i]->next[i] = tower;
+  }
+  return false;
+}
+
+bool SkipList_Find(SkipList *list, LLPayload_t probe, LLPayload_t *payload) {
+  LinkedListNode *node = SearchNode(list, probe, NULL);
+
+  if (node == NULL || list->comparator(node->payload, probe) != 0) {
+    return false;
+  }
+  *payload = node->payload;
+  return true;
+}
+
+bool SkipList_Remove(SkipList *list, LLPayload_t probe,
+                     LLPayload_t *payload) {
+  SkipListTower *update[SL_MAX_LEVELS], *tower;
+  LinkedListNode *node;
+  LLIterator iter;
+  int i;
+
+  node = SearchNode(list, probe, update);
+  if (node == NULL || list->comparator(node->payload, probe) != 0) {
+    return false;
+  }
+  *payload = node->payload;
+
+  // The tower is the first one at or after probe on each of its levels,
+  // so update[i] is its predecessor on level i + 1.
+  tower = NodeTower(list, node, update);
+  if (tower != NULL) {
+    for (i = 0; i < tower->height; i++) {
+      update[i]->next[i] = tower->next[i];
+    }
+    free(tower);
+    while (list->levels > 0 && list->head->next[list->levels - 1] == NULL) {
+      list->levels--;
+    }
+  }
+
+  iter.list = list->list;
+  iter.node = node;
+  iter.index = 0;
+  LLIterator_Remove(&iter, &KeepPayload);
+  return true;
+}
+
+LLIterator* SkipList_Iterator(SkipList *list) {
+  return LLIterator_Allocate(list->list);
+}
+
+LLIterator* SkipList_Seek(SkipList *list, LLPayload_t probe) {
+  LLIterator *iter = LLIterator_Allocate(list->list);
+
+  if (iter != NULL) {
+    iter->node = SearchNode(list, probe, NULL);
+  }
+  return iter;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_SKIPLIST_H_
+#define HW0_SKIPLIST_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+
+#include "./LinkedList.h"  // for LinkedList, LLIterator, LLPayload_t
+
+///////////////////////////////////////////////////////////////////////////////
+// A SkipList is a LinkedList that is kept sorted, with an index on top for
+// finding things quickly.
+//
+// The payloads are kept in ascending order (by a customer-supplied
+// comparator) in an ordinary doubly-linked LinkedList.  Above the list,
+// about a quarter of the elements also get a "tower" of express links,
+// with a quarter of those reaching one level higher, and so on; a search
+// runs along the top level until it would overshoot, drops a level, and
+// repeats, reaching its element in O(log n) steps.  Insert, find and
+// remove all take O(log n) expected time.
+//
+// Since the elements are a LinkedList underneath, a range scan is just an
+// LLIterator: SkipList_Seek returns one positioned at the first element
+// at or after a probe, and LLIterator_Next walks on from there in order.
+//
+// Nothing is modified by SkipList_Find or SkipList_Seek, or by walking
+// an iterator, so any number of threads may do those at once, as long as
+// no thread is modifying the list.
+//
+// As with LinkedList, "struct sl" is defined in SkipList_priv.h.
+typedef struct sl SkipList;
+
+// Allocate and return a new, empty SkipList.
+//
+// Arguments:
+// - comparator_function: orders the payloads; see LinkedList.h.  Two
+//   payloads that compare equal are the same element, so the list never
+//   holds both.
+//
+// Returns NULL on error, non-NULL on success.
+SkipList* SkipList_Allocate(LLPayloadComparatorFnPtr comparator_function);
+
+// Free a SkipList.
+//
+// Arguments:
+// - list: the list to free.  It is unsafe to use list after this
+//   function returns.
+// - payload_free_function: invoked once for each payload in the list.
+void SkipList_Free(SkipList *list, LLPayloadFreeFnPtr payload_free_function);
+
+// Returns the number of elements in the list.
+int SkipList_NumElements(SkipList *list);
+
+// Inserts a payload into its place in the list, replacing (and returning
+// via old_payload) any element that compares equal to it.
+//
+// Arguments:
+// - list: the list to insert into.
+// - payload: the payload to insert.
+// - old_payload: a return parameter; if an equal element was replaced, its
+//   payload is returned here, and the caller assumes ownership of it.
+//
+// Returns:
+// - false if payload was added as a new element (or memory ran out, in
+//   which case the list is unchanged; see SkipList_NumElements).
+// - true if payload replaced an equal element.
+bool SkipList_Insert(SkipList *list, LLPayload_t payload,
+                     LLPayload_t *old_payload);
+
+// Looks up the element that compares equal to probe.
+//
+// Arguments:
+// - list: the list to search.
+// - probe: the payload to compare the elements against.  It need only be
+//   filled in enough for the comparator.
+// - payload: a return parameter; if an element was found, its payload is
+//   returned here.
+//
+// Returns:
+// - true if an element was found, false otherwise.
+bool SkipList_Find(SkipList *list, LLPayload_t probe, LLPayload_t *payload);
+
+// Removes the element that compares equal to probe.  Arguments are as for
+// SkipList_Find; the caller assumes ownership of the removed payload.
+//
+// Returns:
+// - true if an element was removed, false if there was none.
+bool SkipList_Remove(SkipList *list, LLPayload_t probe,
+                     LLPayload_t *payload);
+
+// Returns a new iterator over the list's elements in ascending order,
+// positioned at the smallest (or past the end, if the list is empty).
+//
+// The iterator works with the usual LLIterator functions, and must be
+// freed with LLIterator_Free.  Don't use LLIterator_Remove,
+// LLIterator_Insert or LinkedList_SpliceAt on it, which would bypass the
+// index, and don't use it after the list has been modified.
+//
+// Returns NULL on error (out of memory).
+LLIterator* SkipList_Iterator(SkipList *list);
+
+// Like SkipList_Iterator, but positions the iterator at the first element
+// that doesn't compare less than probe, or past the end if every element
+// does.  To visit the elements in [a, b], seek to a and walk forward
+// until an element compares greater than b.
+LLIterator* SkipList_Seek(SkipList *list, LLPayload_t probe);
+
+#endif  // HW0_SKIPLIST_H_
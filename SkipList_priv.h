@@ -0,0 +1,61 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_SKIPLIST_PRIV_H_
+#define HW0_SKIPLIST_PRIV_H_
+
+#include <stdint.h>  // for uint64_t, etc.
+
+#include "./SkipList.h"
+#include "./LinkedList_priv.h"  // for LinkedListNode
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our SkipList implementation.
+//
+// These would typically be located in SkipList.c; however, we have broken
+// them out into a "private .h" so that our unittests can access them.
+//
+// Customers should not include this file or assume anything based on
+// its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// Each element has a 1-in-SL_BRANCHING chance of rising above the list
+// into express level 1, and each element at level i the same chance of
+// rising to level i + 1.  With a branching factor of 4, three quarters of
+// the elements have no tower at all, and a search looks at about 4 links
+// per level.
+#define SL_BRANCHING 4
+#define SL_MAX_LEVELS 24  // express levels; enough for 4^24 elements
+
+// The tower of express links over one element.  The list's own next
+// pointers are level 0, so a tower of height h holds levels 1..h, with
+// next[i] the following tower at level i + 1 (or NULL).
+//
+// Towers keep a copy of their element's payload, so that a search
+// doesn't have to follow node to compare against it.
+typedef struct sl_tower {
+  LLPayload_t      payload;  // the element's payload
+  LinkedListNode  *node;     // the element's node in the list
+  int              height;   // # express levels, 1..SL_MAX_LEVELS
+  struct sl_tower *next[];   // see above
+} SkipListTower;
+
+// The skip list.  head is a tower of full height in front of the first
+// element; its node and payload are unused.
+typedef struct sl {
+  LinkedList               *list;        // the elements, in order
+  LLPayloadComparatorFnPtr  comparator;  // orders the payloads
+  SkipListTower            *head;        // see above
+  int                       levels;      // # express levels in use
+  uint64_t                  rng;         // xorshift state for heights
+} SkipList;
+
+#endif  // HW0_SKIPLIST_PRIV_H_
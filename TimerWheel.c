@@ -0,0 +1,238 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "TimerWheel.h"
+#include "TimerWheel_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+//
+#define TW_SLOT_MASK ((uint64_t) (TW_SLOTS - 1))
+
+// Returns the number of ticks covered by one slot at the given level.
+static uint64_t LevelSpan(int level) {
+  return 1ULL << (TW_SLOT_BITS * level);
+}
+
+// Puts a timer on the due list.
+static void PushDue(TimerWheel *wheel, TWTimer *timer) {
+  timer->next = wheel->due;
+  wheel->due = timer;
+  wheel->num_due += 1;
+}
+
+// Files a timer into the slot that matches its distance from the wheel's
+// current tick, or onto the due list if its deadline has already passed.
+static void PlaceTimer(TimerWheel *wheel, TWTimer *timer) {
+  uint64_t delta;
+  int level, slot;
+
+  if (timer->deadline < wheel->current) {
+    PushDue(wheel, timer);
+    return;
+  }
+
+  // Use the finest level whose range reaches the deadline.  The top level
+  // reaches every 64-bit deadline, so we stop there.
+  delta = timer->deadline - wheel->current;
+  for (level = 0; level < TW_LEVELS - 1; level++) {
+    if (delta < LevelSpan(level + 1)) {
+      break;
+    }
+  }
+  slot = (int) ((timer->deadline >> (TW_SLOT_BITS * level)) & TW_SLOT_MASK);
+
+  timer->next = wheel->slots[level][slot];
+  wheel->slots[level][slot] = timer;
+  wheel->occupied[level] |= 1ULL << slot;
+}
+
+// Empties the given slot, re-filing each of its timers relative to the
+// wheel's current tick.  Timers move down to finer levels as they get close.
+static void CascadeSlot(TimerWheel *wheel, int level, int slot) {
+  TWTimer *timer = wheel->slots[level][slot];
+
+  wheel->slots[level][slot] = NULL;
+  wheel->occupied[level] &= ~(1ULL << slot);
+  while (timer != NULL) {
+    TWTimer *next = timer->next;
+    PlaceTimer(wheel, timer);
+    timer = next;
+  }
+}
+
+// Cascades every coarse level whose slot boundary falls on tick t, from the
+// top down so that timers can fall through several levels in one tick.
+static void Cascade(TimerWheel *wheel, uint64_t t) {
+  int level;
+
+  for (level = TW_LEVELS - 1; level > 0; level--) {
+    if ((t & (LevelSpan(level) - 1)) == 0) {
+      int slot = (int) ((t >> (TW_SLOT_BITS * level)) & TW_SLOT_MASK);
+      if (wheel->occupied[level] & (1ULL << slot)) {
+        CascadeSlot(wheel, level, slot);
+      }
+    }
+  }
+}
+
+// Returns the first tick after t at which the wheel has work to do: either
+// an occupied level-0 slot comes due, or an occupied coarser slot cascades.
+// Returns 0 if no timers are filed in any slot.
+//
+// At each level, the slots after the current one come up in rotating order
+// at multiples of that level's span, so we rotate the occupancy bitmap to
+// start just past the current slot and count trailing zeros.
+static uint64_t NextEventTick(TimerWheel *wheel, uint64_t t) {
+  uint64_t best = 0;
+  int level;
+
+  for (level = 0; level < TW_LEVELS; level++) {
+    uint64_t bits = wheel->occupied[level];
+    uint64_t base, tick;
+    int start;
+
+    if (bits == 0) {
+      continue;
+    }
+    base = t >> (TW_SLOT_BITS * level);
+    start = (int) ((base + 1) & TW_SLOT_MASK);
+    if (start != 0) {
+      bits = (bits >> start) | (bits << (TW_SLOTS - start));
+    }
+    tick = (base + 1 + (uint64_t) __builtin_ctzll(bits))
+           << (TW_SLOT_BITS * level);
+    if (best == 0 || tick < best) {
+      best = tick;
+    }
+  }
+  return best;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TimerWheel implementation.
+
+TimerWheel* TimerWheel_Allocate(uint64_t now) {
+  TimerWheel *wheel = (TimerWheel *) calloc(1, sizeof(TimerWheel));
+
+  if (wheel == NULL) {
+    return NULL;
+  }
+  wheel->current = now;
+  return wheel;
+}
+
+void TimerWheel_Free(TimerWheel *wheel) {
+  TWTimer *timer;
+  int level, slot;
+
+  for (level = 0; level < TW_LEVELS; level++) {
+    for (slot = 0; slot < TW_SLOTS; slot++) {
+      while ((timer = wheel->slots[level][slot]) != NULL) {
+        wheel->slots[level][slot] = timer->next;
+        free(timer);
+      }
+    }
+  }
+  while ((timer = wheel->due) != NULL) {
+    wheel->due = timer->next;
+    free(timer);
+  }
+  while ((timer = wheel->free_timers) != NULL) {
+    wheel->free_timers = timer->next;
+    free(timer);
+  }
+  free(wheel);
+}
+
+int TimerWheel_NumTimers(TimerWheel *wheel) {
+  return wheel->num_timers;
+}
+
+bool TimerWheel_Add(TimerWheel *wheel, uint64_t key, uint64_t deadline) {
+  TWTimer *timer = wheel->free_timers;
+
+  if (timer != NULL) {
+    wheel->free_timers = timer->next;
+  } else {
+    timer = (TWTimer *) malloc(sizeof(TWTimer));
+    if (timer == NULL) {
+      return false;
+    }
+  }
+
+  timer->key = key;
+  timer->deadline = deadline;
+  PlaceTimer(wheel, timer);
+  wheel->num_timers += 1;
+  return true;
+}
+
+int TimerWheel_Advance(TimerWheel *wheel, uint64_t now, int max_fire,
+                       TimerFireFnPtr fire_function, void *arg) {
+  int fired = 0;
+
+  // Move the clock forward, collecting due timers.  We stop early once we
+  // have collected enough to satisfy max_fire; the rest of the clock
+  // movement happens on a later call.
+  while (wheel->current <= now &&
+         (max_fire <= 0 || wheel->num_due < max_fire)) {
+    uint64_t t = wheel->current;
+    uint64_t next;
+    int slot;
+
+    if ((t & TW_SLOT_MASK) == 0) {
+      Cascade(wheel, t);
+    }
+
+    // Every timer in this level-0 slot has deadline t.
+    slot = (int) (t & TW_SLOT_MASK);
+    if (wheel->occupied[0] & (1ULL << slot)) {
+      TWTimer *timer = wheel->slots[0][slot];
+
+      wheel->slots[0][slot] = NULL;
+      wheel->occupied[0] &= ~(1ULL << slot);
+      while (timer != NULL) {
+        TWTimer *nexttimer = timer->next;
+        PushDue(wheel, timer);
+        timer = nexttimer;
+      }
+    }
+
+    // Skip straight to the next tick with something to do; nothing can
+    // come due in between.
+    next = NextEventTick(wheel, t);
+    wheel->current = (next == 0 || next > now + 1) ? now + 1 : next;
+  }
+
+  // Fire what's due.  Each timer is recycled before its callback runs, so
+  // the callback is free to add new timers.
+  while (wheel->due != NULL && (max_fire <= 0 || fired < max_fire)) {
+    TWTimer *timer = wheel->due;
+    uint64_t key = timer->key;
+    uint64_t deadline = timer->deadline;
+
+    wheel->due = timer->next;
+    wheel->num_due -= 1;
+    wheel->num_timers -= 1;
+    timer->next = wheel->free_timers;
+    wheel->free_timers = timer;
+
+    fire_function(key, deadline, arg);
+    fired += 1;
+  }
+  return fired;
+}
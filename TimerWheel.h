@@ -0,0 +1,85 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_TIMERWHEEL_H_
+#define HW0_TIMERWHEEL_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stdint.h>     // for uint64_t, etc.
+
+///////////////////////////////////////////////////////////////////////////////
+// A TimerWheel is a hierarchical timing wheel: a set of (key, deadline)
+// timers that fire, in batches, as the caller advances the wheel's clock.
+//
+// Time is measured in abstract "ticks" chosen by the caller (HashTable uses
+// milliseconds).  Adding a timer is O(1), and advancing the clock costs
+// O(number of timers that fire), plus a small constant for every 64 ticks
+// that pass while timers are pending -- it never scans timers that are not
+// yet due.
+//
+// Timers can't be cancelled.  Instead, customers are expected to check,
+// when a timer fires, whether the thing it refers to still has that
+// deadline, and ignore it if not.
+//
+// As with our other containers, "struct tw" is defined in the private
+// header TimerWheel_priv.h.
+typedef struct tw TimerWheel;
+
+// When a timer fires, the wheel invokes a customer-supplied function with
+// the timer's key and deadline, plus the opaque argument passed to
+// TimerWheel_Advance.
+typedef void(*TimerFireFnPtr)(uint64_t key, uint64_t deadline, void *arg);
+
+// Allocate and return a new, empty TimerWheel.
+//
+// Arguments:
+// - now: the wheel's starting time.
+//
+// Returns NULL on error, non-NULL on success.
+TimerWheel* TimerWheel_Allocate(uint64_t now);
+
+// Free a TimerWheel and any timers still pending in it.  The pending
+// timers do not fire.
+void TimerWheel_Free(TimerWheel *wheel);
+
+// Returns the number of timers that have been added but not yet fired.
+int TimerWheel_NumTimers(TimerWheel *wheel);
+
+// Adds a timer.
+//
+// Arguments:
+// - wheel: the wheel to add to.
+// - key: an opaque value handed back when the timer fires.
+// - deadline: the time at which the timer should fire.  A deadline that
+//   has already passed fires on the next call to TimerWheel_Advance.
+//
+// Returns false if memory for the timer couldn't be allocated.
+bool TimerWheel_Add(TimerWheel *wheel, uint64_t key, uint64_t deadline);
+
+// Advances the wheel's clock to "now" and fires the timers whose deadline
+// is at or before it.
+//
+// Arguments:
+// - wheel: the wheel to advance.
+// - now: the current time.  Moving the clock backwards has no effect.
+// - max_fire: the maximum number of timers to fire during this call, or 0
+//   for no limit.  Due timers beyond the limit stay queued and fire first
+//   on the next call, which lets the customer spread the work out.
+// - fire_function: invoked once for each timer that fires.  It may add new
+//   timers to the wheel.
+// - arg: passed through to fire_function.
+//
+// Returns:
+// - the number of timers that fired.
+int TimerWheel_Advance(TimerWheel *wheel, uint64_t now, int max_fire,
+                       TimerFireFnPtr fire_function, void *arg);
+
+#endif  // HW0_TIMERWHEEL_H_
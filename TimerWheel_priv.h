@@ -0,0 +1,61 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_TIMERWHEEL_PRIV_H_
+#define HW0_TIMERWHEEL_PRIV_H_
+
+#include <stdint.h>  // for uint64_t, etc.
+
+#include "./TimerWheel.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our TimerWheel
+// implementation.
+//
+// These would typically be located in TimerWheel.c; however, we have broken
+// them out into a "private .h" so that our unittests can access them.
+//
+// Customers should not include this file or assume anything based on
+// its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// The wheel has TW_LEVELS levels of TW_SLOTS slots each.  A slot at level L
+// covers 64^L ticks, and eleven levels of 6 bits cover the whole 64-bit
+// range, so every deadline has a slot.  The upper levels are nearly always
+// empty, and empty levels cost only a zero test of their occupancy bitmap.
+#define TW_SLOT_BITS 6
+#define TW_SLOTS     (1 << TW_SLOT_BITS)
+#define TW_LEVELS    11
+
+// A single pending timer.  Timers in a slot are kept in a singly-linked
+// list; fired timers are recycled through the wheel's free list.
+typedef struct tw_timer {
+  uint64_t         key;       // customer's key
+  uint64_t         deadline;  // when this timer fires
+  struct tw_timer *next;      // next timer in the slot (or free list)
+} TWTimer;
+
+// The wheel.
+//
+// "current" is the next tick to be processed: every timer with an earlier
+// deadline has already been moved to the "due" list.  occupied[L] has bit
+// i set iff slots[L][i] is non-empty, which lets Advance skip empty slots.
+typedef struct tw {
+  uint64_t  current;                     // next tick to process
+  int       num_timers;                  // # timers not yet fired
+  int       num_due;                     // # of those on the due list
+  uint64_t  occupied[TW_LEVELS];         // non-empty slot bitmaps
+  TWTimer  *slots[TW_LEVELS][TW_SLOTS];  // the timer lists
+  TWTimer  *due;                         // timers waiting to be fired
+  TWTimer  *free_timers;                 // recycled timers
+} TimerWheel;
+
+#endif  // HW0_TIMERWHEEL_PRIV_H_
@@ -0,0 +1,617 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // for fdatasync, ftruncate, etc.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "WriteAheadLog.h"
+#include "WriteAheadLog_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+#define WAL_BUFFER_BYTES (64 * 1024)  // initial size of each record buffer
+
+// CRC-32C (Castagnoli), one table lookup per byte.
+static uint32_t crc_table[256];
+static pthread_once_t crc_table_once = PTHREAD_ONCE_INIT;
+
+static void BuildCRCTable(void) {
+  uint32_t i, bit;
+
+  for (i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) ? 0x82f63b78u : 0);
+    }
+    crc_table[i] = crc;
+  }
+}
+
+uint32_t WAL_CRC32C(uint32_t crc, const unsigned char *buf, size_t len) {
+  size_t i;
+
+  pthread_once(&crc_table_once, &BuildCRCTable);
+  crc = ~crc;
+  for (i = 0; i < len; i++) {
+    crc = crc_table[(crc ^ buf[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+// Writes all len bytes at buf to fd.  Returns false on error.
+static bool WriteAll(int fd, const unsigned char *buf, size_t len) {
+  while (len > 0) {
+    ssize_t n = write(fd, buf, len);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    buf += n;
+    len -= n;
+  }
+  return true;
+}
+
+// Fills in a file header.  The checkpoint's record count, if any, is
+// written by the caller.
+static void EncodeHeader(unsigned char *buf, uint32_t magic,
+                         uint64_t generation) {
+  uint32_t version = WAL_VERSION;
+
+  memcpy(buf, &magic, 4);
+  memcpy(buf + 4, &version, 4);
+  memcpy(buf + 8, &generation, 8);
+}
+
+// Checks a file header, returning its generation through *generation.
+static bool DecodeHeader(const unsigned char *buf, uint32_t magic,
+                         uint64_t *generation) {
+  uint32_t file_magic, version;
+
+  memcpy(&file_magic, buf, 4);
+  memcpy(&version, buf + 4, 4);
+  memcpy(generation, buf + 8, 8);
+  return file_magic == magic && version == WAL_VERSION;
+}
+
+// Returns the number of value bytes a record of the given type needs.
+static size_t ValueBytes(const WALCodec *codec, int type, HTValue_t value) {
+  if (type != WAL_RECORD_INSERT) {
+    return 0;
+  }
+  return codec != NULL ? codec->encoded_size(value) : sizeof(HTValue_t);
+}
+
+// Encodes a record into buf, which has room for WAL_RECORD_BYTES +
+// value_bytes bytes.
+static void EncodeRecord(unsigned char *buf, const WALCodec *codec,
+                         int type, HTKeyValue_t kv, size_t value_bytes) {
+  uint32_t len = (uint32_t) value_bytes, crc;
+
+  memcpy(buf + 4, &len, 4);
+  buf[8] = (unsigned char) type;
+  memcpy(buf + 9, &kv.key, 8);
+  if (value_bytes > 0) {
+    if (codec != NULL) {
+      codec->encode(kv.value, buf + WAL_RECORD_BYTES);
+    } else {
+      memcpy(buf + WAL_RECORD_BYTES, &kv.value, sizeof(HTValue_t));
+    }
+  }
+  crc = WAL_CRC32C(0, buf + 4, WAL_RECORD_BYTES - 4 + value_bytes);
+  memcpy(buf, &crc, 4);
+}
+
+// Frees a value that replay has dropped from the table.
+static void DropValue(const WALCodec *codec, HTValue_t value) {
+  if (codec != NULL && codec->free_value != NULL) {
+    codec->free_value(value);
+  }
+}
+
+// Applies the records in data[0..len) to table, stopping at the first
+// record that is truncated or fails its checksum.  Returns the number of
+// records applied, and the offset just past the last of them through
+// *good_len.
+static uint64_t ReplayRecords(HashTable *table, const WALCodec *codec,
+                              const unsigned char *data, size_t len,
+                              size_t *good_len) {
+  size_t off = 0;
+  uint64_t num_records = 0;
+
+  while (len - off >= WAL_RECORD_BYTES) {
+    const unsigned char *rec = data + off;
+    uint32_t crc, value_bytes;
+    HTKeyValue_t kv, old;
+
+    memcpy(&crc, rec, 4);
+    memcpy(&value_bytes, rec + 4, 4);
+    if (value_bytes > len - off - WAL_RECORD_BYTES ||
+        WAL_CRC32C(0, rec + 4, WAL_RECORD_BYTES - 4 + value_bytes) != crc) {
+      break;
+    }
+    memcpy(&kv.key, rec + 9, 8);
+
+    if (rec[8] == WAL_RECORD_INSERT) {
+      if (codec != NULL) {
+        kv.value = codec->decode(rec + WAL_RECORD_BYTES, value_bytes);
+      } else if (value_bytes == sizeof(HTValue_t)) {
+        memcpy(&kv.value, rec + WAL_RECORD_BYTES, sizeof(HTValue_t));
+      } else {
+        break;
+      }
+      if (HashTable_Insert(table, kv, &old)) {
+        DropValue(codec, old.value);
+      }
+    } else if (rec[8] == WAL_RECORD_REMOVE) {
+      if (HashTable_Remove(table, kv.key, &old)) {
+        DropValue(codec, old.value);
+      }
+    } else {
+      break;
+    }
+
+    off += WAL_RECORD_BYTES + value_bytes;
+    num_records += 1;
+  }
+
+  *good_len = off;
+  return num_records;
+}
+
+// Loads the checkpoint, if there is one, into wal->table, returning its
+// generation through *generation (0 if there is no checkpoint).  Returns
+// false if the checkpoint can't be read or is corrupt.
+static bool LoadCheckpoint(WriteAheadLog *wal, uint64_t *generation) {
+  struct stat st;
+  unsigned char *data;
+  uint64_t count;
+  size_t good_len;
+  bool ok;
+  int fd;
+
+  *generation = 0;
+  fd = open(wal->ckpt_path, O_RDONLY);
+  if (fd < 0) {
+    return errno == ENOENT;
+  }
+  if (fstat(fd, &st) != 0 || st.st_size < WAL_HEADER_BYTES + 8) {
+    close(fd);
+    return false;
+  }
+  data = (unsigned char *) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+                                fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  // The checkpoint was synced before it was renamed into place, so unlike
+  // the log, every record in it must be intact.
+  posix_madvise(data, st.st_size, POSIX_MADV_SEQUENTIAL);
+  ok = DecodeHeader(data, WAL_CKPT_MAGIC, generation);
+  memcpy(&count, data + WAL_HEADER_BYTES, 8);
+  ok = ok && ReplayRecords(wal->table, wal->codec,
+                           data + WAL_HEADER_BYTES + 8,
+                           st.st_size - WAL_HEADER_BYTES - 8,
+                           &good_len) == count &&
+       good_len == (size_t) st.st_size - WAL_HEADER_BYTES - 8;
+  munmap(data, st.st_size);
+  return ok;
+}
+
+// Empties the log file and starts it over at the given generation.
+static bool ResetLog(WriteAheadLog *wal, uint64_t generation) {
+  unsigned char header[WAL_HEADER_BYTES];
+
+  EncodeHeader(header, WAL_LOG_MAGIC, generation);
+  if (ftruncate(wal->fd, 0) != 0 ||
+      pwrite(wal->fd, header, WAL_HEADER_BYTES, 0) != WAL_HEADER_BYTES ||
+      lseek(wal->fd, WAL_HEADER_BYTES, SEEK_SET) != WAL_HEADER_BYTES ||
+      fdatasync(wal->fd) != 0) {
+    return false;
+  }
+  wal->generation = generation;
+  wal->log_bytes = WAL_HEADER_BYTES;
+  return true;
+}
+
+// Replays the log on top of the checkpoint (whose generation is
+// ckpt_generation) and leaves the file positioned for appending.
+static bool LoadLog(WriteAheadLog *wal, uint64_t ckpt_generation) {
+  unsigned char header[WAL_HEADER_BYTES];
+  unsigned char *data;
+  struct stat st;
+  size_t good_len;
+
+  if (fstat(wal->fd, &st) != 0) {
+    return false;
+  }
+
+  // A new log, or one the checkpoint already covers (we crashed before
+  // emptying it), just starts over.
+  if (st.st_size < WAL_HEADER_BYTES) {
+    return ResetLog(wal, ckpt_generation + 1);
+  }
+  if (pread(wal->fd, header, WAL_HEADER_BYTES, 0) != WAL_HEADER_BYTES ||
+      !DecodeHeader(header, WAL_LOG_MAGIC, &wal->generation)) {
+    return false;
+  }
+  if (wal->generation <= ckpt_generation) {
+    return ResetLog(wal, ckpt_generation + 1);
+  }
+
+  data = (unsigned char *) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+                                wal->fd, 0);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  posix_madvise(data, st.st_size, POSIX_MADV_SEQUENTIAL);
+  ReplayRecords(wal->table, wal->codec, data + WAL_HEADER_BYTES,
+                st.st_size - WAL_HEADER_BYTES, &good_len);
+  munmap(data, st.st_size);
+
+  // Cut off a torn tail so that new records follow the last good one.
+  wal->log_bytes = WAL_HEADER_BYTES + good_len;
+  if ((uint64_t) st.st_size != wal->log_bytes &&
+      (ftruncate(wal->fd, wal->log_bytes) != 0 ||
+       fdatasync(wal->fd) != 0)) {
+    return false;
+  }
+  return lseek(wal->fd, wal->log_bytes, SEEK_SET) == (off_t) wal->log_bytes;
+}
+
+// Appends a record to the buffer.  Called with the lock held.
+static void AppendRecord(WriteAheadLog *wal, int type, HTKeyValue_t kv) {
+  size_t value_bytes = ValueBytes(wal->codec, type, kv.value);
+  size_t len = WAL_RECORD_BYTES + value_bytes;
+
+  if (wal->buf_len + len > wal->buf_cap) {
+    // Hand the full buffer to the kernel, unless a commit is writing the
+    // file right now; then we grow the buffer instead, to keep the records
+    // in order.
+    if (!wal->syncing && wal->buf_len > 0) {
+      if (!WriteAll(wal->fd, wal->buf, wal->buf_len)) {
+        wal->failed = true;
+      }
+      wal->buf_len = 0;
+    }
+    if (wal->buf_len + len > wal->buf_cap) {
+      size_t cap = 2 * wal->buf_cap;
+      unsigned char *buf;
+
+      while (cap < wal->buf_len + len) {
+        cap *= 2;
+      }
+      buf = (unsigned char *) realloc(wal->buf, cap);
+      if (buf == NULL) {
+        wal->failed = true;
+        return;
+      }
+      wal->buf = buf;
+      wal->buf_cap = cap;
+    }
+  }
+
+  EncodeRecord(wal->buf + wal->buf_len, wal->codec, type, kv, value_bytes);
+  wal->buf_len += len;
+  wal->log_bytes += len;
+  wal->appended += 1;
+}
+
+// Commits every record appended so far.  Called with the lock held, which
+// is released while we write and sync.
+static bool CommitLocked(WriteAheadLog *wal) {
+  uint64_t target = wal->appended;
+
+  while (!wal->failed && wal->durable < target) {
+    unsigned char *batch;
+    size_t batch_len, cap;
+    uint64_t batch_records;
+    bool ok;
+
+    // Somebody else is committing; their commit may well cover our
+    // records, so wait for it and check again.
+    if (wal->syncing) {
+      pthread_cond_wait(&wal->synced, &wal->lock);
+      continue;
+    }
+
+    // Take the buffer, so others can append while we write it.
+    batch = wal->buf;
+    batch_len = wal->buf_len;
+    cap = wal->buf_cap;
+    batch_records = wal->appended;
+    wal->buf = wal->spare;
+    wal->buf_cap = wal->spare_cap;
+    wal->buf_len = 0;
+    wal->spare = batch;
+    wal->spare_cap = cap;
+    wal->syncing = true;
+
+    pthread_mutex_unlock(&wal->lock);
+    ok = WriteAll(wal->fd, batch, batch_len) && fdatasync(wal->fd) == 0;
+    pthread_mutex_lock(&wal->lock);
+
+    wal->syncing = false;
+    if (ok) {
+      wal->durable = batch_records;
+    } else {
+      wal->failed = true;
+    }
+    pthread_cond_broadcast(&wal->synced);
+  }
+  return !wal->failed;
+}
+
+// Fsyncs the directory holding path, so that a rename into it is durable.
+static bool SyncParentDir(const char *path) {
+  const char *slash = strrchr(path, '/');
+  char *dir;
+  bool ok;
+  int fd;
+
+  if (slash == NULL) {
+    dir = strdup(".");
+  } else if (slash == path) {
+    dir = strdup("/");
+  } else {
+    dir = strndup(path, slash - path);
+  }
+  if (dir == NULL) {
+    return false;
+  }
+  fd = open(dir, O_RDONLY);
+  free(dir);
+  if (fd < 0) {
+    return false;
+  }
+  ok = (fsync(fd) == 0);
+  close(fd);
+  return ok;
+}
+
+// Writes kvs[0..n), last first, to a new checkpoint file at path.
+// Multimap runs are newest-first, so writing them backwards means that
+// replay recreates them in the same order.
+static bool WriteCheckpoint(WriteAheadLog *wal, const char *path,
+                            HTKeyValue_t *kvs, int n) {
+  unsigned char *buf;
+  size_t cap = WAL_BUFFER_BYTES, len = WAL_HEADER_BYTES + 8;
+  uint64_t count = n;
+  bool ok = true;
+  int fd, i;
+
+  buf = (unsigned char *) malloc(cap);
+  if (buf == NULL) {
+    return false;
+  }
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    free(buf);
+    return false;
+  }
+
+  EncodeHeader(buf, WAL_CKPT_MAGIC, wal->generation);
+  memcpy(buf + WAL_HEADER_BYTES, &count, 8);
+  for (i = n - 1; ok && i >= 0; i--) {
+    size_t value_bytes = ValueBytes(wal->codec, WAL_RECORD_INSERT,
+                                    kvs[i].value);
+    size_t rec_len = WAL_RECORD_BYTES + value_bytes;
+
+    if (len + rec_len > cap) {
+      ok = WriteAll(fd, buf, len);
+      len = 0;
+      if (rec_len > cap) {
+        unsigned char *bigger = (unsigned char *) realloc(buf, rec_len);
+        ok = ok && (bigger != NULL);
+        if (bigger != NULL) {
+          buf = bigger;
+          cap = rec_len;
+        }
+      }
+      if (!ok) break;
+    }
+    EncodeRecord(buf + len, wal->codec, WAL_RECORD_INSERT, kvs[i],
+                 value_bytes);
+    len += rec_len;
+  }
+
+  ok = ok && WriteAll(fd, buf, len) && fsync(fd) == 0;
+  ok = (close(fd) == 0) && ok;
+  free(buf);
+  return ok;
+}
+
+// Takes a checkpoint.  Called with the lock held.
+static bool CheckpointLocked(WriteAheadLog *wal) {
+  HTKeyValue_t *kvs = NULL;
+  char *tmp_path;
+  int n;
+  bool ok;
+
+  // A commit in flight is still writing the log; let it finish.
+  while (wal->syncing) {
+    pthread_cond_wait(&wal->synced, &wal->lock);
+  }
+
+  n = HashTable_SortedSnapshot(wal->table, &kvs, 1);
+  if (n < 0) {
+    return false;
+  }
+  tmp_path = (char *) malloc(strlen(wal->ckpt_path) + 5);
+  if (tmp_path == NULL) {
+    free(kvs);
+    return false;
+  }
+  sprintf(tmp_path, "%s.tmp", wal->ckpt_path);
+
+  // Write the new checkpoint beside the old one, then rename it into place
+  // so that there is always exactly one complete checkpoint on disk.
+  ok = WriteCheckpoint(wal, tmp_path, kvs, n) &&
+       rename(tmp_path, wal->ckpt_path) == 0 &&
+       SyncParentDir(wal->ckpt_path);
+  free(kvs);
+  if (!ok) {
+    unlink(tmp_path);
+    free(tmp_path);
+    return false;
+  }
+  free(tmp_path);
+
+  // The checkpoint now covers everything, buffered records included.  If
+  // emptying the log fails, the next open sees that the checkpoint covers
+  // its generation and ignores it.
+  wal->buf_len = 0;
+  wal->durable = wal->appended;
+  wal->failed = !ResetLog(wal, wal->generation + 1);
+  pthread_cond_broadcast(&wal->synced);
+  return !wal->failed;
+}
+
+// Frees a log's memory (but not its table) and closes its file.
+static void FreeLog(WriteAheadLog *wal) {
+  if (wal->fd >= 0) {
+    close(wal->fd);
+  }
+  pthread_cond_destroy(&wal->synced);
+  pthread_mutex_destroy(&wal->lock);
+  free(wal->log_path);
+  free(wal->ckpt_path);
+  free(wal->buf);
+  free(wal->spare);
+  free(wal);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// WriteAheadLog implementation.
+
+WriteAheadLog* WriteAheadLog_Open(const char *path,
+                                  HashTable *table,
+                                  const WALCodec *codec,
+                                  uint64_t checkpoint_bytes) {
+  WriteAheadLog *wal;
+  uint64_t ckpt_generation;
+
+  wal = (WriteAheadLog *) calloc(1, sizeof(WriteAheadLog));
+  if (wal == NULL) {
+    return NULL;
+  }
+  pthread_mutex_init(&wal->lock, NULL);
+  pthread_cond_init(&wal->synced, NULL);
+  wal->fd = -1;
+  wal->table = table;
+  wal->codec = codec;
+  wal->checkpoint_bytes = checkpoint_bytes;
+  wal->log_path = strdup(path);
+  wal->ckpt_path = (char *) malloc(strlen(path) + 6);
+  wal->buf = (unsigned char *) malloc(WAL_BUFFER_BYTES);
+  wal->spare = (unsigned char *) malloc(WAL_BUFFER_BYTES);
+  if (wal->log_path == NULL || wal->ckpt_path == NULL ||
+      wal->buf == NULL || wal->spare == NULL) {
+    FreeLog(wal);
+    return NULL;
+  }
+  sprintf(wal->ckpt_path, "%s.ckpt", path);
+  wal->buf_cap = WAL_BUFFER_BYTES;
+  wal->spare_cap = WAL_BUFFER_BYTES;
+
+  if (!LoadCheckpoint(wal, &ckpt_generation)) {
+    FreeLog(wal);
+    return NULL;
+  }
+  wal->fd = open(wal->log_path, O_RDWR | O_CREAT, 0644);
+  if (wal->fd < 0 || !LoadLog(wal, ckpt_generation)) {
+    FreeLog(wal);
+    return NULL;
+  }
+  return wal;
+}
+
+bool WriteAheadLog_Close(WriteAheadLog *wal) {
+  bool ok;
+
+  pthread_mutex_lock(&wal->lock);
+  ok = CommitLocked(wal);
+  pthread_mutex_unlock(&wal->lock);
+
+  FreeLog(wal);
+  return ok;
+}
+
+bool WriteAheadLog_Insert(WriteAheadLog *wal,
+                          HTKeyValue_t newkeyvalue,
+                          HTKeyValue_t *oldkeyvalue) {
+  bool replaced;
+
+  pthread_mutex_lock(&wal->lock);
+  replaced = HashTable_Insert(wal->table, newkeyvalue, oldkeyvalue);
+  AppendRecord(wal, WAL_RECORD_INSERT, newkeyvalue);
+  pthread_mutex_unlock(&wal->lock);
+  return replaced;
+}
+
+bool WriteAheadLog_Remove(WriteAheadLog *wal,
+                          HTKey_t key,
+                          HTKeyValue_t *keyvalue) {
+  bool removed;
+
+  pthread_mutex_lock(&wal->lock);
+  removed = HashTable_Remove(wal->table, key, keyvalue);
+  if (removed) {
+    AppendRecord(wal, WAL_RECORD_REMOVE, *keyvalue);
+  }
+  pthread_mutex_unlock(&wal->lock);
+  return removed;
+}
+
+bool WriteAheadLog_Commit(WriteAheadLog *wal) {
+  bool ok;
+
+  pthread_mutex_lock(&wal->lock);
+  ok = CommitLocked(wal);
+  if (ok && wal->checkpoint_bytes > 0 &&
+      wal->log_bytes >= wal->checkpoint_bytes) {
+    ok = CheckpointLocked(wal);
+  }
+  pthread_mutex_unlock(&wal->lock);
+  return ok;
+}
+
+bool WriteAheadLog_Checkpoint(WriteAheadLog *wal) {
+  bool ok;
+
+  pthread_mutex_lock(&wal->lock);
+  ok = CheckpointLocked(wal);
+  pthread_mutex_unlock(&wal->lock);
+  return ok;
+}
+
+uint64_t WriteAheadLog_NumBytes(WriteAheadLog *wal) {
+  uint64_t num_bytes;
+
+  pthread_mutex_lock(&wal->lock);
+  num_bytes = wal->log_bytes;
+  pthread_mutex_unlock(&wal->lock);
+  return num_bytes;
+}
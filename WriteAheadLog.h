@@ -0,0 +1,121 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_WRITEAHEADLOG_H_
+#define HW0_WRITEAHEADLOG_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stddef.h>     // for size_t
+#include <stdint.h>     // for uint64_t, etc.
+
+#include "./HashTable.h"  // for HashTable, HTKeyValue_t, etc.
+
+///////////////////////////////////////////////////////////////////////////////
+// A WriteAheadLog makes a HashTable durable.  Customers route their inserts
+// and removes through the log, which applies them to the table and appends
+// a small binary record of each one to a local file.  On startup,
+// WriteAheadLog_Open loads the most recent checkpoint and replays the log
+// on top of it, rebuilding the table.
+//
+// Records are buffered in memory and written with one write and one
+// fdatasync per commit.  Commits are grouped: when several threads commit
+// at once, one of them syncs everything appended so far on behalf of all
+// of them, and the others just wait for it.
+//
+// A checkpoint writes the whole table to a snapshot file, atomically
+// replaces the previous snapshot, and empties the log, so replay time stays
+// bounded by the amount of churn since the last checkpoint.
+//
+// The log protects the table with a mutex, so several threads may mutate
+// the table through the log at once.  Customers who read the table
+// directly must not race with those mutations.  TTLs are not logged.
+//
+// As with HashTable, we declare the "struct wal" structure here but
+// *define* it in the internal header WriteAheadLog_priv.h.
+typedef struct wal WriteAheadLog;
+
+// Describes how to turn values into bytes and back.  Pass NULL for the
+// codec to store each value's bits as-is (eg, if values are integers cast
+// to HTValue_t).
+typedef struct {
+  // Returns the number of bytes needed to encode value.
+  size_t    (*encoded_size)(HTValue_t value);
+
+  // Encodes value into buf, which has room for encoded_size(value) bytes.
+  void      (*encode)(HTValue_t value, unsigned char *buf);
+
+  // Returns a newly allocated value decoded from len bytes at buf.
+  HTValue_t (*decode)(const unsigned char *buf, size_t len);
+
+  // Frees values that replay replaces or removes; may be NULL.
+  ValueFreeFnPtr free_value;
+} WALCodec;
+
+// Opens (or creates) the log at path and rebuilds table from it.
+//
+// The log lives in the file path, and checkpoints in path.ckpt.  A record
+// torn by a crash (or otherwise failing its checksum) at the end of the
+// log is discarded, along with anything after it.
+//
+// Arguments:
+// - path: where to keep the log.
+// - table: an empty table to rebuild into, which the log then mutates.
+//   The log doesn't own the table; free it after closing the log.
+// - codec: how to encode values; see above.  It must outlive the log.
+// - checkpoint_bytes: once a commit leaves the log at least this large, a
+//   checkpoint is taken automatically.  0 means only checkpoint when
+//   WriteAheadLog_Checkpoint is called.
+//
+// Returns NULL on error (an I/O error, a corrupt checkpoint, or out of
+// memory), non-NULL on success.
+WriteAheadLog* WriteAheadLog_Open(const char *path,
+                                  HashTable *table,
+                                  const WALCodec *codec,
+                                  uint64_t checkpoint_bytes);
+
+// Commits anything outstanding, closes the log's files and frees the log.
+//
+// Returns false if the final commit failed.
+bool WriteAheadLog_Close(WriteAheadLog *wal);
+
+// Inserts into the log's table, exactly as HashTable_Insert, and appends a
+// record of the insert to the log.  The insert is not durable until the
+// next successful WriteAheadLog_Commit.
+bool WriteAheadLog_Insert(WriteAheadLog *wal,
+                          HTKeyValue_t newkeyvalue,
+                          HTKeyValue_t *oldkeyvalue);
+
+// Removes from the log's table, exactly as HashTable_Remove, and appends a
+// record of the removal to the log.  The removal is not durable until the
+// next successful WriteAheadLog_Commit.
+bool WriteAheadLog_Remove(WriteAheadLog *wal,
+                          HTKey_t key,
+                          HTKeyValue_t *keyvalue);
+
+// Makes every mutation appended before this call durable.
+//
+// Returns false on error (an earlier append ran out of memory, or a write
+// or sync failed).  Once a commit has failed, the log stays failed until a
+// checkpoint succeeds (or the log is closed and reopened).
+bool WriteAheadLog_Commit(WriteAheadLog *wal);
+
+// Writes the table to a new checkpoint and empties the log.  This also
+// makes every mutation so far durable.
+//
+// Returns false on error, in which case the previous checkpoint and the
+// log are still intact.
+bool WriteAheadLog_Checkpoint(WriteAheadLog *wal);
+
+// Returns the size of the log file, in bytes, including records that are
+// still buffered.
+uint64_t WriteAheadLog_NumBytes(WriteAheadLog *wal);
+
+#endif  // HW0_WRITEAHEADLOG_H_
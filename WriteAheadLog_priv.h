@@ -0,0 +1,87 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_WRITEAHEADLOG_PRIV_H_
+#define HW0_WRITEAHEADLOG_PRIV_H_
+
+#include <stdint.h>   // for uint64_t, etc.
+#include <pthread.h>  // for pthread_mutex_t, etc.
+
+#include "./WriteAheadLog.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our WriteAheadLog
+// implementation.
+//
+// These would typically be located in WriteAheadLog.c; however, we have
+// broken them out into a "private .h" so that our unittests can access them.
+//
+// Customers should not include this file or assume anything based on
+// its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// On-disk format.  All integers are in host byte order; the files are only
+// meant to be read back on the machine that wrote them.
+//
+// Both files start with a 16-byte header: a 4-byte magic number, a 4-byte
+// version, and an 8-byte generation number.  The checkpoint header is
+// followed by an 8-byte count of records.  The log's generation goes up by
+// one each time a checkpoint empties it, and a checkpoint's generation is
+// that of the log it replaced, so after a crash between the two steps we
+// can tell that the log is already covered by the checkpoint.
+//
+// After the headers, both files hold records:
+//
+//   crc32c (4) | value length (4) | type (1) | key (8) | value bytes
+//
+// where the checksum covers everything after itself.
+#define WAL_LOG_MAGIC      0x474c5448u  // "HTLG"
+#define WAL_CKPT_MAGIC     0x4b435448u  // "HTCK"
+#define WAL_VERSION        1
+#define WAL_HEADER_BYTES   16
+#define WAL_RECORD_BYTES   17           // record bytes before the value
+#define WAL_RECORD_INSERT  1
+#define WAL_RECORD_REMOVE  2
+
+// The write-ahead log.
+//
+// Records are appended to buf.  A commit swaps buf with spare, so that
+// other threads can keep appending while the committing thread writes and
+// syncs spare with the mutex released.  While a commit is in flight
+// (syncing is true), nobody else writes to the file; an appender that
+// fills buf just grows it.
+typedef struct wal {
+  pthread_mutex_t  lock;             // protects everything below
+  pthread_cond_t   synced;           // broadcast when a commit finishes
+  HashTable       *table;            // the table we keep durable
+  const WALCodec  *codec;            // value codec, or NULL
+  char            *log_path;         // path of the log file
+  char            *ckpt_path;        // path of the checkpoint file
+  int              fd;               // the log file
+  uint64_t         generation;       // the log file's generation
+  uint64_t         log_bytes;        // file size plus buffered bytes
+  uint64_t         checkpoint_bytes; // auto-checkpoint threshold, or 0
+  unsigned char   *buf;              // records not yet handed to write()
+  size_t           buf_len;
+  size_t           buf_cap;
+  unsigned char   *spare;            // the other buffer (see above)
+  size_t           spare_cap;
+  uint64_t         appended;         // # of records appended
+  uint64_t         durable;          // # of those known to be synced
+  bool             syncing;          // is a commit writing the file?
+  bool             failed;           // has an append or commit failed?
+} WriteAheadLog;
+
+// Computes the CRC-32C of len bytes at buf, continuing from crc (pass 0 to
+// start).
+uint32_t WAL_CRC32C(uint32_t crc, const unsigned char *buf, size_t len);
+
+#endif  // HW0_WRITEAHEADLOG_PRIV_H_
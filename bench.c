@@ -0,0 +1,1194 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+// Benchmark driver for the containers in this directory.
+//
+// Usage: ./bench [workload [n]]
+//
+// With no arguments, every workload is run at its default size.  Each
+// workload prints one line per configuration it measures.
+
+#define _GNU_SOURCE  // for mallinfo2
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "LinkedList.h"
+#include "HashTable.h"
+#include "CompactHashTable.h"
+#include "CuckooHashTable.h"
+#include "HashSet.h"
+#include "FrozenHashTable.h"
+#include "ConcurrentQueue.h"
+#include "SkipList.h"
+#include "PersistentHashTable.h"
+#include "LatencyStats.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Helpers.
+
+// Returns the number of bytes currently allocated from the malloc heap
+// (including mmap'd blocks).
+static size_t HeapInUse(void) {
+  struct mallinfo2 mi = mallinfo2();
+  return mi.uordblks + mi.hblkhd;
+}
+
+// Returns the current time in seconds, for timing workloads.
+static double NowSeconds(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Hardware performance counters.
+//
+// A PerfCounters counts a fixed set of this thread's user-mode events
+// around a phase of a workload, through perf_event_open.  Events the
+// system won't let us count (eg, in a VM without a PMU, or with
+// perf_event_paranoid set too high) are reported as n/a.  When there are
+// more events than hardware counters, the kernel time-slices them, and we
+// scale each count up by the fraction of the phase it was counted for.
+
+#define PERF_HW_CACHE(cache) \
+  ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | \
+   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+// The events we count, in report order.
+enum {
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_L1D_MISSES,
+  PERF_LLC_MISSES,
+  PERF_DTLB_MISSES,
+  PERF_BRANCH_MISSES,
+  PERF_NUM_EVENTS
+};
+
+static const struct {
+  const char *name;    // column heading
+  uint32_t    type;    // perf_event_attr.type
+  uint64_t    config;  // perf_event_attr.config
+} kPerfEvents[PERF_NUM_EVENTS] = {
+  { "cycles",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+  { "instrs",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+  { "L1d-miss", PERF_TYPE_HW_CACHE, PERF_HW_CACHE(PERF_COUNT_HW_CACHE_L1D) },
+  { "LLC-miss", PERF_TYPE_HW_CACHE, PERF_HW_CACHE(PERF_COUNT_HW_CACHE_LL) },
+  { "dTLB-miss", PERF_TYPE_HW_CACHE,
+    PERF_HW_CACHE(PERF_COUNT_HW_CACHE_DTLB) },
+  { "br-miss",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+typedef struct {
+  int    fds[PERF_NUM_EVENTS];     // -1 if the event isn't available
+  double counts[PERF_NUM_EVENTS];  // from the last PerfStop
+} PerfCounters;
+
+// Opens the counters, initially stopped.
+static void PerfOpen(PerfCounters *pc) {
+  struct perf_event_attr attr;
+  int e;
+
+  for (e = 0; e < PERF_NUM_EVENTS; e++) {
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = kPerfEvents[e].type;
+    attr.config = kPerfEvents[e].config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    pc->fds[e] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    pc->counts[e] = 0;
+  }
+}
+
+static void PerfClose(PerfCounters *pc) {
+  int e;
+
+  for (e = 0; e < PERF_NUM_EVENTS; e++) {
+    if (pc->fds[e] >= 0) {
+      close(pc->fds[e]);
+    }
+  }
+}
+
+// Zeroes the counters and starts counting.
+static void PerfStart(PerfCounters *pc) {
+  int e;
+
+  for (e = 0; e < PERF_NUM_EVENTS; e++) {
+    if (pc->fds[e] >= 0) {
+      ioctl(pc->fds[e], PERF_EVENT_IOC_RESET, 0);
+      ioctl(pc->fds[e], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+}
+
+// Stops counting, and reads the counts into pc->counts.
+static void PerfStop(PerfCounters *pc) {
+  uint64_t buf[3];  // value, time enabled, time running
+  int e;
+
+  for (e = 0; e < PERF_NUM_EVENTS; e++) {
+    if (pc->fds[e] >= 0) {
+      ioctl(pc->fds[e], PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+  for (e = 0; e < PERF_NUM_EVENTS; e++) {
+    pc->counts[e] = 0;
+    if (pc->fds[e] < 0 ||
+        read(pc->fds[e], buf, sizeof(buf)) != sizeof(buf)) {
+      continue;
+    }
+    pc->counts[e] = (double) buf[0];
+    if (buf[2] > 0 && buf[2] < buf[1]) {
+      pc->counts[e] *= (double) buf[1] / buf[2];
+    }
+  }
+}
+
+// Prints one line for a phase of num_ops operations that took secs
+// seconds: the time and each event per operation.
+static void PerfReport(PerfCounters *pc, const char *workload, int n,
+                       const char *op, int num_ops, double secs) {
+  int e;
+
+  printf("%s n=%d %-12s %8.1f ns/op", workload, n, op,
+         secs * 1e9 / num_ops);
+  for (e = 0; e < PERF_NUM_EVENTS; e++) {
+    if (pc->fds[e] >= 0) {
+      printf("  %s %7.2f", kPerfEvents[e].name, pc->counts[e] / num_ops);
+    } else {
+      printf("  %s n/a", kPerfEvents[e].name);
+    }
+  }
+  if (pc->fds[PERF_CYCLES] >= 0 && pc->fds[PERF_INSTRUCTIONS] >= 0 &&
+      pc->counts[PERF_CYCLES] > 0) {
+    printf("  IPC %.2f",
+           pc->counts[PERF_INSTRUCTIONS] / pc->counts[PERF_CYCLES]);
+  }
+  printf("\n");
+}
+
+// Returns the value of a "Field:  N kB" line in /proc/self/smaps_rollup,
+// in kB, or -1 if it isn't there.
+static long SmapsKB(const char *field) {
+  FILE *f = fopen("/proc/self/smaps_rollup", "r");
+  size_t len = strlen(field);
+  char line[256];
+  long kb = -1;
+
+  if (f == NULL) {
+    return -1;
+  }
+  while (fgets(line, sizeof(line), f) != NULL) {
+    if (strncmp(line, field, len) == 0 && line[len] == ':') {
+      kb = strtol(line + len + 1, NULL, 10);
+      break;
+    }
+  }
+  fclose(f);
+  return kb;
+}
+
+// A fast, deterministic key sequence: the i'th output of a 64-bit mixer.
+static uint64_t BenchKey(uint64_t i) {
+  i += 0x9e3779b97f4a7c15ULL;
+  i = (i ^ (i >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  i = (i ^ (i >> 27)) * 0x94d049bb133111ebULL;
+  return i ^ (i >> 31);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Workloads.
+
+// Bytes per entry of a HashTable vs. a CompactHashTable holding n entries.
+static void BenchMemory(int n) {
+  HashTable *ht;
+  CompactHashTable *cht;
+  HTKeyValue_t kv, old;
+  size_t before, ht_bytes, cht_bytes;
+  int i;
+
+  before = HeapInUse();
+  ht = HashTable_Allocate(2);
+  for (i = 0; i < n; i++) {
+    kv.key = BenchKey(i);
+    kv.value = (HTValue_t) (uintptr_t) i;
+    HashTable_Insert(ht, kv, &old);
+  }
+  ht_bytes = HeapInUse() - before;
+  HashTable_Free(ht, NULL);
+
+  before = HeapInUse();
+  cht = CompactHashTable_Allocate(0);
+  for (i = 0; i < n; i++) {
+    kv.key = BenchKey(i);
+    kv.value = (HTValue_t) (uintptr_t) i;
+    CompactHashTable_Insert(cht, kv, &old);
+  }
+  cht_bytes = HeapInUse() - before;
+  CompactHashTable_Free(cht, NULL);
+
+  printf("memory n=%d HashTable=%.1f B/entry CompactHashTable=%.1f B/entry "
+         "ratio=%.2fx\n", n, (double) ht_bytes / n, (double) cht_bytes / n,
+         (double) ht_bytes / (double) cht_bytes);
+}
+
+
+// Join output function for BenchJoin; the result count comes back from
+// HashTable_Join, so there's nothing to do.
+static void JoinNoOp(const HTKeyValue_t *left, const HTKeyValue_t *right,
+                     void *arg) {
+}
+
+// Joining two n-entry tables that share half their keys: probing one
+// table's chains for each entry of the other, vs. HashTable_Join.
+static void BenchJoin(int n) {
+  HashTable *left = HashTable_Allocate(2), *right = HashTable_Allocate(2);
+  HTKeyValue_t kv, old;
+  HTIterator *iter;
+  int64_t matches = 0;
+  double start;
+  int i, threads;
+
+  for (i = 0; i < n; i++) {
+    kv.key = BenchKey(i);
+    kv.value = (HTValue_t) (uintptr_t) i;
+    HashTable_Insert(left, kv, &old);
+    kv.key = BenchKey(i + n / 2);
+    HashTable_Insert(right, kv, &old);
+  }
+
+  start = NowSeconds();
+  iter = HTIterator_Allocate(left);
+  while (HTIterator_IsValid(iter)) {
+    HTKeyValue_t found;
+
+    HTIterator_Get(iter, &kv);
+    matches += HashTable_Find(right, kv.key, &found);
+    HTIterator_Next(iter);
+  }
+  HTIterator_Free(iter);
+  printf("join n=%d iterate+find matches=%lld %.3fs\n", n,
+         (long long) matches, NowSeconds() - start);
+
+  for (threads = 1; threads <= 8; threads *= 2) {
+    start = NowSeconds();
+    matches = HashTable_Join(left, right, &JoinNoOp, NULL, threads);
+    printf("join n=%d HashTable_Join threads=%d matches=%lld %.3fs\n", n,
+           threads, (long long) matches, NowSeconds() - start);
+  }
+
+  HashTable_Free(left, NULL);
+  HashTable_Free(right, NULL);
+}
+
+
+// Latency percentiles for n inserts into a growing table, then n finds
+// and n removes.  Inserts that resize the table are reported separately.
+static void BenchLatency(int n) {
+  HashTable *table = HashTable_Allocate(2);
+  HTKeyValue_t kv, old;
+  int i, op;
+
+  LatencyStats_Reset();
+  LatencyStats_Enable(true);
+  for (i = 0; i < n; i++) {
+    kv.key = BenchKey(i);
+    kv.value = (HTValue_t) (uintptr_t) i;
+    HashTable_Insert(table, kv, &old);
+  }
+  for (i = 0; i < n; i++) {
+    HashTable_Find(table, BenchKey(i), &kv);
+  }
+  for (i = 0; i < n; i++) {
+    HashTable_Remove(table, BenchKey(i), &kv);
+  }
+  LatencyStats_Enable(false);
+
+  for (op = LAT_HT_INSERT; op <= LAT_HT_REMOVE; op++) {
+    LatencySummary summary;
+
+    LatencyStats_Summarize((LatencyOp) op, &summary);
+    printf("latency n=%d %-26s count=%-8llu p50=%.0fns p99=%.0fns "
+           "p99.9=%.0fns max=%.0fns\n", n, LatencyStats_OpName(op),
+           (unsigned long long) summary.count, summary.p50, summary.p99,
+           summary.p999, summary.max);
+  }
+  HashTable_Free(table, NULL);
+}
+
+
+// Runs n queue operations (Append, then Pop) and n stack operations
+// (Push, then Pop) against list, keeping about 1000 elements in it, then
+// iterates over it; prints the throughput of each.
+static void RunDequeTraffic(const char *name, LinkedList *list, int n) {
+  LLPayload_t payload;
+  LLIterator *iter;
+  uintptr_t sum = 0;
+  double start;
+  int i;
+
+  for (i = 0; i < 1000; i++) {
+    LinkedList_Append(list, (LLPayload_t) (uintptr_t) i);
+  }
+
+  start = NowSeconds();
+  for (i = 0; i < n; i++) {
+    LinkedList_Append(list, (LLPayload_t) (uintptr_t) i);
+    LinkedList_Pop(list, &payload);
+  }
+  printf("deque n=%d %-10s queue   %6.1f Mops/s\n", n, name,
+         2 * n / (NowSeconds() - start) / 1e6);
+
+  start = NowSeconds();
+  for (i = 0; i < n; i++) {
+    LinkedList_Push(list, (LLPayload_t) (uintptr_t) i);
+    LinkedList_Pop(list, &payload);
+  }
+  printf("deque n=%d %-10s stack   %6.1f Mops/s\n", n, name,
+         2 * n / (NowSeconds() - start) / 1e6);
+
+  for (i = 0; i < n / 10; i++) {
+    LinkedList_Append(list, (LLPayload_t) (uintptr_t) i);
+  }
+  start = NowSeconds();
+  iter = LLIterator_Allocate(list);
+  while (LLIterator_IsValid(iter)) {
+    LLIterator_Get(iter, &payload);
+    sum += (uintptr_t) payload;
+    LLIterator_Next(iter);
+  }
+  LLIterator_Free(iter);
+  printf("deque n=%d %-10s iterate %6.1f Melem/s (sum %lu)\n", n, name,
+         LinkedList_NumElements(list) / (NowSeconds() - start) / 1e6,
+         (unsigned long) sum);
+}
+
+static void NoOpFree(LLPayload_t payload) {
+}
+
+// Queue and stack traffic through the node-based list vs. the ring.
+static void BenchDeque(int n) {
+  LinkedList *list;
+
+  list = LinkedList_Allocate();
+  RunDequeTraffic("nodes", list, n);
+  LinkedList_Free(list, &NoOpFree);
+
+  list = LinkedList_AllocateRing();
+  RunDequeTraffic("ring", list, n);
+  LinkedList_Free(list, &NoOpFree);
+}
+
+
+// Fills a table to pct percent of capacity entries, then times the inserts
+// and finds (and, in a second pass, each find's latency).
+static void RunLoadedTable(const char *name, HashTable *table,
+                           int capacity, int pct) {
+  int i, n = (int) ((int64_t) capacity * pct / 100);
+  HTKeyValue_t kv, old;
+  LatencySummary summary;
+  double insert_secs, find_secs;
+
+  insert_secs = NowSeconds();
+  for (i = 0; i < n; i++) {
+    kv.key = BenchKey(i);
+    kv.value = (HTValue_t) (uintptr_t) i;
+    HashTable_Insert(table, kv, &old);
+  }
+  insert_secs = NowSeconds() - insert_secs;
+
+  find_secs = NowSeconds();
+  for (i = 0; i < n; i++) {
+    HashTable_Find(table, BenchKey(i), &kv);
+  }
+  find_secs = NowSeconds() - find_secs;
+
+  LatencyStats_Reset();
+  LatencyStats_Enable(true);
+  for (i = 0; i < n; i++) {
+    HashTable_Find(table, BenchKey(i), &kv);
+  }
+  LatencyStats_Enable(false);
+  LatencyStats_Summarize(LAT_HT_FIND, &summary);
+
+  printf("cuckoo cap=%d load=%d%% %-8s insert %6.1f Mops/s  find %6.1f "
+         "Mops/s  p99=%.0fns p99.9=%.0fns max=%.0fns\n", capacity, pct,
+         name, n / insert_secs / 1e6, n / find_secs / 1e6, summary.p99,
+         summary.p999, summary.max);
+}
+
+// Chained vs. cuckoo tables of the same fixed capacity, at increasing
+// load.  The chained table is sized so that it doesn't resize below 100%.
+static void BenchCuckoo(int n) {
+  static const int kLoads[] = { 50, 75, 90, 95 };
+  HTKeyValue_t kv, old;
+  int i, j, capacity;
+
+  for (j = 0; j < (int) (sizeof(kLoads) / sizeof(kLoads[0])); j++) {
+    CuckooHashTable *cuckoo = CuckooHashTable_Allocate(n);
+    HashTable *table;
+
+    capacity = CuckooHashTable_Capacity(cuckoo);
+
+    table = HashTable_Allocate(capacity / 3 + 1);
+    RunLoadedTable("chained", table, capacity, kLoads[j]);
+    HashTable_Free(table, NULL);
+
+    table = HashTable_AllocateWithFlags(n, HT_FLAG_CUCKOO);
+    RunLoadedTable("cuckoo", table, capacity, kLoads[j]);
+    HashTable_Free(table, NULL);
+
+    // The same keys again, straight into a CuckooHashTable, to see how
+    // many ended up in the stash.
+    for (i = 0; i < (int) ((int64_t) capacity * kLoads[j] / 100); i++) {
+      kv.key = BenchKey(i);
+      kv.value = NULL;
+      CuckooHashTable_Insert(cuckoo, kv, &old);
+    }
+    printf("cuckoo cap=%d load=%d%% stashed=%d\n", capacity, kLoads[j],
+           CuckooHashTable_NumStashed(cuckoo));
+    CuckooHashTable_Free(cuckoo, NULL);
+  }
+}
+
+
+// Inverts HTMix64, the unkeyed mixer bucket choices used to be based on:
+// given any desired mix output, returns the key that produces it.
+static uint64_t UnMix64(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0x9cb4b2f8129337dbULL;
+  h ^= h >> 33;
+  h *= 0x4f74430c22a54005ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// Key sets for BenchFlood.  "modulo" keys are all multiples of every
+// bucket count a table started at 100 buckets reaches (100 * 9^k), so they
+// shared one chain when the bucket was key % num_buckets.  "mix" keys
+// all have HTMix64 outputs whose low 48 bits are zero, so they shared a
+// chain (and a fingerprint) when buckets came from HTMix64, and shared a
+// cuckoo bucket pair until the table had 2^16 buckets.
+static uint64_t FloodKey(int set, int i) {
+  switch (set) {
+    case 0:  return BenchKey(i);
+    case 1:  return (uint64_t) (i + 1) * 53144100;  // 100 * 9^6
+    default: return UnMix64((uint64_t) (i + 1) << 48);
+  }
+}
+
+// Replays adversarial key sets into chained and cuckoo tables, reporting
+// throughput, the longest chain, and the cuckoo table's final size.
+static void BenchFlood(int n) {
+  static const char *kSets[] = { "random", "modulo", "mix" };
+  HTKeyValue_t kv, old;
+  int set, i, cuckoo;
+
+  if (n > 65535) {
+    n = 65535;  // the "mix" set only has 2^16 distinct keys
+  }
+  for (set = 0; set < 3; set++) {
+    for (cuckoo = 0; cuckoo < 2; cuckoo++) {
+      HashTable *table = cuckoo ? HashTable_AllocateWithFlags(100,
+                                                              HT_FLAG_CUCKOO)
+                                : HashTable_Allocate(100);
+      double start = NowSeconds();
+
+      for (i = 0; i < n; i++) {
+        kv.key = FloodKey(set, i);
+        kv.value = NULL;
+        HashTable_Insert(table, kv, &old);
+      }
+      for (i = 0; i < n; i++) {
+        HashTable_Find(table, FloodKey(set, i), &kv);
+      }
+      printf("flood n=%d %-6s %-7s %6.2f Mops/s  longest chain %d\n", n,
+             kSets[set], cuckoo ? "cuckoo" : "chained",
+             2 * n / (NowSeconds() - start) / 1e6,
+             HashTable_LongestChain(table));
+      HashTable_Free(table, NULL);
+    }
+  }
+}
+
+
+// Random finds in an n-entry table under each memory policy, reporting
+// the time and dTLB misses per find, and how much of the process is
+// backed by huge pages once the table is built.
+static void BenchTLB(int n) {
+  static const struct {
+    const char *name;
+    int         flags;
+  } kPolicies[] = {
+    { "malloc",     0 },
+    { "arena",      HT_FLAG_ARENA },
+    { "huge",       HT_FLAG_HUGE_PAGES },
+    { "hugetlb",    HT_FLAG_HUGETLB },
+    { "interleave", HT_FLAG_HUGE_PAGES | HT_FLAG_NUMA_INTERLEAVE },
+  };
+  PerfCounters pc;
+  int p, i;
+
+  PerfOpen(&pc);
+
+  for (p = 0; p < (int) (sizeof(kPolicies) / sizeof(kPolicies[0])); p++) {
+    HashTable *table = HashTable_AllocateWithFlags(n / 3 + 1,
+                                                   kPolicies[p].flags);
+    HTKeyValue_t kv, old;
+    uint64_t found = 0, x = 1;
+    double start;
+
+    for (i = 0; i < n; i++) {
+      kv.key = BenchKey(i);
+      kv.value = (HTValue_t) (uintptr_t) i;
+      HashTable_Insert(table, kv, &old);
+    }
+
+    PerfStart(&pc);
+    start = NowSeconds();
+    for (i = 0; i < n; i++) {
+      // Visit the keys in a scrambled order, so each find lands somewhere
+      // unrelated to the last.
+      x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+      found += HashTable_Find(table, BenchKey((x >> 33) % n), &kv);
+    }
+    start = NowSeconds() - start;
+    PerfStop(&pc);
+
+    printf("tlb n=%d %-10s %6.1f ns/find  ", n, kPolicies[p].name,
+           start * 1e9 / n);
+    if (pc.fds[PERF_DTLB_MISSES] >= 0) {
+      printf("%5.3f dTLB misses/find  ", pc.counts[PERF_DTLB_MISSES] / n);
+    } else {
+      printf("dTLB misses n/a  ");
+    }
+    printf("huge pages %ld+%ld kB (found %llu)\n", SmapsKB("AnonHugePages"),
+           SmapsKB("Private_Hugetlb"), (unsigned long long) found);
+    HashTable_Free(table, NULL);
+  }
+  PerfClose(&pc);
+}
+
+
+// Bytes per element of a HashTable used as a set vs. a HashSet holding n
+// keys, then HashSet_Contains vs. HashSet_ContainsBatch over a stream in
+// which half the keys are present.
+static void BenchSet(int n) {
+  static const int kStream = 1024;
+  HTKey_t stream[1024];
+  bool found[1024];
+  HTKeyValue_t kv, old;
+  size_t before, ht_bytes, set_bytes;
+  uint64_t hits = 0;
+  HashTable *ht;
+  HashSet *set;
+  double start;
+  int i, j;
+
+  before = HeapInUse();
+  ht = HashTable_Allocate(2);
+  for (i = 0; i < n; i++) {
+    kv.key = BenchKey(i);
+    kv.value = NULL;
+    HashTable_Insert(ht, kv, &old);
+  }
+  ht_bytes = HeapInUse() - before;
+  HashTable_Free(ht, NULL);
+
+  before = HeapInUse();
+  set = HashSet_Allocate(2, 0);
+  for (i = 0; i < n; i++) {
+    HashSet_Add(set, BenchKey(i));
+  }
+  set_bytes = HeapInUse() - before;
+  printf("set n=%d HashTable=%.1f B/key HashSet=%.1f B/key\n", n,
+         (double) ht_bytes / n, (double) set_bytes / n);
+
+  start = NowSeconds();
+  for (i = 0; i < 2 * n; i += kStream) {
+    for (j = 0; j < kStream; j++) {
+      hits += HashSet_Contains(set, BenchKey((i + j) * 7919ULL % (2 * n)));
+    }
+  }
+  printf("set n=%d Contains      %6.1f Mkeys/s (hits %llu)\n", n,
+         2 * n / (NowSeconds() - start) / 1e6, (unsigned long long) hits);
+
+  hits = 0;
+  start = NowSeconds();
+  for (i = 0; i < 2 * n; i += kStream) {
+    for (j = 0; j < kStream; j++) {
+      stream[j] = BenchKey((i + j) * 7919ULL % (2 * n));
+    }
+    hits += HashSet_ContainsBatch(set, stream, kStream, found);
+  }
+  printf("set n=%d ContainsBatch %6.1f Mkeys/s (hits %llu)\n", n,
+         2 * n / (NowSeconds() - start) / 1e6, (unsigned long long) hits);
+  HashSet_Free(set);
+}
+
+
+// Freezes a HashTable of n keys, then compares random lookups (half of them
+// misses) in the chained table, the frozen table, and the frozen table
+// written to a file and mapped back in.
+static void BenchFrozen(int n) {
+  static const char *kPath = "bench_frozen.tmp";
+  HTKeyValue_t kv, old;
+  FrozenHashTable *frozen, *mapped;
+  size_t before, ht_bytes;
+  uint64_t hits;
+  HashTable *ht;
+  double start;
+  int i;
+
+  before = HeapInUse();
+  ht = HashTable_Allocate(2);
+  for (i = 0; i < n; i++) {
+    kv.key = BenchKey(i);
+    kv.value = (HTValue_t) (uintptr_t) i;
+    HashTable_Insert(ht, kv, &old);
+  }
+  ht_bytes = HeapInUse() - before;
+
+  start = NowSeconds();
+  frozen = HashTable_Freeze(ht);
+  if (frozen == NULL) {
+    printf("frozen n=%d HashTable_Freeze failed\n", n);
+    HashTable_Free(ht, NULL);
+    return;
+  }
+  printf("frozen n=%d Freeze %.2f s; HashTable=%.1f B/key "
+         "FrozenHashTable=%.1f B/key\n", n, NowSeconds() - start,
+         (double) ht_bytes / n,
+         (double) FrozenHashTable_NumBytes(frozen) / n);
+
+  hits = 0;
+  start = NowSeconds();
+  for (i = 0; i < 2 * n; i++) {
+    hits += HashTable_Find(ht, BenchKey(i * 7919ULL % (2 * n)), &kv);
+  }
+  printf("frozen n=%d HashTable       %6.1f ns/find (hits %llu)\n", n,
+         (NowSeconds() - start) * 1e9 / (2 * n), (unsigned long long) hits);
+
+  hits = 0;
+  start = NowSeconds();
+  for (i = 0; i < 2 * n; i++) {
+    hits += FrozenHashTable_Find(frozen, BenchKey(i * 7919ULL % (2 * n)),
+                                 &kv);
+  }
+  printf("frozen n=%d FrozenHashTable %6.1f ns/find (hits %llu)\n", n,
+         (NowSeconds() - start) * 1e9 / (2 * n), (unsigned long long) hits);
+
+  if (!FrozenHashTable_Write(frozen, kPath)) {
+    perror("FrozenHashTable_Write");
+  } else {
+    start = NowSeconds();
+    mapped = FrozenHashTable_Map(kPath);
+    if (mapped != NULL) {
+      printf("frozen n=%d Map %.1f us\n", n, (NowSeconds() - start) * 1e6);
+      hits = 0;
+      start = NowSeconds();
+      for (i = 0; i < 2 * n; i++) {
+        hits += FrozenHashTable_Find(mapped,
+                                     BenchKey(i * 7919ULL % (2 * n)), &kv);
+      }
+      printf("frozen n=%d mapped          %6.1f ns/find (hits %llu)\n", n,
+             (NowSeconds() - start) * 1e9 / (2 * n),
+             (unsigned long long) hits);
+      FrozenHashTable_Free(mapped, NULL);
+    }
+    unlink(kPath);
+  }
+
+  FrozenHashTable_Free(frozen, NULL);
+  HashTable_Free(ht, NULL);
+}
+
+#define QUEUE_MAX_THREADS 16  // most producers (and consumers) we run
+
+// Shared state for one run of the queue benchmark.  Producers append
+// per_producer payloads each and consumers pop until remaining reaches
+// zero.  If queue is NULL, list is used under lock instead.
+typedef struct {
+  ConcurrentQueue *queue;
+  LinkedList      *list;
+  pthread_mutex_t  lock;
+  int              per_producer;
+  atomic_int       remaining;
+} QueueBench;
+
+static void* QueueProducer(void *arg) {
+  QueueBench *b = (QueueBench *) arg;
+  int i;
+
+  for (i = 0; i < b->per_producer; i++) {
+    LLPayload_t payload = (LLPayload_t) (uintptr_t) (i + 1);
+    if (b->queue != NULL) {
+      while (!ConcurrentQueue_Append(b->queue, payload)) {
+        sched_yield();
+      }
+    } else {
+      pthread_mutex_lock(&b->lock);
+      LinkedList_Append(b->list, payload);
+      pthread_mutex_unlock(&b->lock);
+    }
+  }
+  return NULL;
+}
+
+static void* QueueConsumer(void *arg) {
+  QueueBench *b = (QueueBench *) arg;
+  LLPayload_t payload;
+  bool popped;
+
+  while (atomic_load_explicit(&b->remaining, memory_order_relaxed) > 0) {
+    if (b->queue != NULL) {
+      popped = ConcurrentQueue_Pop(b->queue, &payload);
+    } else {
+      pthread_mutex_lock(&b->lock);
+      popped = LinkedList_Pop(b->list, &payload);
+      pthread_mutex_unlock(&b->lock);
+    }
+    if (popped) {
+      atomic_fetch_sub_explicit(&b->remaining, 1, memory_order_relaxed);
+    } else {
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+// Runs threads producers and threads consumers over b, moving about n
+// payloads in all, and returns the throughput in millions of payloads
+// per second.
+static double RunQueueBench(QueueBench *b, int threads, int n) {
+  pthread_t tids[2 * QUEUE_MAX_THREADS];
+  double start;
+  int i;
+
+  b->per_producer = n / threads;
+  atomic_store(&b->remaining, b->per_producer * threads);
+  start = NowSeconds();
+  for (i = 0; i < threads; i++) {
+    pthread_create(&tids[i], NULL, &QueueProducer, b);
+    pthread_create(&tids[threads + i], NULL, &QueueConsumer, b);
+  }
+  for (i = 0; i < 2 * threads; i++) {
+    pthread_join(tids[i], NULL);
+  }
+  return b->per_producer * threads / (NowSeconds() - start) / 1e6;
+}
+
+// Throughput of a LinkedList work queue under a mutex vs. a
+// ConcurrentQueue, with 1 to 16 producers and as many consumers.
+static void BenchQueue(int n) {
+  QueueBench b;
+  double locked, lock_free;
+  int threads;
+
+  pthread_mutex_init(&b.lock, NULL);
+  for (threads = 1; threads <= QUEUE_MAX_THREADS; threads *= 2) {
+    b.queue = NULL;
+    b.list = LinkedList_Allocate();
+    locked = RunQueueBench(&b, threads, n);
+    LinkedList_Free(b.list, &NoOpFree);
+
+    b.queue = ConcurrentQueue_Allocate(4096);
+    lock_free = RunQueueBench(&b, threads, n);
+    ConcurrentQueue_Free(b.queue, NULL);
+
+    printf("queue n=%d %2d producers %2d consumers: LinkedList+mutex "
+           "%6.2f M/s ConcurrentQueue %6.2f M/s\n", n, threads, threads,
+           locked, lock_free);
+  }
+  pthread_mutex_destroy(&b.lock);
+}
+
+// Orders payloads holding integer keys.
+static int CompareKeys(LLPayload_t a, LLPayload_t b) {
+  uintptr_t x = (uintptr_t) a, y = (uintptr_t) b;
+
+  return (x > y) - (x < y);
+}
+
+// Range queries ("every key in [lo, lo + width)") over n keys: copying a
+// HashTable out sorted for each query vs. seeking in a SkipList.
+static void BenchRange(int n) {
+  static const int kQueries = 100;
+  static const uint64_t kWidth = 1000;
+  HTKeyValue_t kv, old, *snap;
+  LLPayload_t payload, old_payload;
+  LLIterator *iter;
+  SkipList *sl;
+  HashTable *ht;
+  uint64_t lo, found = 0, step = UINT64_MAX / n;
+  double start;
+  int i, q, m, a, b;
+
+  // Keys are multiples of step, in scrambled order.
+  ht = HashTable_Allocate(2);
+  sl = SkipList_Allocate(&CompareKeys);
+  start = NowSeconds();
+  for (i = 0; i < n; i++) {
+    kv.key = (BenchKey(i) % n) * step;
+    kv.value = NULL;
+    HashTable_Insert(ht, kv, &old);
+  }
+  printf("range n=%d HashTable insert %6.1f ns/op\n", n,
+         (NowSeconds() - start) * 1e9 / n);
+  start = NowSeconds();
+  for (i = 0; i < n; i++) {
+    payload = (LLPayload_t) (uintptr_t) ((BenchKey(i) % n) * step);
+    SkipList_Insert(sl, payload, &old_payload);
+  }
+  printf("range n=%d SkipList  insert %6.1f ns/op\n", n,
+         (NowSeconds() - start) * 1e9 / n);
+  start = NowSeconds();
+  for (i = 0; i < n; i++) {
+    payload = (LLPayload_t) (uintptr_t) ((BenchKey(i) % n) * step);
+    found += SkipList_Find(sl, payload, &payload);
+  }
+  printf("range n=%d SkipList  find   %6.1f ns/op (found %llu)\n", n,
+         (NowSeconds() - start) * 1e9 / n, (unsigned long long) found);
+
+  found = 0;
+  start = NowSeconds();
+  for (q = 0; q < kQueries; q++) {
+    lo = (BenchKey(q) % n) * step;
+    snap = NULL;
+    m = HashTable_SortedSnapshot(ht, &snap, 1);
+    for (a = 0, b = m; a < b; ) {
+      int mid = a + (b - a) / 2;
+      if (snap[mid].key < lo) {
+        a = mid + 1;
+      } else {
+        b = mid;
+      }
+    }
+    for (; a < m && snap[a].key - lo < kWidth * step; a++) {
+      found++;
+    }
+    free(snap);
+  }
+  printf("range n=%d HashTable snapshot+sort %10.1f us/query "
+         "(found %llu)\n", n, (NowSeconds() - start) * 1e6 / kQueries,
+         (unsigned long long) found);
+
+  found = 0;
+  start = NowSeconds();
+  for (q = 0; q < kQueries; q++) {
+    lo = (BenchKey(q) % n) * step;
+    iter = SkipList_Seek(sl, (LLPayload_t) (uintptr_t) lo);
+    while (LLIterator_IsValid(iter)) {
+      LLIterator_Get(iter, &payload);
+      if ((uintptr_t) payload - lo >= kWidth * step) {
+        break;
+      }
+      found++;
+      LLIterator_Next(iter);
+    }
+    LLIterator_Free(iter);
+  }
+  printf("range n=%d SkipList  seek+walk     %10.1f us/query "
+         "(found %llu)\n", n, (NowSeconds() - start) * 1e6 / kQueries,
+         (unsigned long long) found);
+
+  SkipList_Free(sl, &NoOpFree);
+  HashTable_Free(ht, NULL);
+}
+
+// Publishing a snapshot of an n-entry table: deep-copying a HashTable
+// through HTIterator vs. cloning a PersistentHashTable, then the cost of
+// updates to the original while the snapshot is alive.
+static void BenchSnapshot(int n) {
+  static const int kUpdates = 100000;
+  PersistentHashTable *pht, *clone;
+  HashTable *ht, *copy;
+  HTIterator *iter;
+  HTKeyValue_t kv, old;
+  uint64_t found = 0;
+  double start;
+  int i;
+
+  ht = HashTable_Allocate(2);
+  pht = PersistentHashTable_Allocate();
+  for (i = 0; i < n; i++) {
+    kv.key = BenchKey(i);
+    kv.value = (HTValue_t) (uintptr_t) i;
+    HashTable_Insert(ht, kv, &old);
+    PersistentHashTable_Insert(pht, kv, &old);
+  }
+
+  start = NowSeconds();
+  copy = HashTable_Allocate(2);
+  iter = HTIterator_Allocate(ht);
+  while (HTIterator_IsValid(iter)) {
+    HTIterator_Get(iter, &kv);
+    HashTable_Insert(copy, kv, &old);
+    HTIterator_Next(iter);
+  }
+  HTIterator_Free(iter);
+  printf("snapshot n=%d HashTable deep copy         %10.1f us\n", n,
+         (NowSeconds() - start) * 1e6);
+
+  start = NowSeconds();
+  clone = PersistentHashTable_Clone(pht);
+  printf("snapshot n=%d PersistentHashTable_Clone   %10.3f us\n", n,
+         (NowSeconds() - start) * 1e6);
+
+  start = NowSeconds();
+  for (i = 0; i < kUpdates; i++) {
+    kv.key = BenchKey(i % n);
+    kv.value = NULL;
+    HashTable_Insert(ht, kv, &old);
+  }
+  printf("snapshot n=%d HashTable update           %10.1f ns/op\n", n,
+         (NowSeconds() - start) * 1e9 / kUpdates);
+
+  start = NowSeconds();
+  for (i = 0; i < kUpdates; i++) {
+    kv.key = BenchKey(i % n);
+    kv.value = NULL;
+    PersistentHashTable_Insert(pht, kv, &old);
+  }
+  printf("snapshot n=%d PersistentHashTable update %10.1f ns/op\n", n,
+         (NowSeconds() - start) * 1e9 / kUpdates);
+
+  // The snapshot still has the values from before the updates.
+  start = NowSeconds();
+  for (i = 0; i < n; i++) {
+    found += PersistentHashTable_Find(clone, BenchKey(i), &kv) &&
+             kv.value == (HTValue_t) (uintptr_t) i;
+  }
+  printf("snapshot n=%d PersistentHashTable find   %10.1f ns/op "
+         "(unchanged %llu)\n", n, (NowSeconds() - start) * 1e9 / n,
+         (unsigned long long) found);
+
+  PersistentHashTable_Free(clone);
+  PersistentHashTable_Free(pht);
+  HashTable_Free(copy, NULL);
+  HashTable_Free(ht, NULL);
+}
+
+// Predicate for BenchPurge: is the entry's value odd?
+static bool IsOddValue(const HTKeyValue_t *kv, void *arg) {
+  (void) arg;
+  return ((uintptr_t) kv->value & 1) != 0;
+}
+
+// Fills a HashTable with n entries for BenchPurge, with values 0..n-1.
+static HashTable* PurgeTable(int n) {
+  HashTable *table = HashTable_Allocate(2);
+  HTKeyValue_t kv, old;
+  int i;
+
+  for (i = 0; i < n; i++) {
+    kv.key = BenchKey(i);
+    kv.value = (HTValue_t) (uintptr_t) i;
+    HashTable_Insert(table, kv, &old);
+  }
+  return table;
+}
+
+// Removing half of an n-entry table: through HTIterator_Remove vs.
+// HashTable_RemoveIf.
+static void BenchPurge(int n) {
+  HashTable *table;
+  HTIterator *iter;
+  HTKeyValue_t kv;
+  double start;
+  int removed = 0;
+
+  table = PurgeTable(n);
+  start = NowSeconds();
+  iter = HTIterator_Allocate(table);
+  while (HTIterator_IsValid(iter)) {
+    HTIterator_Get(iter, &kv);
+    if (IsOddValue(&kv, NULL)) {
+      HTIterator_Remove(iter, &kv);
+      removed++;
+    } else {
+      HTIterator_Next(iter);
+    }
+  }
+  HTIterator_Free(iter);
+  printf("purge n=%d HTIterator_Remove  %6.1f ns/entry (removed %d)\n", n,
+         (NowSeconds() - start) * 1e9 / n, removed);
+  HashTable_Free(table, NULL);
+
+  table = PurgeTable(n);
+  start = NowSeconds();
+  removed = HashTable_RemoveIf(table, &IsOddValue, NULL, NULL);
+  printf("purge n=%d HashTable_RemoveIf %6.1f ns/entry (removed %d)\n", n,
+         (NowSeconds() - start) * 1e9 / n, removed);
+  HashTable_Free(table, NULL);
+}
+
+// Hardware counters per operation for the basic HashTable and LinkedList
+// operations, at table sizes from 1K up to n entries, so that a change in
+// speed can be traced to the cost (instructions, cache or TLB misses,
+// branch misses) that changed with it.
+static void BenchCounters(int n) {
+  PerfCounters pc;
+  HTKeyValue_t kv, old;
+  LLPayload_t payload;
+  LLIterator *lliter;
+  LinkedList *list;
+  HashTable *table;
+  uint64_t sink = 0;
+  double start;
+  int size, i;
+
+  PerfOpen(&pc);
+  for (size = 1024; size <= n; size *= 16) {
+    table = HashTable_Allocate(2);
+    PerfStart(&pc);
+    start = NowSeconds();
+    for (i = 0; i < size; i++) {
+      kv.key = BenchKey(i);
+      kv.value = (HTValue_t) (uintptr_t) i;
+      HashTable_Insert(table, kv, &old);
+    }
+    start = NowSeconds() - start;
+    PerfStop(&pc);
+    PerfReport(&pc, "counters", size, "ht-insert", size, start);
+
+    PerfStart(&pc);
+    start = NowSeconds();
+    for (i = 0; i < size; i++) {
+      sink += HashTable_Find(table, BenchKey(i * 7919ULL % size), &kv);
+    }
+    start = NowSeconds() - start;
+    PerfStop(&pc);
+    PerfReport(&pc, "counters", size, "ht-find-hit", size, start);
+
+    PerfStart(&pc);
+    start = NowSeconds();
+    for (i = 0; i < size; i++) {
+      sink += HashTable_Find(table, BenchKey(size + i), &kv);
+    }
+    start = NowSeconds() - start;
+    PerfStop(&pc);
+    PerfReport(&pc, "counters", size, "ht-find-miss", size, start);
+
+    PerfStart(&pc);
+    start = NowSeconds();
+    for (i = 0; i < size; i++) {
+      sink += HashTable_Remove(table, BenchKey(i * 7919ULL % size), &kv);
+    }
+    start = NowSeconds() - start;
+    PerfStop(&pc);
+    PerfReport(&pc, "counters", size, "ht-remove", size, start);
+    HashTable_Free(table, NULL);
+
+    list = LinkedList_Allocate();
+    PerfStart(&pc);
+    start = NowSeconds();
+    for (i = 0; i < size; i++) {
+      LinkedList_Append(list, (LLPayload_t) (uintptr_t) i);
+    }
+    start = NowSeconds() - start;
+    PerfStop(&pc);
+    PerfReport(&pc, "counters", size, "ll-append", size, start);
+
+    PerfStart(&pc);
+    start = NowSeconds();
+    lliter = LLIterator_Allocate(list);
+    while (LLIterator_IsValid(lliter)) {
+      LLIterator_Get(lliter, &payload);
+      sink += (uintptr_t) payload;
+      LLIterator_Next(lliter);
+    }
+    LLIterator_Free(lliter);
+    start = NowSeconds() - start;
+    PerfStop(&pc);
+    PerfReport(&pc, "counters", size, "ll-iterate", size, start);
+
+    PerfStart(&pc);
+    start = NowSeconds();
+    while (LinkedList_Pop(list, &payload)) {
+      sink += (uintptr_t) payload;
+    }
+    start = NowSeconds() - start;
+    PerfStop(&pc);
+    PerfReport(&pc, "counters", size, "ll-pop", size, start);
+    LinkedList_Free(list, &NoOpFree);
+  }
+  PerfClose(&pc);
+  printf("counters (checksum %llu)\n", (unsigned long long) sink);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Driver.
+
+typedef struct {
+  const char  *name;         // what to pass on the command line
+  void       (*run)(int n);  // runs the workload with n elements
+  int          default_n;    // n to use if none is given
+} Workload;
+
+static const Workload kWorkloads[] = {
+  { "memory",  &BenchMemory,  1000000 },
+  { "join",    &BenchJoin,    4000000 },
+  { "latency", &BenchLatency, 1000000 },
+  { "deque",   &BenchDeque,   10000000 },
+  { "cuckoo",  &BenchCuckoo,  4000000 },
+  { "flood",   &BenchFlood,   50000 },
+  { "tlb",     &BenchTLB,     4000000 },
+  { "set",     &BenchSet,     4000000 },
+  { "frozen",  &BenchFrozen,  4000000 },
+  { "queue",   &BenchQueue,   4000000 },
+  { "range",   &BenchRange,   1000000 },
+  { "snapshot", &BenchSnapshot, 1000000 },
+  { "purge",   &BenchPurge,   2000000 },
+  { "counters", &BenchCounters, 4000000 },
+};
+
+#define NUM_WORKLOADS ((int) (sizeof(kWorkloads) / sizeof(kWorkloads[0])))
+
+int main(int argc, char **argv) {
+  int i, ran = 0;
+
+  for (i = 0; i < NUM_WORKLOADS; i++) {
+    if (argc > 1 && strcmp(argv[1], kWorkloads[i].name) != 0) {
+      continue;
+    }
+    kWorkloads[i].run(argc > 2 ? atoi(argv[2]) : kWorkloads[i].default_n);
+    ran++;
+  }
+
+  if (ran == 0) {
+    fprintf(stderr, "usage: %s [workload [n]]\nworkloads:", argv[0]);
+    for (i = 0; i < NUM_WORKLOADS; i++) {
+      fprintf(stderr, " %s", kWorkloads[i].name);
+    }
+    fprintf(stderr, "\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+  #include "./Arena.h"
+  #include "./Arena_priv.h"
+}
+
+#include "gtest/gtest.h"
+
+namespace hw0 {
+
+TEST(Test_Arena, AllocAlignAndReuse) {
+  Arena *arena = Arena_Allocate();
+  char *blocks[1000];
+
+  ASSERT_NE(nullptr, arena);
+  for (int i = 0; i < 1000; i++) {
+    blocks[i] = static_cast<char *>(Arena_Alloc(arena, 1 + i % 100));
+    ASSERT_NE(nullptr, blocks[i]);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(blocks[i]) % ARENA_ALIGN);
+    memset(blocks[i], i, 1 + i % 100);
+  }
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(static_cast<char>(i), blocks[i][i % 100]);
+  }
+
+  // A released small block is handed out again for the same size.
+  Arena_Release(arena, blocks[5], 6);
+  EXPECT_EQ(blocks[5], Arena_Alloc(arena, 6));
+  Arena_Free(arena);
+}
+
+TEST(Test_Arena, LargeAllocationsAreUnmappedOnRelease) {
+  Arena *arena = Arena_Allocate();
+  size_t size = 4 * ARENA_LARGE;
+  uint64_t before;
+  char *big;
+
+  Arena_Alloc(arena, 16);
+  before = Arena_NumBytesReserved(arena);
+  big = static_cast<char *>(Arena_Alloc(arena, size));
+  ASSERT_NE(nullptr, big);
+  memset(big, 1, size);
+  EXPECT_GE(Arena_NumBytesReserved(arena), before + size);
+  Arena_Release(arena, big, size);
+  EXPECT_EQ(before, Arena_NumBytesReserved(arena));
+  Arena_Free(arena);
+}
+
+// Every policy works (falling back quietly where the system can't oblige)
+// except the one contradictory combination.
+TEST(Test_Arena, Policies) {
+  const int policies[] = {
+    ARENA_POLICY_HUGE_PAGES,
+    ARENA_POLICY_HUGETLB,
+    ARENA_POLICY_NUMA_INTERLEAVE,
+    ARENA_POLICY_NUMA_LOCAL,
+    ARENA_POLICY_HUGE_PAGES | ARENA_POLICY_NUMA_INTERLEAVE,
+    ARENA_POLICY_HUGETLB | ARENA_POLICY_NUMA_LOCAL,
+  };
+
+  for (int policy : policies) {
+    SCOPED_TRACE(policy);
+    Arena *arena = Arena_AllocateWithPolicy(policy);
+    ASSERT_NE(nullptr, arena);
+    for (size_t size : {16ul, 4096ul, 3ul << 20}) {
+      char *block = static_cast<char *>(Arena_Alloc(arena, size));
+      ASSERT_NE(nullptr, block);
+      memset(block, 0xab, size);
+    }
+    Arena_Free(arena);
+  }
+  EXPECT_EQ(nullptr, Arena_AllocateWithPolicy(
+                         ARENA_POLICY_NUMA_INTERLEAVE |
+                         ARENA_POLICY_NUMA_LOCAL));
+}
+
+}  // namespace hw0
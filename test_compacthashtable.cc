@@ -0,0 +1,105 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <map>
+
+extern "C" {
+  #include "./CompactHashTable.h"
+  #include "./CompactHashTable_priv.h"
+}
+
+#include "gtest/gtest.h"
+#include "./test_util.h"
+
+namespace hw0 {
+
+// Removing an entry moves the last one into its slot, so the chains
+// must still reach every survivor and Entries() must stay dense.
+TEST(Test_CompactHashTable, RemoveKeepsChainsAndEntriesDense) {
+  CompactHashTable *table = CompactHashTable_Allocate(0);
+  HTKeyValue_t kv;
+
+  ASSERT_NE(nullptr, table);
+  for (HTKey_t key = 0; key < 3000; key++) {
+    ASSERT_FALSE(CompactHashTable_Insert(table, KV(key, key), &kv));
+  }
+  ASSERT_TRUE(CompactHashTable_Insert(table, KV(7, 70), &kv));
+  EXPECT_EQ(7, reinterpret_cast<intptr_t>(kv.value));
+
+  // Remove every third key, from the front so most removals move an
+  // entry from the end of the array.
+  for (HTKey_t key = 0; key < 3000; key += 3) {
+    ASSERT_TRUE(CompactHashTable_Remove(table, key, &kv));
+    EXPECT_EQ(key, kv.key);
+  }
+  EXPECT_FALSE(CompactHashTable_Remove(table, 0, &kv));
+  ASSERT_EQ(2000, CompactHashTable_NumElements(table));
+
+  for (HTKey_t key = 0; key < 3000; key++) {
+    ASSERT_EQ(key % 3 != 0, CompactHashTable_Find(table, key, &kv));
+    if (key % 3 != 0) {
+      EXPECT_EQ(key == 7 ? 70 : static_cast<intptr_t>(key),
+                reinterpret_cast<intptr_t>(kv.value));
+    }
+  }
+
+  HTKeyValue_t *entries = CompactHashTable_Entries(table);
+  std::map<HTKey_t, intptr_t> listed;
+  for (int i = 0; i < CompactHashTable_NumElements(table); i++) {
+    EXPECT_NE(0u, entries[i].key % 3);
+    listed[entries[i].key] = reinterpret_cast<intptr_t>(entries[i].value);
+  }
+  EXPECT_EQ(2000u, listed.size());
+  CompactHashTable_Free(table, nullptr);
+}
+
+TEST(Test_CompactHashTable, MemoryUsageTracksSize) {
+  CompactHashTable *table = CompactHashTable_Allocate(16);
+  HTKeyValue_t old;
+  size_t empty = CompactHashTable_MemoryUsage(table);
+
+  for (int i = 0; i < 100000; i++) {
+    ASSERT_FALSE(CompactHashTable_Insert(table, KV(i, i), &old));
+  }
+  size_t full = CompactHashTable_MemoryUsage(table);
+  EXPECT_GT(full, empty);
+  // 16 bytes per entry plus the index; well under the chained table.
+  EXPECT_LT(full, 100000 * 64u);
+  CompactHashTable_Free(table, nullptr);
+}
+
+// Keys that all shared a chain when buckets came from HTMix64 are spread
+// by the table's seed.
+TEST(Test_CompactHashTable, SeededBucketsSpreadCollidingKeys) {
+  CompactHashTable *table = CompactHashTable_Allocate(0);
+  HTKeyValue_t kv;
+  uint32_t longest = 0;
+
+  ASSERT_NE(nullptr, table);
+  for (int i = 1; i <= 4096; i++) {
+    HTKey_t key = UnMix64(static_cast<uint64_t>(i) << 48);
+    ASSERT_FALSE(CompactHashTable_Insert(table, KV(key, i), &kv));
+  }
+  for (uint32_t b = 0; b < table->num_buckets; b++) {
+    uint32_t len = 0;
+    for (uint32_t i = table->buckets[b]; i != CHT_NIL; i = table->next[i]) {
+      len++;
+    }
+    longest = std::max(longest, len);
+  }
+  EXPECT_LE(longest, 16u);
+  CompactHashTable_Free(table, nullptr);
+}
+
+}  // namespace hw0
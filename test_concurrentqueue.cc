@@ -0,0 +1,103 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+extern "C" {
+  #include "./ConcurrentQueue.h"
+}
+
+#include "gtest/gtest.h"
+#include "./test_util.h"
+
+namespace hw0 {
+
+TEST(Test_ConcurrentQueue, FifoAndBounds) {
+  ConcurrentQueue *queue = ConcurrentQueue_Allocate(5);
+  LLPayload_t payload;
+
+  ASSERT_NE(nullptr, queue);
+  EXPECT_EQ(8, ConcurrentQueue_Capacity(queue));
+  EXPECT_FALSE(ConcurrentQueue_Pop(queue, &payload));
+
+  // Go round the ring a few times.
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 8; i++) {
+      ASSERT_TRUE(ConcurrentQueue_Append(queue, P(i)));
+    }
+    EXPECT_FALSE(ConcurrentQueue_Append(queue, P(8)));
+    EXPECT_EQ(8, ConcurrentQueue_NumElements(queue));
+    for (int i = 0; i < 8; i++) {
+      ASSERT_TRUE(ConcurrentQueue_Pop(queue, &payload));
+      EXPECT_EQ(P(i), payload);
+    }
+    EXPECT_FALSE(ConcurrentQueue_Pop(queue, &payload));
+  }
+  ConcurrentQueue_Free(queue, nullptr);
+
+  EXPECT_EQ(nullptr, ConcurrentQueue_Allocate((1 << 30) + 1));
+}
+
+// Several appenders and poppers at once: every payload comes out exactly
+// once, and each appender's payloads come out in the order it put them in.
+TEST(Test_ConcurrentQueue, ManyProducersManyConsumers) {
+  const int kThreads = 4, kPerThread = 100000;
+  ConcurrentQueue *queue = ConcurrentQueue_Allocate(1024);
+  std::vector<std::atomic<int>> seen(kThreads * kPerThread);
+  std::atomic<int> popped(0);
+  std::atomic<bool> out_of_order(false);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([=] {
+      for (int i = 0; i < kPerThread; i++) {
+        while (!ConcurrentQueue_Append(queue, P(t * kPerThread + i))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+    threads.emplace_back([&] {
+      std::vector<int> last(kThreads, -1);
+      LLPayload_t payload;
+
+      while (popped.load() < kThreads * kPerThread) {
+        if (!ConcurrentQueue_Pop(queue, &payload)) {
+          std::this_thread::yield();
+          continue;
+        }
+        int value = static_cast<int>(reinterpret_cast<intptr_t>(payload));
+        int producer = value / kPerThread, i = value % kPerThread;
+        if (i <= last[producer]) {
+          out_of_order = true;
+        }
+        last[producer] = i;
+        seen[value]++;
+        popped++;
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_FALSE(out_of_order);
+  for (int i = 0; i < kThreads * kPerThread; i++) {
+    ASSERT_EQ(1, seen[i].load());
+  }
+  EXPECT_EQ(0, ConcurrentQueue_NumElements(queue));
+  ConcurrentQueue_Free(queue, nullptr);
+}
+
+}  // namespace hw0
@@ -0,0 +1,98 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+
+#include <set>
+
+extern "C" {
+  #include "./CuckooHashTable.h"
+}
+
+#include "gtest/gtest.h"
+#include "./test_util.h"
+
+namespace hw0 {
+
+// A table that starts empty has to grow and displace entries as it
+// fills; every key must stay reachable through Find, FindOrInsert's
+// slot, and exactly one visit from Next.
+TEST(Test_CuckooHashTable, GrowsAndDisplacesWithoutLosingKeys) {
+  CuckooHashTable *table = CuckooHashTable_Allocate(0);
+  HTKeyValue_t kv;
+  bool inserted;
+
+  ASSERT_NE(nullptr, table);
+  for (HTKey_t key = 0; key < 20000; key++) {
+    ASSERT_FALSE(CuckooHashTable_Insert(table, KV(key, key), &kv));
+  }
+  ASSERT_TRUE(CuckooHashTable_Insert(table, KV(5, 50), &kv));
+  EXPECT_EQ(5, reinterpret_cast<intptr_t>(kv.value));
+
+  // FindOrInsert hands back the existing slot, or a fresh NULL one.
+  HTValue_t *value = CuckooHashTable_FindOrInsert(table, 6, &inserted);
+  ASSERT_NE(nullptr, value);
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(6, reinterpret_cast<intptr_t>(*value));
+  *value = V(60);
+  value = CuckooHashTable_FindOrInsert(table, 20000, &inserted);
+  ASSERT_NE(nullptr, value);
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(nullptr, *value);
+  *value = V(20000);
+
+  for (HTKey_t key = 0; key < 20000; key += 2) {
+    ASSERT_TRUE(CuckooHashTable_Remove(table, key, &kv));
+    EXPECT_EQ(key == 6 ? 60 : static_cast<intptr_t>(key),
+              reinterpret_cast<intptr_t>(kv.value));
+  }
+  EXPECT_FALSE(CuckooHashTable_Remove(table, 0, &kv));
+  ASSERT_EQ(10001, CuckooHashTable_NumElements(table));
+
+  for (HTKey_t key = 0; key <= 20000; key++) {
+    bool present = key % 2 == 1 || key == 20000;
+    ASSERT_EQ(present, CuckooHashTable_Find(table, key, &kv));
+    if (present) {
+      EXPECT_EQ(key == 5 ? 50 : static_cast<intptr_t>(key),
+                reinterpret_cast<intptr_t>(kv.value));
+    }
+  }
+
+  std::set<HTKey_t> visited;
+  uint64_t position = 0;
+  while (CuckooHashTable_Next(table, &position, &kv)) {
+    EXPECT_TRUE(visited.insert(kv.key).second);
+  }
+  EXPECT_EQ(10001u, visited.size());
+  CuckooHashTable_Free(table, nullptr);
+}
+
+// Filling a presized table stays within its capacity, at a high load,
+// with the stash nearly or entirely empty.
+TEST(Test_CuckooHashTable, FillsToHighLoad) {
+  CuckooHashTable *table = CuckooHashTable_Allocate(100000);
+  int capacity = CuckooHashTable_Capacity(table);
+  HTKeyValue_t kv;
+
+  ASSERT_GE(capacity, 100000);
+  for (int i = 0; i < capacity * 9 / 10; i++) {
+    ASSERT_FALSE(CuckooHashTable_Insert(table, KV(i * 7919, i), &kv));
+  }
+  EXPECT_EQ(capacity, CuckooHashTable_Capacity(table));
+  EXPECT_LE(CuckooHashTable_NumStashed(table), 4);
+  for (int i = 0; i < capacity * 9 / 10; i++) {
+    ASSERT_TRUE(CuckooHashTable_Find(table, i * 7919, &kv));
+    EXPECT_EQ(reinterpret_cast<HTValue_t>(i), kv.value);
+  }
+  CuckooHashTable_Free(table, nullptr);
+}
+
+}  // namespace hw0
@@ -0,0 +1,121 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <map>
+
+extern "C" {
+  #include "./FrozenHashTable.h"
+}
+
+#include "gtest/gtest.h"
+#include "./test_util.h"
+
+namespace hw0 {
+
+// Checks that frozen holds exactly ref, by lookup and by visiting.
+static void ExpectSame(FrozenHashTable *frozen,
+                       const std::map<HTKey_t, intptr_t> &ref) {
+  std::map<HTKey_t, intptr_t> visited;
+  uint64_t position = 0;
+  HTKeyValue_t kv;
+
+  ASSERT_EQ(static_cast<int>(ref.size()),
+            FrozenHashTable_NumElements(frozen));
+  for (auto &entry : ref) {
+    ASSERT_TRUE(FrozenHashTable_Find(frozen, entry.first, &kv));
+    EXPECT_EQ(entry.second, reinterpret_cast<intptr_t>(kv.value));
+    EXPECT_FALSE(FrozenHashTable_Find(frozen, entry.first + 1, &kv));
+  }
+  while (FrozenHashTable_Next(frozen, &position, &kv)) {
+    visited[kv.key] = reinterpret_cast<intptr_t>(kv.value);
+  }
+  EXPECT_EQ(ref, visited);
+}
+
+TEST(Test_FrozenHashTable, FreezeCopiesTheTable) {
+  HashTable *table = HashTable_Allocate(2);
+  std::map<HTKey_t, intptr_t> ref;
+  HTKeyValue_t old;
+
+  for (intptr_t i = 0; i < 50000; i++) {
+    HTKey_t key = static_cast<HTKey_t>(i) * 2;  // odd keys are misses
+    HashTable_Insert(table, KV(key, i), &old);
+    ref[key] = i;
+  }
+  FrozenHashTable *frozen = HashTable_Freeze(table);
+  ASSERT_NE(nullptr, frozen);
+
+  // The copy doesn't follow later changes to the table.
+  HashTable_Insert(table, KV(1, 1), &old);
+  HashTable_Free(table, nullptr);
+  ExpectSame(frozen, ref);
+  EXPECT_LT(FrozenHashTable_NumBytes(frozen), 50000 * 24u);
+  FrozenHashTable_Free(frozen, nullptr);
+}
+
+TEST(Test_FrozenHashTable, EmptyTableAndDuplicates) {
+  HashTable *table = HashTable_AllocateWithFlags(2, HT_FLAG_MULTIMAP);
+  HTKeyValue_t old;
+
+  FrozenHashTable *frozen = HashTable_Freeze(table);
+  ASSERT_NE(nullptr, frozen);
+  ExpectSame(frozen, {});
+  FrozenHashTable_Free(frozen, nullptr);
+
+  HashTable_Insert(table, KV(4, 1), &old);
+  HashTable_Insert(table, KV(6, 1), &old);
+  frozen = HashTable_Freeze(table);
+  ASSERT_NE(nullptr, frozen);
+  ExpectSame(frozen, {{4, 1}, {6, 1}});
+  FrozenHashTable_Free(frozen, nullptr);
+
+  HashTable_Insert(table, KV(4, 2), &old);
+  EXPECT_EQ(nullptr, HashTable_Freeze(table));
+  HashTable_Free(table, nullptr);
+}
+
+TEST(Test_FrozenHashTable, WriteAndMap) {
+  char path[] = "/tmp/test_frozen_XXXXXX";
+  int fd = mkstemp(path);
+  HashTable *table = HashTable_Allocate(2);
+  std::map<HTKey_t, intptr_t> ref;
+  HTKeyValue_t old;
+
+  ASSERT_GE(fd, 0);
+  close(fd);
+  for (intptr_t i = 0; i < 10000; i++) {
+    HashTable_Insert(table, KV(i * 10, i), &old);
+    ref[i * 10] = i;
+  }
+  FrozenHashTable *frozen = HashTable_Freeze(table);
+  HashTable_Free(table, nullptr);
+  ASSERT_TRUE(FrozenHashTable_Write(frozen, path));
+  size_t num_bytes = FrozenHashTable_NumBytes(frozen);
+  FrozenHashTable_Free(frozen, nullptr);
+
+  FrozenHashTable *mapped = FrozenHashTable_Map(path);
+  ASSERT_NE(nullptr, mapped);
+  EXPECT_EQ(num_bytes, FrozenHashTable_NumBytes(mapped));
+  ExpectSame(mapped, ref);
+  FrozenHashTable_Free(mapped, nullptr);
+
+  // A file that isn't a frozen table is refused.
+  ASSERT_EQ(0, truncate(path, 8));
+  EXPECT_EQ(nullptr, FrozenHashTable_Map(path));
+  unlink(path);
+  EXPECT_EQ(nullptr, FrozenHashTable_Map(path));
+}
+
+}  // namespace hw0
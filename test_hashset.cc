@@ -0,0 +1,91 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+
+#include <type_traits>
+#include <vector>
+
+extern "C" {
+  #include "./HashSet.h"
+}
+
+#include "gtest/gtest.h"
+
+namespace hw0 {
+
+// A set and a table are different types, so one can't be passed for the
+// other.
+static_assert(!std::is_same<HashSet, HashTable>::value,
+              "HashSet must be a distinct type from HashTable");
+static_assert(!std::is_convertible<HashSet *, HashTable *>::value,
+              "a HashSet* must not convert to a HashTable*");
+
+// Add and Remove report whether membership changed, in both the heap
+// and the arena-backed layout.
+TEST(Test_HashSet, AddRemoveContains) {
+  for (int flags : {0, HT_FLAG_ARENA}) {
+    SCOPED_TRACE(flags);
+    HashSet *set = HashSet_Allocate(2, flags);
+
+    ASSERT_NE(nullptr, set);
+    for (HTKey_t key = 0; key < 5000; key++) {
+      ASSERT_TRUE(HashSet_Add(set, key));
+    }
+    EXPECT_FALSE(HashSet_Add(set, 42));
+    EXPECT_EQ(5000, HashSet_NumElements(set));
+
+    for (HTKey_t key = 0; key < 5000; key += 2) {
+      ASSERT_TRUE(HashSet_Remove(set, key));
+    }
+    EXPECT_FALSE(HashSet_Remove(set, 42));
+    EXPECT_FALSE(HashSet_Remove(set, 5000));
+    EXPECT_EQ(2500, HashSet_NumElements(set));
+
+    for (HTKey_t key = 0; key < 5001; key++) {
+      ASSERT_EQ(key % 2 == 1 && key < 5000, HashSet_Contains(set, key));
+    }
+    EXPECT_TRUE(HashSet_Add(set, 42));
+    EXPECT_TRUE(HashSet_Contains(set, 42));
+    HashSet_Free(set);
+  }
+}
+
+TEST(Test_HashSet, ContainsBatch) {
+  HashSet *set = HashSet_Allocate(2, 0);
+  std::vector<HTKey_t> keys;
+
+  for (HTKey_t key = 0; key < 10000; key += 3) {
+    HashSet_Add(set, key);
+  }
+  // An odd length, so the last batch is a partial one.
+  for (HTKey_t key = 0; key < 1001; key++) {
+    keys.push_back(key * 7);
+  }
+  bool results[1001];
+  int expected = 0;
+  for (HTKey_t key : keys) {
+    expected += key % 3 == 0;
+  }
+  EXPECT_EQ(expected, HashSet_ContainsBatch(set, keys.data(), 1001, results));
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_EQ(keys[i] % 3 == 0, results[i]);
+  }
+  EXPECT_EQ(0, HashSet_ContainsBatch(set, keys.data(), 0, results));
+  HashSet_Free(set);
+}
+
+TEST(Test_HashSet, RejectsUnsupportedFlags) {
+  EXPECT_EQ(nullptr, HashSet_Allocate(2, HT_FLAG_MULTIMAP));
+  EXPECT_EQ(nullptr, HashSet_Allocate(2, HT_FLAG_CUCKOO));
+}
+
+}  // namespace hw0
@@ -0,0 +1,773 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <thread>
+#include <vector>
+
+extern "C" {
+  #include "./HashTable.h"
+  #include "./HashTable_priv.h"
+  #include "./LinkedList_priv.h"
+}
+
+#include "gtest/gtest.h"
+#include "./test_util.h"
+
+namespace hw0 {
+
+TEST(Test_HashTable, InsertFindRemove) {
+  HashTable *table = HashTable_Allocate(2);
+  HTKeyValue_t kv, old;
+
+  ASSERT_NE(nullptr, table);
+  EXPECT_FALSE(HashTable_Insert(table, KV(1, 10), &old));
+  EXPECT_TRUE(HashTable_Insert(table, KV(1, 11), &old));
+  EXPECT_EQ(V(10), old.value);
+  EXPECT_EQ(1, HashTable_NumElements(table));
+
+  ASSERT_TRUE(HashTable_Find(table, 1, &kv));
+  EXPECT_EQ(V(11), kv.value);
+  ASSERT_TRUE(HashTable_Remove(table, 1, &kv));
+  EXPECT_EQ(V(11), kv.value);
+  EXPECT_FALSE(HashTable_Find(table, 1, &kv));
+  EXPECT_EQ(0, HashTable_NumElements(table));
+  HashTable_Free(table, nullptr);
+}
+
+// The fingerprint tag words must never turn a present key into a miss,
+// across resizes and after removals clear bits out of them.
+TEST(Test_HashTable, FingerprintTagsNeverHideKeys) {
+  const int kNumKeys = 20000;
+  HashTable *table = HashTable_Allocate(2);
+  HTKeyValue_t kv;
+
+  for (int i = 0; i < kNumKeys; i++) {
+    HashTable_Insert(table, KV(i * 2, i), &kv);
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_TRUE(HashTable_Find(table, i * 2, &kv));
+    EXPECT_EQ(V(i), kv.value);
+    EXPECT_FALSE(HashTable_Find(table, i * 2 + 1, &kv));
+  }
+
+  // Remove every other key; the survivors must still be found, and the
+  // removed ones must now miss.
+  for (int i = 0; i < kNumKeys; i += 2) {
+    ASSERT_TRUE(HashTable_Remove(table, i * 2, &kv));
+    EXPECT_FALSE(HashTable_Remove(table, i * 2, &kv));
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    EXPECT_EQ(i % 2 == 1, HashTable_Find(table, i * 2, &kv));
+  }
+  EXPECT_EQ(kNumKeys / 2, HashTable_NumElements(table));
+  HashTable_Free(table, nullptr);
+}
+
+// Sleeps long enough for a TTL of a few milliseconds to pass.
+static void SleepMs(int ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+TEST(Test_HashTable, TTLExpiry) {
+  HashTable *table = HashTable_Allocate(2);
+  HTKeyValue_t kv, old;
+
+  EXPECT_FALSE(HashTable_InsertWithTTL(table, KV(1, 10), 1, &old));
+  EXPECT_FALSE(HashTable_InsertWithTTL(table, KV(2, 20), 60000, &old));
+  HashTable_Insert(table, KV(3, 30), &old);
+  SleepMs(20);
+
+  // An expired entry is a miss at once, but is only removed (and its
+  // value handed back) by HashTable_ExpireEntries.
+  EXPECT_FALSE(HashTable_Find(table, 1, &kv));
+  EXPECT_TRUE(HashTable_Find(table, 2, &kv));
+  EXPECT_TRUE(HashTable_Find(table, 3, &kv));
+  EXPECT_EQ(3, HashTable_NumElements(table));
+  EXPECT_EQ(1, HashTable_ExpireEntries(table, 0, nullptr));
+  EXPECT_EQ(2, HashTable_NumElements(table));
+  EXPECT_EQ(0, HashTable_ExpireEntries(table, 0, nullptr));
+
+  // Re-inserting a key without a TTL clears its timer's effect.
+  HashTable_InsertWithTTL(table, KV(4, 40), 1, &old);
+  EXPECT_TRUE(HashTable_Insert(table, KV(4, 41), &old));
+  SleepMs(20);
+  EXPECT_EQ(0, HashTable_ExpireEntries(table, 0, nullptr));
+  ASSERT_TRUE(HashTable_Find(table, 4, &kv));
+  EXPECT_EQ(V(41), kv.value);
+  HashTable_Free(table, nullptr);
+}
+
+// Keys spread over all 64 bits, so that every radix pass has work to do.
+static HTKey_t SpreadKey(int i) {
+  return (static_cast<uint64_t>(i) * 0x9e3779b97f4a7c15ULL) ^ (i >> 3);
+}
+
+TEST(Test_HashTable, SortedSnapshot) {
+  const int kNumKeys = 50000;
+  HashTable *table = HashTable_Allocate(2);
+  HTKeyValue_t *snapshot = nullptr, old;
+
+  for (int i = 0; i < kNumKeys; i++) {
+    HashTable_Insert(table, KV(SpreadKey(i), i), &old);
+  }
+  HashTable_InsertWithTTL(table, KV(SpreadKey(kNumKeys), -1), 1, &old);
+  SleepMs(20);
+
+  // Single- and multi-threaded sorts agree, and leave out expired entries.
+  for (int threads = 1; threads <= 4; threads *= 4) {
+    ASSERT_EQ(kNumKeys, HashTable_SortedSnapshot(table, &snapshot, threads));
+    for (int i = 1; i < kNumKeys; i++) {
+      ASSERT_LT(snapshot[i - 1].key, snapshot[i].key);
+    }
+    for (int i = 0; i < kNumKeys; i++) {
+      HTKeyValue_t kv;
+      ASSERT_TRUE(HashTable_Find(table, snapshot[i].key, &kv));
+      EXPECT_EQ(kv.value, snapshot[i].value);
+    }
+  }
+  free(snapshot);
+
+  HashTable_Free(table, nullptr);
+  table = HashTable_Allocate(2);
+  snapshot = nullptr;
+  EXPECT_EQ(0, HashTable_SortedSnapshot(table, &snapshot, 1));
+  free(snapshot);
+  HashTable_Free(table, nullptr);
+}
+
+// Sums two integer values, for HashTable_Upsert.
+static HTValue_t AddValues(HTValue_t oldvalue, HTValue_t newvalue) {
+  return V(reinterpret_cast<intptr_t>(oldvalue) +
+           reinterpret_cast<intptr_t>(newvalue));
+}
+
+TEST(Test_HashTable, FindOrInsertAndUpsert) {
+  HashTable *table = HashTable_Allocate(2);
+  HTValue_t *slot, expired;
+  HTKeyValue_t kv;
+  bool inserted;
+
+  slot = HashTable_FindOrInsert(table, 7, &inserted);
+  ASSERT_NE(nullptr, slot);
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(nullptr, *slot);
+  *slot = V(70);
+  slot = HashTable_FindOrInsert(table, 7, &inserted);
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(V(70), *slot);
+
+  // Upsert counts occurrences of each key.
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(i >= 10 || i == 7,
+              HashTable_Upsert(table, KV(i % 10, 1), &AddValues,
+                               &expired));
+    EXPECT_EQ(nullptr, expired);
+  }
+  for (int k = 0; k < 10; k++) {
+    ASSERT_TRUE(HashTable_Find(table, k, &kv));
+    EXPECT_EQ(V(k == 7 ? 170 : 100), kv.value);
+  }
+  EXPECT_EQ(10, HashTable_NumElements(table));
+  HashTable_Free(table, nullptr);
+}
+
+// An entry whose TTL has passed but which hasn't been reaped yet is absent
+// as far as FindOrInsert and Upsert are concerned, just as for Find, and
+// whatever they store must be found afterwards.
+TEST(Test_HashTable, FindOrInsertAndUpsertIgnoreExpiredEntries) {
+  HashTable *table = HashTable_Allocate(2);
+  HTValue_t *slot, expired;
+  HTKeyValue_t kv, old;
+  bool inserted;
+
+  HashTable_InsertWithTTL(table, KV(1, 10), 1, &old);
+  HashTable_InsertWithTTL(table, KV(2, 20), 1, &old);
+  SleepMs(20);
+
+  slot = HashTable_FindOrInsert(table, 1, &inserted);
+  ASSERT_NE(nullptr, slot);
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(V(10), *slot);  // the expired value, for us to free
+  *slot = V(99);
+  ASSERT_TRUE(HashTable_Find(table, 1, &kv));
+  EXPECT_EQ(V(99), kv.value);
+
+  EXPECT_FALSE(HashTable_Upsert(table, KV(2, 5), &AddValues, &expired));
+  EXPECT_EQ(V(20), expired);
+  ASSERT_TRUE(HashTable_Find(table, 2, &kv));
+  EXPECT_EQ(V(5), kv.value);
+  EXPECT_EQ(2, HashTable_NumElements(table));
+
+  // Both entries lost their TTLs, so their stale timers reap nothing.
+  EXPECT_EQ(0, HashTable_ExpireEntries(table, 0, nullptr));
+  EXPECT_EQ(2, HashTable_NumElements(table));
+  HashTable_Free(table, nullptr);
+}
+
+// Counts the values handed to it, for HashTable_Free.
+static int num_freed;
+static void CountFree(HTValue_t value) {
+  num_freed++;
+}
+
+// An arena-backed table behaves like any other, and still hands every
+// value back when it is torn down in one go.
+TEST(Test_HashTable, ArenaBackedTable) {
+  HashTable *table = HashTable_AllocateWithFlags(2, HT_FLAG_ARENA);
+  HTKeyValue_t kv;
+
+  ASSERT_NE(nullptr, table);
+  ASSERT_NE(nullptr, HashTable_GetArena(table));
+  for (int i = 0; i < 10000; i++) {
+    HashTable_Insert(table, KV(i, i), &kv);
+  }
+  for (int i = 0; i < 10000; i += 2) {
+    ASSERT_TRUE(HashTable_Remove(table, i, &kv));
+  }
+  for (int i = 0; i < 10000; i++) {
+    EXPECT_EQ(i % 2 == 1, HashTable_Find(table, i, &kv));
+  }
+  num_freed = 0;
+  HashTable_Free(table, &CountFree);
+  EXPECT_EQ(5000, num_freed);
+
+  table = HashTable_Allocate(2);
+  EXPECT_EQ(nullptr, HashTable_GetArena(table));
+  HashTable_Free(table, nullptr);
+}
+
+// Multimap entries for a key come back most recently inserted first, and
+// Find/Remove act on the newest one.
+TEST(Test_HashTable, MultimapKeepsEveryValue) {
+  HashTable *table = HashTable_AllocateWithFlags(2, HT_FLAG_MULTIMAP);
+  HTKeyValue_t kv, old;
+  HTKeyCursor cursor;
+
+  ASSERT_NE(nullptr, table);
+  for (int i = 0; i < 3000; i++) {
+    EXPECT_FALSE(HashTable_Insert(table, KV(i % 500, i), &old));
+  }
+  EXPECT_EQ(3000, HashTable_NumElements(table));
+
+  for (int key = 0; key < 500; key++) {
+    int count = 0;
+    HashTable_FindAll(table, key, &cursor);
+    while (HTKeyCursor_Next(&cursor, &kv)) {
+      EXPECT_EQ(key, static_cast<int>(kv.key));
+      EXPECT_EQ(V(key + 500 * (5 - count)), kv.value);
+      count++;
+    }
+    EXPECT_EQ(6, count);
+    EXPECT_EQ(6, HashTable_CountKey(table, key, 0));
+    EXPECT_EQ(2, HashTable_CountKey(table, key, 2));
+  }
+
+  ASSERT_TRUE(HashTable_Find(table, 7, &kv));
+  EXPECT_EQ(V(2507), kv.value);
+  ASSERT_TRUE(HashTable_Remove(table, 7, &kv));
+  EXPECT_EQ(V(2507), kv.value);
+  ASSERT_TRUE(HashTable_Find(table, 7, &kv));
+  EXPECT_EQ(V(2007), kv.value);
+  EXPECT_EQ(5, HashTable_CountKey(table, 7, 0));
+
+  HashTable_FindAll(table, 9999, &cursor);
+  EXPECT_FALSE(HTKeyCursor_Next(&cursor, &kv));
+  EXPECT_EQ(0, HashTable_CountKey(table, 9999, 0));
+  HashTable_Free(table, nullptr);
+}
+
+// Collects join results as (left key, right key, left value, right value)
+// rows, with -1 standing in for a missing side.
+struct JoinResults {
+  std::mutex lock;
+  std::multiset<std::tuple<int, int, intptr_t, intptr_t>> rows;
+};
+
+static void CollectJoin(const HTKeyValue_t *left,
+                        const HTKeyValue_t *right,
+                        void *arg) {
+  JoinResults *results = static_cast<JoinResults *>(arg);
+  std::lock_guard<std::mutex> guard(results->lock);
+  results->rows.insert(std::make_tuple(
+      left ? static_cast<int>(left->key) : -1,
+      right ? static_cast<int>(right->key) : -1,
+      left ? reinterpret_cast<intptr_t>(left->value) : -1,
+      right ? reinterpret_cast<intptr_t>(right->value) : -1));
+}
+
+// left has keys 0..1999 and right has 1000..2999 (key 1500 twice, as a
+// multimap), so each operation's output is easy to spell out.
+TEST(Test_HashTable, JoinAndSetOperations) {
+  HashTable *left = HashTable_Allocate(2);
+  HashTable *right = HashTable_AllocateWithFlags(2, HT_FLAG_MULTIMAP);
+  HTKeyValue_t old;
+
+  for (int i = 0; i < 2000; i++) {
+    HashTable_Insert(left, KV(i, i), &old);
+    HashTable_Insert(right, KV(i + 1000, -i), &old);
+  }
+  HashTable_Insert(right, KV(1500, 7), &old);
+
+  for (int threads : {1, 4}) {
+    JoinResults join, inter, uni, diff;
+
+    EXPECT_EQ(1001, HashTable_Join(left, right, &CollectJoin, &join,
+                                   threads));
+    ASSERT_EQ(1001u, join.rows.size());
+    EXPECT_EQ(1u, join.rows.count(std::make_tuple(1500, 1500, 1500, 7)));
+    EXPECT_EQ(1u, join.rows.count(std::make_tuple(1500, 1500, 1500, -500)));
+    EXPECT_EQ(1u, join.rows.count(std::make_tuple(1999, 1999, 1999, -999)));
+
+    EXPECT_EQ(1000, HashTable_Intersect(left, right, &CollectJoin, &inter,
+                                        threads));
+    ASSERT_EQ(1000u, inter.rows.size());
+    for (auto &row : inter.rows) {
+      EXPECT_EQ(std::get<0>(row), std::get<1>(row));
+      EXPECT_GE(std::get<0>(row), 1000);
+    }
+
+    EXPECT_EQ(3000, HashTable_Union(left, right, &CollectJoin, &uni,
+                                    threads));
+    ASSERT_EQ(3000u, uni.rows.size());
+    EXPECT_EQ(1u, uni.rows.count(std::make_tuple(5, -1, 5, -1)));
+    EXPECT_EQ(1u, uni.rows.count(std::make_tuple(-1, 2500, -1, -1500)));
+
+    EXPECT_EQ(1000, HashTable_Difference(left, right, &CollectJoin, &diff,
+                                         threads));
+    ASSERT_EQ(1000u, diff.rows.size());
+    for (auto &row : diff.rows) {
+      EXPECT_LT(std::get<0>(row), 1000);
+      EXPECT_EQ(-1, std::get<1>(row));
+    }
+  }
+  HashTable_Free(left, nullptr);
+  HashTable_Free(right, nullptr);
+}
+
+// A cuckoo-mode table answers through the ordinary HashTable interface,
+// and refuses flags it can't honor.
+TEST(Test_HashTable, CuckooMode) {
+  HashTable *table = HashTable_AllocateWithFlags(1000, HT_FLAG_CUCKOO);
+  HTKeyValue_t kv, old;
+  HTKeyCursor cursor;
+
+  ASSERT_NE(nullptr, table);
+  for (int i = 0; i < 5000; i++) {
+    EXPECT_FALSE(HashTable_Insert(table, KV(i, i), &old));
+  }
+  EXPECT_TRUE(HashTable_Insert(table, KV(0, 100), &old));
+  EXPECT_EQ(V(0), old.value);
+  for (int i = 0; i < 5000; i += 2) {
+    ASSERT_TRUE(HashTable_Remove(table, i + 1, &kv));
+  }
+  EXPECT_EQ(2500, HashTable_NumElements(table));
+
+  HashTable_FindAll(table, 0, &cursor);
+  ASSERT_TRUE(HTKeyCursor_Next(&cursor, &kv));
+  EXPECT_EQ(V(100), kv.value);
+  EXPECT_FALSE(HTKeyCursor_Next(&cursor, &kv));
+  EXPECT_EQ(0, HashTable_CountKey(table, 1, 0));
+
+  int visited = 0;
+  HTIterator *iter = HTIterator_Allocate(table);
+  while (HTIterator_IsValid(iter)) {
+    ASSERT_TRUE(HTIterator_Get(iter, &kv));
+    EXPECT_EQ(0, static_cast<int>(kv.key) % 2);
+    visited++;
+    HTIterator_Next(iter);
+  }
+  HTIterator_Free(iter);
+  EXPECT_EQ(2500, visited);
+  HashTable_Free(table, nullptr);
+
+  EXPECT_EQ(nullptr, HashTable_AllocateWithFlags(
+                         2, HT_FLAG_CUCKOO | HT_FLAG_MULTIMAP));
+  EXPECT_EQ(nullptr, HashTable_AllocateWithFlags(
+                         2, HT_FLAG_CUCKOO | HT_FLAG_ARENA));
+}
+
+// Keys that agree in all of their low bits would pile into one bucket if
+// the table used them directly; under the per-table seed they spread out.
+TEST(Test_HashTable, SeededHashingSpreadsCollidingKeys) {
+  HashTable *table = HashTable_Allocate(64);
+  HTKeyValue_t kv, old;
+
+  for (int i = 0; i < 20000; i++) {
+    HashTable_Insert(table, KV(static_cast<HTKey_t>(i) << 32, i), &old);
+  }
+  EXPECT_LE(HashTable_LongestChain(table), 16);
+  for (int i = 0; i < 20000; i++) {
+    ASSERT_TRUE(HashTable_Find(table, static_cast<HTKey_t>(i) << 32, &kv));
+    EXPECT_EQ(V(i), kv.value);
+  }
+  HashTable_Free(table, nullptr);
+
+  table = HashTable_AllocateWithFlags(1000, HT_FLAG_CUCKOO);
+  EXPECT_EQ(0, HashTable_LongestChain(table));
+  HashTable_Free(table, nullptr);
+}
+
+// Returns n distinct keys that the table currently maps to the given
+// bucket.
+static std::vector<HTKey_t> KeysInBucket(HashTable *table, int bucket,
+                                         int n) {
+  std::vector<HTKey_t> keys;
+
+  for (HTKey_t key = 1; static_cast<int>(keys.size()) < n; key++) {
+    if (HashKeyToBucketNum(table, key) == bucket) {
+      keys.push_back(key);
+    }
+  }
+  return keys;
+}
+
+// Checks that a bucket tree is an AVL tree ordered by key, each of whose
+// nodes points at a chain node with its key, and returns its height.
+static int CheckTree(HTTreeNode *tnode) {
+  if (tnode == nullptr) {
+    return 0;
+  }
+  if (tnode->left != nullptr) {
+    EXPECT_LT(tnode->left->key, tnode->key);
+  }
+  if (tnode->right != nullptr) {
+    EXPECT_GT(tnode->right->key, tnode->key);
+  }
+  EXPECT_EQ(tnode->key,
+            static_cast<HTEntry *>(tnode->chain_node->payload)->kv.key);
+
+  int lh = CheckTree(tnode->left), rh = CheckTree(tnode->right);
+  EXPECT_LE(abs(lh - rh), 1);
+  EXPECT_EQ(1 + std::max(lh, rh), tnode->height);
+  return tnode->height;
+}
+
+// A bucket that grows past HT_TREEIFY_THRESHOLD entries gets a tree, and
+// loses it again once it shrinks below HT_UNTREEIFY_THRESHOLD; lookups
+// give the same answers either way.
+TEST(Test_HashTable, TreeifiesLongBuckets) {
+  HashTable *table = HashTable_Allocate(100);
+  std::vector<HTKey_t> keys = KeysInBucket(table, 5, 201);
+  HTKey_t absent = keys.back();
+  HTKeyValue_t kv, old;
+
+  keys.pop_back();
+  for (size_t i = 0; i < keys.size(); i++) {
+    HashTable_Insert(table, KV(keys[i], i), &old);
+    bool treeified = i + 1 > HT_TREEIFY_THRESHOLD;
+    ASSERT_EQ(treeified, table->bucket_trees != nullptr &&
+                         table->bucket_trees[5] != nullptr);
+  }
+  EXPECT_EQ(100, table->num_buckets);  // no resize hid the collisions
+  EXPECT_EQ(200, HashTable_LongestChain(table));
+  EXPECT_EQ(~0ULL, table->bucket_tags[5]);
+  CheckTree(table->bucket_trees[5]);
+
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_TRUE(HashTable_Find(table, keys[i], &kv));
+    EXPECT_EQ(V(i), kv.value);
+  }
+  EXPECT_FALSE(HashTable_Find(table, absent, &kv));
+
+  // Remove all but five, checking the tree as the bucket shrinks.
+  for (size_t i = 0; i + 5 < keys.size(); i++) {
+    ASSERT_TRUE(HashTable_Remove(table, keys[i], &kv));
+    EXPECT_EQ(V(i), kv.value);
+    if (table->bucket_trees[5] != nullptr) {
+      CheckTree(table->bucket_trees[5]);
+    }
+  }
+  EXPECT_EQ(nullptr, table->bucket_trees[5]);
+  EXPECT_NE(~0ULL, table->bucket_tags[5]);
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_EQ(i + 5 >= keys.size(), HashTable_Find(table, keys[i], &kv));
+  }
+  HashTable_Free(table, nullptr);
+}
+
+// Iteration, iterator removal and multimap runs behave the same in a
+// treeified bucket.
+TEST(Test_HashTable, TreeifiedBucketsKeepIteratorsAndRuns) {
+  HashTable *table = HashTable_AllocateWithFlags(100, HT_FLAG_MULTIMAP);
+  std::vector<HTKey_t> keys = KeysInBucket(table, 9, 40);
+  std::map<HTKey_t, int> counts;
+  HTKeyValue_t kv, old;
+  HTKeyCursor cursor;
+
+  // Three values per key, interleaved, newest last.
+  for (int round = 0; round < 3; round++) {
+    for (HTKey_t key : keys) {
+      HashTable_Insert(table, KV(key, round), &old);
+      counts[key]++;
+    }
+  }
+  ASSERT_NE(nullptr, table->bucket_trees);
+  ASSERT_NE(nullptr, table->bucket_trees[9]);
+  CheckTree(table->bucket_trees[9]);
+
+  for (HTKey_t key : keys) {
+    int round = 2;
+    HashTable_FindAll(table, key, &cursor);
+    while (HTKeyCursor_Next(&cursor, &kv)) {
+      EXPECT_EQ(V(round), kv.value);
+      round--;
+    }
+    EXPECT_EQ(-1, round);
+  }
+
+  // Remove every other entry through an iterator.
+  HTIterator *iter = HTIterator_Allocate(table);
+  int visited = 0;
+  while (HTIterator_IsValid(iter)) {
+    if (visited++ % 2 == 0) {
+      ASSERT_TRUE(HTIterator_Remove(iter, &kv));
+      counts[kv.key]--;
+    } else {
+      HTIterator_Next(iter);
+    }
+  }
+  HTIterator_Free(iter);
+  EXPECT_EQ(120, visited);
+  EXPECT_EQ(60, HashTable_NumElements(table));
+  if (table->bucket_trees[9] != nullptr) {
+    CheckTree(table->bucket_trees[9]);
+  }
+  for (HTKey_t key : keys) {
+    EXPECT_EQ(counts[key], HashTable_CountKey(table, key, 0));
+  }
+  HashTable_Free(table, nullptr);
+}
+
+// The memory placement flags imply HT_FLAG_ARENA and don't change what
+// the table does.
+TEST(Test_HashTable, MemoryPolicyFlags) {
+  const int flags[] = {
+    HT_FLAG_HUGE_PAGES,
+    HT_FLAG_HUGETLB | HT_FLAG_NUMA_LOCAL,
+    HT_FLAG_NUMA_INTERLEAVE | HT_FLAG_MULTIMAP,
+  };
+  HTKeyValue_t kv, old;
+
+  for (int flag : flags) {
+    SCOPED_TRACE(flag);
+    HashTable *table = HashTable_AllocateWithFlags(2, flag);
+    ASSERT_NE(nullptr, table);
+    EXPECT_NE(nullptr, HashTable_GetArena(table));
+    for (int i = 0; i < 50000; i++) {
+      HashTable_Insert(table, KV(i, i), &old);
+    }
+    for (int i = 0; i < 50000; i += 7) {
+      ASSERT_TRUE(HashTable_Find(table, i, &kv));
+      EXPECT_EQ(V(i), kv.value);
+    }
+    HashTable_Free(table, nullptr);
+  }
+  EXPECT_EQ(nullptr, HashTable_AllocateWithFlags(
+                         2, HT_FLAG_NUMA_INTERLEAVE | HT_FLAG_NUMA_LOCAL));
+  EXPECT_EQ(nullptr, HashTable_AllocateWithFlags(
+                         2, HT_FLAG_CUCKOO | HT_FLAG_HUGE_PAGES));
+}
+
+static bool KeyDivisibleBy(const HTKeyValue_t *keyvalue, void *arg) {
+  return keyvalue->key % *static_cast<HTKey_t *>(arg) == 0;
+}
+
+// RemoveIf removes exactly the matching entries, whatever the table's
+// mode, and frees each of their values once.
+TEST(Test_HashTable, RemoveIf) {
+  const int flags[] = { 0, HT_FLAG_ARENA, HT_FLAG_MULTIMAP, HT_FLAG_CUCKOO };
+  HTKey_t divisor = 3;
+  HTKeyValue_t kv, old;
+
+  for (int flag : flags) {
+    SCOPED_TRACE(flag);
+    HashTable *table = HashTable_AllocateWithFlags(2, flag);
+    for (int i = 0; i < 30000; i++) {
+      HashTable_Insert(table, KV(i, i), &old);
+    }
+    if (flag & HT_FLAG_MULTIMAP) {
+      for (int i = 0; i < 30000; i += 2) {
+        HashTable_Insert(table, KV(i, i), &old);
+      }
+    }
+    int before = HashTable_NumElements(table);
+
+    num_freed = 0;
+    int removed = HashTable_RemoveIf(table, &KeyDivisibleBy, &divisor,
+                                     &CountFree);
+    EXPECT_EQ(flag & HT_FLAG_MULTIMAP ? 15000 : 10000, removed);
+    EXPECT_EQ(removed, num_freed);
+    EXPECT_EQ(before - removed, HashTable_NumElements(table));
+    for (int i = 0; i < 30000; i++) {
+      ASSERT_EQ(i % 3 != 0, HashTable_Find(table, i, &kv));
+    }
+    EXPECT_EQ(0, HashTable_RemoveIf(table, &KeyDivisibleBy, &divisor,
+                                    nullptr));
+    HashTable_Free(table, nullptr);
+  }
+}
+
+TEST(Test_HashTable, RemoveIfDropsExpiredEntries) {
+  HashTable *table = HashTable_Allocate(2);
+  HTKey_t divisor = 1000;
+  HTKeyValue_t old;
+
+  HashTable_Insert(table, KV(1, 1), &old);
+  HashTable_Insert(table, KV(1000, 1000), &old);
+  HashTable_InsertWithTTL(table, KV(2, 2), 1, &old);
+  SleepMs(20);
+  EXPECT_EQ(2, HashTable_RemoveIf(table, &KeyDivisibleBy, &divisor,
+                                  nullptr));
+  EXPECT_EQ(1, HashTable_NumElements(table));
+  HashTable_Free(table, nullptr);
+}
+
+static bool KeyIs(const HTKeyValue_t *keyvalue, void *arg) {
+  return keyvalue->key == *static_cast<HTKey_t *>(arg);
+}
+
+// Every nonempty bucket keeps its first entry in its record, and a bucket
+// is empty exactly when its tag word is zero.  The records are aligned to
+// their size, so none straddles a cache line.
+TEST(Test_HashTable, BucketRecordsHoldFirstEntries) {
+  static_assert(sizeof(HTBucket) == 32, "a bucket record is 32 bytes");
+  HashTable *table = HashTable_Allocate(2);
+  std::set<HTKey_t> seen;
+  HTKeyValue_t old;
+  int first = 0;
+
+  for (int i = 0; i < 5000; i++) {
+    HashTable_Insert(table, KV(i, i), &old);
+  }
+  for (int i = 0; i < 5000; i += 2) {
+    HashTable_Remove(table, i, &old);
+  }
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(table->buckets) %
+                sizeof(HTBucket));
+
+  for (int b = 0; b < table->num_buckets; b++) {
+    HTBucket *record = &table->buckets[b];
+    LinkedListNode *node =
+        record->overflow != nullptr ? record->overflow->head : nullptr;
+
+    if (table->bucket_tags[b] == 0) {
+      EXPECT_EQ(nullptr, node);
+      continue;
+    }
+    first++;
+    EXPECT_EQ(b, HashKeyToBucketNum(table, record->first.kv.key));
+    EXPECT_EQ(V(record->first.kv.key), record->first.kv.value);
+    seen.insert(record->first.kv.key);
+    for (; node != nullptr; node = node->next) {
+      HTEntry *entry = static_cast<HTEntry *>(node->payload);
+
+      EXPECT_EQ(b, HashKeyToBucketNum(table, entry->kv.key));
+      seen.insert(entry->kv.key);
+    }
+  }
+  EXPECT_EQ(2500u, seen.size());
+  EXPECT_EQ(2500, HashTable_NumElements(table));
+  EXPECT_GT(first, 2500 / 2);  // most entries are first in their bucket
+  HashTable_Free(table, nullptr);
+}
+
+// Removing a bucket's first entry moves the next one up into its place,
+// whether it goes by key, through an iterator, or by HashTable_RemoveIf.
+TEST(Test_HashTable, RemovingFirstEntryPromotesOverflow) {
+  HashTable *table = HashTable_Allocate(100);
+  std::vector<HTKey_t> keys = KeysInBucket(table, 7, 4);
+  HTBucket *record = &table->buckets[7];
+  HTKeyValue_t kv, old;
+  HTKey_t doomed;
+
+  for (int i = 0; i < 4; i++) {
+    HashTable_Insert(table, KV(keys[i], i), &old);
+  }
+  EXPECT_EQ(keys[0], record->first.kv.key);
+  EXPECT_EQ(4, HashTable_LongestChain(table));
+
+  ASSERT_TRUE(HashTable_Remove(table, keys[0], &kv));
+  EXPECT_EQ(V(0), kv.value);
+  EXPECT_EQ(keys[1], record->first.kv.key);
+
+  // Bucket 7 is the only nonempty one, so the iterator starts on its first
+  // entry, and stays there as the next entry moves up.
+  HTIterator *iter = HTIterator_Allocate(table);
+  ASSERT_TRUE(HTIterator_Remove(iter, &kv));
+  EXPECT_EQ(keys[1], kv.key);
+  ASSERT_TRUE(HTIterator_Get(iter, &kv));
+  EXPECT_EQ(keys[2], kv.key);
+  EXPECT_EQ(keys[2], record->first.kv.key);
+  HTIterator_Free(iter);
+
+  doomed = keys[2];
+  EXPECT_EQ(1, HashTable_RemoveIf(table, &KeyIs, &doomed, nullptr));
+  EXPECT_EQ(keys[3], record->first.kv.key);
+  ASSERT_TRUE(HashTable_Find(table, keys[3], &kv));
+  EXPECT_EQ(V(3), kv.value);
+
+  ASSERT_TRUE(HashTable_Remove(table, keys[3], &kv));
+  EXPECT_EQ(0u, table->bucket_tags[7]);
+  EXPECT_EQ(0, HashTable_NumElements(table));
+  EXPECT_FALSE(HashTable_Find(table, keys[3], &kv));
+  HashTable_Free(table, nullptr);
+}
+
+// In a multimap, a new entry whose key's run starts in the first slot
+// takes the slot, and the run carries on into the overflow chain.
+TEST(Test_HashTable, MultimapRunsSpanTheFirstSlot) {
+  HashTable *table = HashTable_AllocateWithFlags(100, HT_FLAG_MULTIMAP);
+  std::vector<HTKey_t> keys = KeysInBucket(table, 3, 2);
+  HTKeyValue_t kv, old;
+  HTKeyCursor cursor;
+  int count = 0;
+
+  HashTable_Insert(table, KV(keys[0], 0), &old);
+  HashTable_Insert(table, KV(keys[1], 100), &old);
+  HashTable_Insert(table, KV(keys[0], 1), &old);
+  HashTable_Insert(table, KV(keys[0], 2), &old);
+  EXPECT_EQ(keys[0], table->buckets[3].first.kv.key);
+  EXPECT_EQ(V(2), table->buckets[3].first.kv.value);
+
+  HashTable_FindAll(table, keys[0], &cursor);
+  while (HTKeyCursor_Next(&cursor, &kv)) {
+    EXPECT_EQ(V(2 - count), kv.value);
+    count++;
+  }
+  EXPECT_EQ(3, count);
+  EXPECT_EQ(1, HashTable_CountKey(table, keys[1], 0));
+
+  ASSERT_TRUE(HashTable_Remove(table, keys[0], &kv));
+  EXPECT_EQ(V(2), kv.value);
+  EXPECT_EQ(V(1), table->buckets[3].first.kv.value);
+  EXPECT_EQ(2, HashTable_CountKey(table, keys[0], 0));
+
+  HTIterator *iter = HTIterator_Allocate(table);
+  count = 0;
+  while (HTIterator_Remove(iter, &kv)) {
+    count++;
+  }
+  HTIterator_Free(iter);
+  EXPECT_EQ(3, count);
+  EXPECT_EQ(0, HashTable_NumElements(table));
+  HashTable_Free(table, nullptr);
+}
+
+}  // namespace hw0
@@ -0,0 +1,115 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+
+#include <thread>
+
+extern "C" {
+  #include "./HashTable.h"
+  #include "./LatencyStats.h"
+  #include "./LinkedList.h"
+}
+
+#include "gtest/gtest.h"
+#include "./test_util.h"
+
+namespace hw0 {
+
+TEST(Test_LatencyStats, OffByDefaultAndAfterReset) {
+  HashTable *table = HashTable_Allocate(2);
+  HTKeyValue_t kv;
+  LatencySummary summary;
+
+  LatencyStats_Reset();
+  EXPECT_FALSE(LatencyStats_IsEnabled());
+  HashTable_Insert(table, KV(1, 1), &kv);
+  HashTable_Find(table, 1, &kv);
+  LatencyStats_Summarize(LAT_HT_FIND, &summary);
+  EXPECT_EQ(0u, summary.count);
+  EXPECT_EQ(0.0, summary.max);
+  HashTable_Free(table, nullptr);
+}
+
+// Calls from several threads are all counted, and the percentiles come
+// out in order.
+TEST(Test_LatencyStats, CountsEveryThreadsCalls) {
+  LatencySummary summary;
+
+  LatencyStats_Reset();
+  LatencyStats_Enable(true);
+  ASSERT_TRUE(LatencyStats_IsEnabled());
+
+  std::thread threads[4];
+  for (std::thread &thread : threads) {
+    thread = std::thread([] {
+      HashTable *table = HashTable_Allocate(2);
+      HTKeyValue_t kv;
+
+      for (int i = 0; i < 1000; i++) {
+        HashTable_Insert(table, KV(i, i), &kv);
+        HashTable_Find(table, i, &kv);
+      }
+      HashTable_Remove(table, 0, &kv);
+      HashTable_Free(table, nullptr);
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  LatencyStats_Enable(false);
+
+  LatencyStats_Summarize(LAT_HT_INSERT, &summary);
+  uint64_t inserts = summary.count;
+  LatencyStats_Summarize(LAT_HT_INSERT_RESIZE, &summary);
+  EXPECT_GT(summary.count, 0u);
+  EXPECT_EQ(4000u, inserts + summary.count);
+
+  LatencyStats_Summarize(LAT_HT_FIND, &summary);
+  EXPECT_EQ(4000u, summary.count);
+  EXPECT_LE(summary.p50, summary.p99);
+  EXPECT_LE(summary.p99, summary.p999);
+  EXPECT_LE(summary.p999, summary.max);
+  EXPECT_GT(summary.max, 0.0);
+
+  LatencyStats_Summarize(LAT_HT_REMOVE, &summary);
+  EXPECT_EQ(4u, summary.count);
+
+  // The table's chains are LinkedLists too, so measure the list calls on
+  // their own.
+  LinkedList *list = LinkedList_Allocate();
+  LLPayload_t payload;
+  LatencyStats_Reset();
+  LatencyStats_Enable(true);
+  for (int i = 0; i < 1000; i++) {
+    LinkedList_Push(list, nullptr);
+    LinkedList_Pop(list, &payload);
+  }
+  LatencyStats_Enable(false);
+  LinkedList_Free(list, nullptr);
+  LatencyStats_Summarize(LAT_LL_PUSH, &summary);
+  EXPECT_EQ(1000u, summary.count);
+  LatencyStats_Summarize(LAT_LL_POP, &summary);
+  EXPECT_EQ(1000u, summary.count);
+
+  LatencyStats_Reset();
+  LatencyStats_Summarize(LAT_HT_FIND, &summary);
+  EXPECT_EQ(0u, summary.count);
+}
+
+TEST(Test_LatencyStats, OpNames) {
+  EXPECT_STREQ("HashTable_Find", LatencyStats_OpName(LAT_HT_FIND));
+  for (int op = 0; op < LAT_NUM_OPS; op++) {
+    ASSERT_NE(nullptr, LatencyStats_OpName(static_cast<LatencyOp>(op)));
+  }
+}
+
+}  // namespace hw0
@@ -0,0 +1,289 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <deque>
+#include <initializer_list>
+#include <vector>
+
+extern "C" {
+  #include "./LinkedList.h"
+}
+
+#include "gtest/gtest.h"
+#include "./test_util.h"
+
+namespace hw0 {
+
+static void NoOpFree(LLPayload_t payload) { }
+
+// Checks that list holds exactly the expected payloads, in order.
+static void ExpectContents(LinkedList *list,
+                           std::initializer_list<intptr_t> expected) {
+  LLIterator *iter = LLIterator_Allocate(list);
+  LLPayload_t payload;
+
+  ASSERT_EQ(static_cast<int>(expected.size()), LinkedList_NumElements(list));
+  for (intptr_t want : expected) {
+    ASSERT_TRUE(LLIterator_IsValid(iter));
+    LLIterator_Get(iter, &payload);
+    EXPECT_EQ(P(want), payload);
+    LLIterator_Next(iter);
+  }
+  EXPECT_FALSE(LLIterator_IsValid(iter));
+  LLIterator_Free(iter);
+}
+
+TEST(Test_LinkedList, PushPopAppendSlice) {
+  LinkedList *list = LinkedList_Allocate();
+  LLPayload_t payload;
+
+  ASSERT_NE(nullptr, list);
+  EXPECT_FALSE(LinkedList_Pop(list, &payload));
+  EXPECT_FALSE(LinkedList_Slice(list, &payload));
+
+  LinkedList_Push(list, P(2));
+  LinkedList_Push(list, P(1));
+  LinkedList_Append(list, P(3));
+  ExpectContents(list, {1, 2, 3});
+
+  ASSERT_TRUE(LinkedList_Pop(list, &payload));
+  EXPECT_EQ(P(1), payload);
+  ASSERT_TRUE(LinkedList_Slice(list, &payload));
+  EXPECT_EQ(P(3), payload);
+  ExpectContents(list, {2});
+  LinkedList_Free(list, &NoOpFree);
+}
+
+TEST(Test_LinkedList, AllocateInArena) {
+  Arena *arena = Arena_Allocate();
+  LinkedList *list = LinkedList_AllocateInArena(arena);
+  LLPayload_t payload;
+
+  ASSERT_NE(nullptr, list);
+  for (int i = 0; i < 1000; i++) {
+    LinkedList_Append(list, P(i));
+  }
+  for (int i = 0; i < 500; i++) {
+    ASSERT_TRUE(LinkedList_Pop(list, &payload));
+    EXPECT_EQ(P(i), payload);
+  }
+
+  // Freed nodes are recycled, so refilling the list reserves nothing new.
+  uint64_t reserved = Arena_NumBytesReserved(arena);
+  for (int i = 0; i < 500; i++) {
+    LinkedList_Push(list, P(i));
+  }
+  EXPECT_EQ(reserved, Arena_NumBytesReserved(arena));
+  EXPECT_EQ(1000, LinkedList_NumElements(list));
+
+  // Freeing the arena takes the list with it.
+  Arena_Free(arena);
+}
+
+// Checks that list holds exactly what the reference deque does, walking
+// it with an iterator.
+static void ExpectSame(LinkedList *list, const std::deque<intptr_t> &ref) {
+  LLIterator *iter = LLIterator_Allocate(list);
+  LLPayload_t payload;
+
+  ASSERT_EQ(static_cast<int>(ref.size()), LinkedList_NumElements(list));
+  for (intptr_t want : ref) {
+    ASSERT_TRUE(LLIterator_IsValid(iter));
+    LLIterator_Get(iter, &payload);
+    ASSERT_EQ(P(want), payload);
+    LLIterator_Next(iter);
+  }
+  LLIterator_Free(iter);
+}
+
+// A ring list wraps around its array and grows it as needed; random
+// operations at both ends and through an iterator must keep it in step
+// with a std::deque.
+TEST(Test_LinkedList, RingMatchesDeque) {
+  LinkedList *list = LinkedList_AllocateRing();
+  std::deque<intptr_t> ref;
+  LLPayload_t payload;
+
+  ASSERT_NE(nullptr, list);
+  srand(5);
+  for (intptr_t step = 0; step < 20000; step++) {
+    switch (rand() % 6) {
+      case 0:
+        ASSERT_TRUE(LinkedList_Push(list, P(step)));
+        ref.push_front(step);
+        break;
+      case 1:
+      case 2:
+        ASSERT_TRUE(LinkedList_Append(list, P(step)));
+        ref.push_back(step);
+        break;
+      case 3:
+        ASSERT_EQ(!ref.empty(), LinkedList_Pop(list, &payload));
+        if (!ref.empty()) {
+          EXPECT_EQ(P(ref.front()), payload);
+          ref.pop_front();
+        }
+        break;
+      case 4:
+        ASSERT_EQ(!ref.empty(), LinkedList_Slice(list, &payload));
+        if (!ref.empty()) {
+          EXPECT_EQ(P(ref.back()), payload);
+          ref.pop_back();
+        }
+        break;
+      default: {
+        // Insert or remove somewhere in the middle.
+        LLIterator *iter = LLIterator_Allocate(list);
+        size_t pos = ref.empty() ? 0 : rand() % ref.size();
+        for (size_t i = 0; i < pos; i++) {
+          LLIterator_Next(iter);
+        }
+        if (rand() % 2 == 0 || ref.empty()) {
+          ASSERT_TRUE(LLIterator_Insert(iter, P(step)));
+          ref.insert(ref.begin() + pos, step);
+        } else {
+          LLIterator_Remove(iter, &NoOpFree);
+          ref.erase(ref.begin() + pos);
+        }
+        LLIterator_Free(iter);
+      }
+    }
+    if (step % 1000 == 0) {
+      ExpectSame(list, ref);
+    }
+  }
+  ExpectSame(list, ref);
+  LinkedList_Free(list, &NoOpFree);
+}
+
+// The kinds of list that Concat, SpliceAt and SplitAt must handle in
+// every combination: malloc'd nodes, nodes from each of two arenas, and
+// rings.
+static LinkedList* AllocateKind(int kind, Arena *arenas[2]) {
+  switch (kind) {
+    case 0: return LinkedList_Allocate();
+    case 1: return LinkedList_AllocateInArena(arenas[0]);
+    case 2: return LinkedList_AllocateInArena(arenas[1]);
+    default: return LinkedList_AllocateRing();
+  }
+}
+
+static LinkedList* MakeList(int kind, Arena *arenas[2], intptr_t first,
+                            int n) {
+  LinkedList *list = AllocateKind(kind, arenas);
+  std::vector<LLPayload_t> payloads;
+
+  for (int i = 0; i < n; i++) {
+    payloads.push_back(P(first + i));
+  }
+  EXPECT_TRUE(LinkedList_AppendArray(list, payloads.data(), n));
+  return list;
+}
+
+TEST(Test_LinkedList, ConcatSpliceSplitAcrossKinds) {
+  Arena *arenas[2] = { Arena_Allocate(), Arena_Allocate() };
+
+  for (int dst_kind = 0; dst_kind < 4; dst_kind++) {
+    for (int src_kind = 0; src_kind < 4; src_kind++) {
+      SCOPED_TRACE(testing::Message() << dst_kind << " <- " << src_kind);
+      LinkedList *dst = MakeList(dst_kind, arenas, 0, 3);
+      LinkedList *src = MakeList(src_kind, arenas, 3, 20);
+      std::deque<intptr_t> ref;
+
+      ASSERT_TRUE(LinkedList_Concat(dst, src));
+      for (int i = 0; i < 23; i++) {
+        ref.push_back(i);
+      }
+      ExpectSame(dst, ref);
+      EXPECT_EQ(0, LinkedList_NumElements(src));
+
+      // Splice 100..104 in just before element 2, then at the end.
+      LLIterator *iter = LLIterator_Allocate(dst);
+      LLIterator_Next(iter);
+      LLIterator_Next(iter);
+      LinkedList *more = MakeList(src_kind, arenas, 100, 5);
+      ASSERT_TRUE(LinkedList_SpliceAt(iter, more));
+      LLPayload_t payload;
+      LLIterator_Get(iter, &payload);
+      EXPECT_EQ(P(2), payload);
+      LLIterator_Free(iter);
+      ref.insert(ref.begin() + 2, {100, 101, 102, 103, 104});
+      ExpectSame(dst, ref);
+      LinkedList_Free(more, &NoOpFree);
+
+      // Split the tail off, and put it back.
+      LinkedList *rest = LinkedList_SplitAt(dst, 10);
+      ASSERT_NE(nullptr, rest);
+      ExpectSame(dst, std::deque<intptr_t>(ref.begin(), ref.begin() + 10));
+      ExpectSame(rest, std::deque<intptr_t>(ref.begin() + 10, ref.end()));
+      ASSERT_TRUE(LinkedList_Concat(dst, rest));
+      ExpectSame(dst, ref);
+
+      LinkedList_Free(rest, &NoOpFree);
+      LinkedList_Free(src, &NoOpFree);
+      LinkedList_Free(dst, &NoOpFree);
+    }
+  }
+  Arena_Free(arenas[0]);
+  Arena_Free(arenas[1]);
+}
+
+TEST(Test_LinkedList, SplitAtClampsAndAppendArrayAppends) {
+  LinkedList *list = LinkedList_Allocate();
+  LLPayload_t payloads[3] = { P(1), P(2), P(3) };
+
+  ASSERT_TRUE(LinkedList_AppendArray(list, payloads, 3));
+  ASSERT_TRUE(LinkedList_AppendArray(list, payloads, 0));
+  ASSERT_TRUE(LinkedList_AppendArray(list, payloads, 2));
+  ExpectContents(list, {1, 2, 3, 1, 2});
+
+  LinkedList *rest = LinkedList_SplitAt(list, 99);
+  ExpectContents(rest, {});
+  LinkedList_Free(rest, &NoOpFree);
+  rest = LinkedList_SplitAt(list, -1);
+  ExpectContents(list, {});
+  ExpectContents(rest, {1, 2, 3, 1, 2});
+  LinkedList_Free(rest, &NoOpFree);
+  LinkedList_Free(list, &NoOpFree);
+}
+
+static bool IsOdd(LLPayload_t payload, void *arg) {
+  return reinterpret_cast<intptr_t>(payload) % 2 != 0;
+}
+
+static int num_freed;
+static void CountFree(LLPayload_t payload) {
+  num_freed++;
+}
+
+TEST(Test_LinkedList, RemoveIfKeepsSurvivorsInOrder) {
+  for (LinkedList *list : {LinkedList_Allocate(), LinkedList_AllocateRing()}) {
+    for (int i = 1; i <= 7; i++) {
+      LinkedList_Append(list, P(i));
+    }
+    num_freed = 0;
+    EXPECT_EQ(4, LinkedList_RemoveIf(list, &IsOdd, nullptr, &CountFree));
+    EXPECT_EQ(4, num_freed);
+    ExpectContents(list, {2, 4, 6});
+    EXPECT_EQ(0, LinkedList_RemoveIf(list, &IsOdd, nullptr, &CountFree));
+
+    LinkedList_Append(list, P(9));
+    LinkedList_Push(list, P(1));
+    EXPECT_EQ(2, LinkedList_RemoveIf(list, &IsOdd, nullptr, &CountFree));
+    ExpectContents(list, {2, 4, 6});
+    LinkedList_Free(list, &NoOpFree);
+  }
+}
+
+}  // namespace hw0
@@ -0,0 +1,145 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+extern "C" {
+  #include "./LRUCache.h"
+  #include "./LRUCache_priv.h"
+}
+
+#include "gtest/gtest.h"
+#include "./test_util.h"
+
+namespace hw0 {
+
+// Records the keys handed to the eviction function, in order.
+static void RecordEviction(HTKeyValue_t evicted, void *arg) {
+  static_cast<std::vector<HTKey_t> *>(arg)->push_back(evicted.key);
+}
+
+TEST(Test_LRUCache, EvictsLeastRecentlyUsed) {
+  std::vector<HTKey_t> evicted;
+  LRUCache *cache = LRUCache_Allocate(3, 0, &RecordEviction, &evicted);
+  HTKeyValue_t kv, old;
+
+  ASSERT_NE(nullptr, cache);
+  for (int i = 1; i <= 3; i++) {
+    EXPECT_FALSE(LRUCache_Put(cache, KV(i, i * 10), 1, &old));
+  }
+
+  // Touch 1, so that 2 is now the coldest.
+  ASSERT_TRUE(LRUCache_Get(cache, 1, &kv));
+  EXPECT_EQ(V(10), kv.value);
+  EXPECT_FALSE(LRUCache_Put(cache, KV(4, 40), 1, &old));
+  ASSERT_EQ(1u, evicted.size());
+  EXPECT_EQ(2u, evicted[0]);
+  EXPECT_FALSE(LRUCache_Peek(cache, 2, &kv));
+  EXPECT_EQ(3, LRUCache_NumElements(cache));
+
+  // Replacing a key returns the old value and evicts nothing.
+  EXPECT_TRUE(LRUCache_Put(cache, KV(3, 31), 1, &old));
+  EXPECT_EQ(V(30), old.value);
+  EXPECT_EQ(1u, evicted.size());
+
+  LRUStats stats;
+  LRUCache_GetStats(cache, &stats);
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(4u, stats.insertions);
+  EXPECT_EQ(1u, stats.evictions);
+  LRUCache_Free(cache, nullptr);
+}
+
+TEST(Test_LRUCache, ByteBudget) {
+  std::vector<HTKey_t> evicted;
+  LRUCache *cache = LRUCache_Allocate(0, 1000, &RecordEviction, &evicted);
+  HTKeyValue_t old;
+
+  LRUCache_Put(cache, KV(1, 1), 400, &old);
+  LRUCache_Put(cache, KV(2, 2), 400, &old);
+  EXPECT_EQ(800u, LRUCache_NumBytes(cache));
+
+  // 3 needs 400 more bytes, so the coldest entry (1) has to go.
+  LRUCache_Put(cache, KV(3, 3), 400, &old);
+  ASSERT_EQ(1u, evicted.size());
+  EXPECT_EQ(1u, evicted[0]);
+  EXPECT_EQ(800u, LRUCache_NumBytes(cache));
+  LRUCache_Free(cache, nullptr);
+}
+
+// A replacement too big to ever fit takes the old entry out and is itself
+// evicted, but leaves every other entry alone.
+TEST(Test_LRUCache, OversizeReplacementOnlyEvictsItself) {
+  std::vector<HTKey_t> evicted;
+  LRUCache *cache = LRUCache_Allocate(0, 1000, &RecordEviction, &evicted);
+  HTKeyValue_t kv, old;
+
+  LRUCache_Put(cache, KV(1, 10), 100, &old);
+  LRUCache_Put(cache, KV(2, 20), 100, &old);
+  EXPECT_TRUE(LRUCache_Put(cache, KV(1, 11), 5000, &old));
+  EXPECT_EQ(1u, old.key);
+  EXPECT_EQ(V(10), old.value);
+
+  ASSERT_EQ(1u, evicted.size());
+  EXPECT_EQ(1u, evicted[0]);
+  EXPECT_FALSE(LRUCache_Peek(cache, 1, &kv));
+  ASSERT_TRUE(LRUCache_Peek(cache, 2, &kv));
+  EXPECT_EQ(V(20), kv.value);
+  EXPECT_EQ(1, LRUCache_NumElements(cache));
+  EXPECT_EQ(100u, LRUCache_NumBytes(cache));
+
+  // A new oversize key is evicted on arrival, too.
+  EXPECT_FALSE(LRUCache_Put(cache, KV(3, 30), 5000, &old));
+  EXPECT_EQ(2u, evicted.size());
+  EXPECT_EQ(1, LRUCache_NumElements(cache));
+  LRUCache_Free(cache, nullptr);
+}
+
+TEST(Test_LRUCache, RejectsBadBounds) {
+  EXPECT_EQ(nullptr, LRUCache_Allocate(0, 0, nullptr, nullptr));
+  EXPECT_EQ(nullptr, LRUCache_Allocate(-1, 0, nullptr, nullptr));
+  EXPECT_EQ(nullptr,
+            LRUCache_Allocate(LRU_MAX_ENTRIES + 1, 0, nullptr, nullptr));
+}
+
+// Keys whose HTMix64 outputs share their low 48 bits land in buckets
+// chosen by the cache's seed, so no chain gets long.
+TEST(Test_LRUCache, SeededBucketsSpreadCollidingKeys) {
+  LRUCache *cache = LRUCache_Allocate(8192, 0, nullptr, nullptr);
+  HTKeyValue_t kv, old;
+  int longest = 0;
+
+  ASSERT_NE(nullptr, cache);
+  for (int i = 1; i <= 4096; i++) {
+    LRUCache_Put(cache, KV(UnMix64(static_cast<uint64_t>(i) << 48), i), 1,
+                 &old);
+  }
+  for (int b = 0; b < cache->num_buckets; b++) {
+    int len = 0;
+    for (LRUNode *node = cache->buckets[b]; node != nullptr;
+         node = node->hnext) {
+      len++;
+    }
+    longest = std::max(longest, len);
+  }
+  EXPECT_LE(longest, 16);
+  for (int i = 1; i <= 4096; i++) {
+    ASSERT_TRUE(LRUCache_Get(cache, UnMix64(static_cast<uint64_t>(i) << 48),
+                             &kv));
+    EXPECT_EQ(V(i), kv.value);
+  }
+  LRUCache_Free(cache, nullptr);
+}
+
+}  // namespace hw0
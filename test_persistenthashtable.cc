@@ -0,0 +1,137 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+
+#include <map>
+#include <thread>
+#include <utility>
+#include <vector>
+
+extern "C" {
+  #include "./PersistentHashTable.h"
+}
+
+#include "gtest/gtest.h"
+#include "./test_util.h"
+
+namespace hw0 {
+
+typedef std::map<HTKey_t, intptr_t> RefMap;
+
+static void CollectEntry(const HTKeyValue_t *kv, void *arg) {
+  RefMap *visited = static_cast<RefMap *>(arg);
+  EXPECT_EQ(0u, visited->count(kv->key));
+  (*visited)[kv->key] = reinterpret_cast<intptr_t>(kv->value);
+}
+
+// Checks that table holds exactly ref, by lookup and by visiting.
+static void ExpectSame(PersistentHashTable *table, const RefMap &ref) {
+  RefMap visited;
+  HTKeyValue_t kv;
+
+  ASSERT_EQ(static_cast<int>(ref.size()),
+            PersistentHashTable_NumElements(table));
+  for (auto &entry : ref) {
+    ASSERT_TRUE(PersistentHashTable_Find(table, entry.first, &kv));
+    EXPECT_EQ(entry.second, reinterpret_cast<intptr_t>(kv.value));
+  }
+  PersistentHashTable_Visit(table, &CollectEntry, &visited);
+  EXPECT_EQ(ref, visited);
+}
+
+// Each clone must keep holding exactly what the table held when it was
+// taken, however the table and the other clones change afterwards.
+TEST(Test_PersistentHashTable, ClonesAreSnapshots) {
+  PersistentHashTable *table = PersistentHashTable_Allocate();
+  std::vector<std::pair<PersistentHashTable *, RefMap>> clones;
+  RefMap ref;
+  HTKeyValue_t kv;
+
+  ASSERT_NE(nullptr, table);
+  // Each round replaces one stripe of keys, removes another and adds a
+  // fresh range, then takes a clone.
+  for (intptr_t round = 0; round < 8; round++) {
+    for (HTKey_t key = round; key < 4000; key += 8) {
+      ASSERT_EQ(ref.count(key) != 0,
+                PersistentHashTable_Insert(table, KV(key, round), &kv));
+      ref[key] = round;
+    }
+    for (HTKey_t key = (round + 4) % 8; key < 4000; key += 8) {
+      ASSERT_EQ(ref.count(key) != 0,
+                PersistentHashTable_Remove(table, key, &kv));
+      ref.erase(key);
+    }
+    HTKey_t fresh = 4000 + round * 100;
+    for (HTKey_t key = fresh; key < fresh + 100; key++) {
+      ASSERT_FALSE(PersistentHashTable_Insert(table, KV(key, round), &kv));
+      ref[key] = round;
+    }
+    PersistentHashTable *clone = PersistentHashTable_Clone(table);
+    ASSERT_NE(nullptr, clone);
+    clones.push_back(std::make_pair(clone, ref));
+  }
+
+  // Updating one clone leaves the table and the other clones alone.
+  ASSERT_TRUE(PersistentHashTable_Insert(clones[3].first, KV(1, 99), &kv));
+  clones[3].second[1] = 99;
+  ExpectSame(table, ref);
+  PersistentHashTable_Free(table);
+
+  // Free the clones out of order, checking the survivors as we go.
+  for (size_t i = 0; i < clones.size(); i += 2) {
+    ExpectSame(clones[i].first, clones[i].second);
+    PersistentHashTable_Free(clones[i].first);
+  }
+  for (size_t i = 1; i < clones.size(); i += 2) {
+    ExpectSame(clones[i].first, clones[i].second);
+    PersistentHashTable_Free(clones[i].first);
+  }
+}
+
+// Clones of one table may be updated and freed by different threads at
+// once.
+TEST(Test_PersistentHashTable, ClonesOnSeveralThreads) {
+  PersistentHashTable *base = PersistentHashTable_Allocate();
+  HTKeyValue_t kv;
+
+  for (int i = 0; i < 10000; i++) {
+    PersistentHashTable_Insert(base, KV(i, i), &kv);
+  }
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    PersistentHashTable *clone = PersistentHashTable_Clone(base);
+    ASSERT_NE(nullptr, clone);
+    threads.emplace_back([clone, t] {
+      HTKeyValue_t kv;
+      for (int i = 0; i < 10000; i++) {
+        if (i % 4 == t) {
+          PersistentHashTable_Remove(clone, i, &kv);
+        } else {
+          PersistentHashTable_Insert(clone, KV(i, i + t), &kv);
+        }
+      }
+      EXPECT_EQ(7500, PersistentHashTable_NumElements(clone));
+      PersistentHashTable_Free(clone);
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  RefMap ref;
+  for (int i = 0; i < 10000; i++) {
+    ref[i] = i;
+  }
+  ExpectSame(base, ref);
+  PersistentHashTable_Free(base);
+}
+
+}  // namespace hw0
@@ -0,0 +1,113 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+
+extern "C" {
+  #include "./SkipList.h"
+}
+
+#include "gtest/gtest.h"
+
+namespace hw0 {
+
+// Payloads are integers whose top bits are the sort key and whose low
+// byte is a version, so an element can be replaced by an equal one that
+// is still distinguishable.
+static LLPayload_t P(intptr_t key, intptr_t version) {
+  return reinterpret_cast<LLPayload_t>(key << 8 | version);
+}
+
+static intptr_t Key(LLPayload_t payload) {
+  return reinterpret_cast<intptr_t>(payload) >> 8;
+}
+
+static int CompareKeys(LLPayload_t a, LLPayload_t b) {
+  return Key(a) < Key(b) ? -1 : Key(a) > Key(b);
+}
+
+static void NoOpFree(LLPayload_t payload) { }
+
+// Elements inserted out of order come back sorted, an equal element
+// replaces the old one in place, and removals unlink every level.
+TEST(Test_SkipList, KeepsElementsOrdered) {
+  SkipList *list = SkipList_Allocate(&CompareKeys);
+  LLPayload_t payload;
+
+  ASSERT_NE(nullptr, list);
+  // 7 is coprime to 5000, so this visits every key once, out of order.
+  for (intptr_t i = 0; i < 5000; i++) {
+    ASSERT_FALSE(SkipList_Insert(list, P(i * 7 % 5000, 0), &payload));
+  }
+  ASSERT_TRUE(SkipList_Insert(list, P(10, 1), &payload));
+  EXPECT_EQ(P(10, 0), payload);
+
+  for (intptr_t key = 0; key < 5000; key += 3) {
+    ASSERT_TRUE(SkipList_Remove(list, P(key, 0), &payload));
+    EXPECT_EQ(key, Key(payload));
+  }
+  EXPECT_FALSE(SkipList_Remove(list, P(0, 0), &payload));
+  ASSERT_EQ(3333, SkipList_NumElements(list));
+
+  for (intptr_t key = 0; key < 5000; key++) {
+    ASSERT_EQ(key % 3 != 0, SkipList_Find(list, P(key, 0), &payload));
+  }
+  ASSERT_TRUE(SkipList_Find(list, P(10, 0), &payload));
+  EXPECT_EQ(P(10, 1), payload);
+
+  // The iterator walks the survivors in ascending order.
+  LLIterator *iter = SkipList_Iterator(list);
+  for (intptr_t key = 1; key < 5000; key += key % 3 == 1 ? 1 : 2) {
+    ASSERT_TRUE(LLIterator_IsValid(iter));
+    LLIterator_Get(iter, &payload);
+    ASSERT_EQ(key, Key(payload));
+    LLIterator_Next(iter);
+  }
+  EXPECT_FALSE(LLIterator_IsValid(iter));
+  LLIterator_Free(iter);
+  SkipList_Free(list, &NoOpFree);
+}
+
+TEST(Test_SkipList, SeekStartsRangeScans) {
+  SkipList *list = SkipList_Allocate(&CompareKeys);
+  LLPayload_t payload, old;
+
+  for (intptr_t key = 10; key <= 1000; key += 10) {
+    SkipList_Insert(list, P(key, 0), &old);
+  }
+
+  // [95, 140] holds 100, 110, 120, 130 and 140.
+  LLIterator *iter = SkipList_Seek(list, P(95, 0));
+  intptr_t want = 100;
+  while (LLIterator_IsValid(iter)) {
+    LLIterator_Get(iter, &payload);
+    if (Key(payload) > 140) {
+      break;
+    }
+    EXPECT_EQ(want, Key(payload));
+    want += 10;
+    LLIterator_Next(iter);
+  }
+  EXPECT_EQ(150, want);
+  LLIterator_Free(iter);
+
+  iter = SkipList_Seek(list, P(10, 0));
+  LLIterator_Get(iter, &payload);
+  EXPECT_EQ(10, Key(payload));
+  LLIterator_Free(iter);
+
+  iter = SkipList_Seek(list, P(1001, 0));
+  EXPECT_FALSE(LLIterator_IsValid(iter));
+  LLIterator_Free(iter);
+  SkipList_Free(list, &NoOpFree);
+}
+
+}  // namespace hw0
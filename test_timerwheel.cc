@@ -0,0 +1,79 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+extern "C" {
+  #include "./TimerWheel.h"
+}
+
+#include "gtest/gtest.h"
+
+namespace hw0 {
+
+typedef std::vector<std::pair<uint64_t, uint64_t>> Firings;
+
+// Records each (key, deadline) that fires, in order.
+static void RecordFiring(uint64_t key, uint64_t deadline, void *arg) {
+  static_cast<Firings *>(arg)->push_back(std::make_pair(key, deadline));
+}
+
+TEST(Test_TimerWheel, FiresDueTimersOnly) {
+  TimerWheel *wheel = TimerWheel_Allocate(1000);
+  Firings fired;
+
+  ASSERT_NE(nullptr, wheel);
+  // Deadlines on several levels of the wheel, and one already past.
+  ASSERT_TRUE(TimerWheel_Add(wheel, 1, 1010));
+  ASSERT_TRUE(TimerWheel_Add(wheel, 2, 1000 + 5000));
+  ASSERT_TRUE(TimerWheel_Add(wheel, 3, 1000 + 400000));
+  ASSERT_TRUE(TimerWheel_Add(wheel, 4, 500));
+  EXPECT_EQ(4, TimerWheel_NumTimers(wheel));
+
+  // Timers that come due together fire in no particular order.
+  EXPECT_EQ(2, TimerWheel_Advance(wheel, 1010, 0, &RecordFiring, &fired));
+  ASSERT_EQ(2u, fired.size());
+  EXPECT_EQ(1u, std::min(fired[0].first, fired[1].first));
+  EXPECT_EQ(4u, std::max(fired[0].first, fired[1].first));
+
+  EXPECT_EQ(0, TimerWheel_Advance(wheel, 5999, 0, &RecordFiring, &fired));
+  EXPECT_EQ(1, TimerWheel_Advance(wheel, 6000, 0, &RecordFiring, &fired));
+  EXPECT_EQ(2u, fired.back().first);
+  EXPECT_EQ(1, TimerWheel_Advance(wheel, 500000, 0, &RecordFiring, &fired));
+  EXPECT_EQ(3u, fired.back().first);
+  EXPECT_EQ(401000u, fired.back().second);
+  EXPECT_EQ(0, TimerWheel_NumTimers(wheel));
+  TimerWheel_Free(wheel);
+}
+
+TEST(Test_TimerWheel, MaxFireSpreadsTheWork) {
+  TimerWheel *wheel = TimerWheel_Allocate(0);
+  Firings fired;
+
+  for (uint64_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(TimerWheel_Add(wheel, i, 5));
+  }
+  EXPECT_EQ(4, TimerWheel_Advance(wheel, 10, 4, &RecordFiring, &fired));
+  EXPECT_EQ(4, TimerWheel_Advance(wheel, 10, 4, &RecordFiring, &fired));
+  EXPECT_EQ(2, TimerWheel_Advance(wheel, 10, 4, &RecordFiring, &fired));
+  EXPECT_EQ(10u, fired.size());
+
+  // Timers still pending when the wheel is freed don't fire.
+  ASSERT_TRUE(TimerWheel_Add(wheel, 99, 1000));
+  TimerWheel_Free(wheel);
+  EXPECT_EQ(10u, fired.size());
+}
+
+}  // namespace hw0
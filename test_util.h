@@ -0,0 +1,55 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW0_TEST_UTIL_H_
+#define HW0_TEST_UTIL_H_
+
+#include <stdint.h>
+
+extern "C" {
+  #include "./HashTable.h"
+  #include "./LinkedList.h"
+}
+
+namespace hw0 {
+
+// Values and payloads in the tests are small integers, cast to pointers,
+// so there is nothing to free.
+static inline HTValue_t V(intptr_t i) {
+  return reinterpret_cast<HTValue_t>(i);
+}
+
+static inline HTKeyValue_t KV(HTKey_t key, intptr_t value) {
+  HTKeyValue_t kv;
+  kv.key = key;
+  kv.value = V(value);
+  return kv;
+}
+
+static inline LLPayload_t P(intptr_t i) {
+  return reinterpret_cast<LLPayload_t>(i);
+}
+
+// Inverts HTMix64: returns the key whose mix is h.  Keys built from
+// mixes that agree in their low bits all shared a bucket back when
+// buckets were chosen by HTMix64 alone.
+static inline uint64_t UnMix64(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0x9cb4b2f8129337dbULL;
+  h ^= h >> 33;
+  h *= 0x4f74430c22a54005ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+}  // namespace hw0
+
+#endif  // HW0_TEST_UTIL_H_
@@ -0,0 +1,171 @@
+/*
+ * Copyright ©2023 Travis McGaha.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Pennsylvania
+ * CIT 5950 for use solely during Spring Semester 2023 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+
+extern "C" {
+  #include "./WriteAheadLog.h"
+}
+
+#include "gtest/gtest.h"
+#include "./test_util.h"
+
+namespace hw0 {
+
+// Each test logs into a fresh directory under /tmp, removed afterwards.
+class Test_WriteAheadLog : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char dir[] = "/tmp/test_wal_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(dir));
+    dir_ = dir;
+    path_ = dir_ + "/log";
+  }
+
+  void TearDown() override {
+    unlink(path_.c_str());
+    unlink((path_ + ".ckpt").c_str());
+    rmdir(dir_.c_str());
+  }
+
+  std::string dir_, path_;
+};
+
+static intptr_t Value(HashTable *table, HTKey_t key) {
+  HTKeyValue_t kv;
+  if (!HashTable_Find(table, key, &kv)) {
+    return -1;
+  }
+  return reinterpret_cast<intptr_t>(kv.value);
+}
+
+TEST_F(Test_WriteAheadLog, ReplaysCommittedMutations) {
+  HashTable *table = HashTable_Allocate(16);
+  WriteAheadLog *wal = WriteAheadLog_Open(path_.c_str(), table, nullptr, 0);
+  HTKeyValue_t old;
+
+  ASSERT_NE(nullptr, wal);
+  for (int i = 0; i < 1000; i++) {
+    WriteAheadLog_Insert(wal, KV(i, i), &old);
+  }
+  for (int i = 0; i < 1000; i += 3) {
+    ASSERT_TRUE(WriteAheadLog_Remove(wal, i, &old));
+  }
+  EXPECT_TRUE(WriteAheadLog_Insert(wal, KV(1, 100), &old));
+  ASSERT_TRUE(WriteAheadLog_Commit(wal));
+  EXPECT_GT(WriteAheadLog_NumBytes(wal), 0u);
+  ASSERT_TRUE(WriteAheadLog_Close(wal));
+  HashTable_Free(table, nullptr);
+
+  table = HashTable_Allocate(16);
+  wal = WriteAheadLog_Open(path_.c_str(), table, nullptr, 0);
+  ASSERT_NE(nullptr, wal);
+  EXPECT_EQ(666, HashTable_NumElements(table));
+  EXPECT_EQ(100, Value(table, 1));
+  EXPECT_EQ(-1, Value(table, 3));
+  EXPECT_EQ(998, Value(table, 998));
+  WriteAheadLog_Close(wal);
+  HashTable_Free(table, nullptr);
+}
+
+// A torn final record is dropped, and everything before it survives.
+TEST_F(Test_WriteAheadLog, DiscardsTornTail) {
+  HashTable *table = HashTable_Allocate(16);
+  WriteAheadLog *wal = WriteAheadLog_Open(path_.c_str(), table, nullptr, 0);
+  HTKeyValue_t old;
+
+  WriteAheadLog_Insert(wal, KV(1, 1), &old);
+  WriteAheadLog_Insert(wal, KV(2, 2), &old);
+  ASSERT_TRUE(WriteAheadLog_Commit(wal));
+  uint64_t size = WriteAheadLog_NumBytes(wal);
+  ASSERT_TRUE(WriteAheadLog_Close(wal));
+  HashTable_Free(table, nullptr);
+  ASSERT_EQ(0, truncate(path_.c_str(), size - 1));
+
+  table = HashTable_Allocate(16);
+  wal = WriteAheadLog_Open(path_.c_str(), table, nullptr, 0);
+  ASSERT_NE(nullptr, wal);
+  EXPECT_EQ(1, HashTable_NumElements(table));
+  EXPECT_EQ(1, Value(table, 1));
+
+  // The log carries on cleanly after the truncation point.
+  WriteAheadLog_Insert(wal, KV(3, 3), &old);
+  ASSERT_TRUE(WriteAheadLog_Close(wal));
+  HashTable_Free(table, nullptr);
+
+  table = HashTable_Allocate(16);
+  wal = WriteAheadLog_Open(path_.c_str(), table, nullptr, 0);
+  EXPECT_EQ(2, HashTable_NumElements(table));
+  EXPECT_EQ(3, Value(table, 3));
+  WriteAheadLog_Close(wal);
+  HashTable_Free(table, nullptr);
+}
+
+// Values are malloc'd strings, so replay goes through the codec.
+static size_t StringSize(HTValue_t value) {
+  return strlen(static_cast<char *>(value));
+}
+
+static void StringEncode(HTValue_t value, unsigned char *buf) {
+  memcpy(buf, value, StringSize(value));
+}
+
+static HTValue_t StringDecode(const unsigned char *buf, size_t len) {
+  char *s = static_cast<char *>(malloc(len + 1));
+  memcpy(s, buf, len);
+  s[len] = '\0';
+  return s;
+}
+
+static const WALCodec kStringCodec = {
+  &StringSize, &StringEncode, &StringDecode, &free
+};
+
+TEST_F(Test_WriteAheadLog, CheckpointEmptiesLogAndKeepsTable) {
+  HashTable *table = HashTable_Allocate(16);
+  WriteAheadLog *wal =
+      WriteAheadLog_Open(path_.c_str(), table, &kStringCodec, 0);
+  HTKeyValue_t kv, old;
+
+  ASSERT_NE(nullptr, wal);
+  uint64_t empty = WriteAheadLog_NumBytes(wal);
+  for (int i = 0; i < 100; i++) {
+    kv.key = i;
+    kv.value = strdup(std::to_string(i * i).c_str());
+    if (WriteAheadLog_Insert(wal, kv, &old)) {
+      free(old.value);
+    }
+  }
+  EXPECT_GT(WriteAheadLog_NumBytes(wal), empty);
+  ASSERT_TRUE(WriteAheadLog_Checkpoint(wal));
+  EXPECT_EQ(empty, WriteAheadLog_NumBytes(wal));
+  ASSERT_TRUE(WriteAheadLog_Remove(wal, 10, &old));
+  free(old.value);
+  ASSERT_TRUE(WriteAheadLog_Close(wal));
+  HashTable_Free(table, &free);
+
+  table = HashTable_Allocate(16);
+  wal = WriteAheadLog_Open(path_.c_str(), table, &kStringCodec, 0);
+  ASSERT_NE(nullptr, wal);
+  EXPECT_EQ(99, HashTable_NumElements(table));
+  ASSERT_TRUE(HashTable_Find(table, 9, &kv));
+  EXPECT_STREQ("81", static_cast<char *>(kv.value));
+  EXPECT_FALSE(HashTable_Find(table, 10, &kv));
+  WriteAheadLog_Close(wal);
+  HashTable_Free(table, &free);
+}
+
+}  // namespace hw0